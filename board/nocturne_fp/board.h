@@ -105,6 +105,8 @@
 #define CONFIG_SHA256
 #define CONFIG_SHA256_UNROLLED
 #define CONFIG_SPI
+/* Move fingerprint frames and templates in 4 KiB host commands. */
+#define CONFIG_SPI_HOST_PACKET_SIZE 0x1008
 #define CONFIG_STM_HWTIMER32
 #define CONFIG_SUPPRESSED_HOST_COMMANDS \
 	EC_CMD_CONSOLE_SNAPSHOT, EC_CMD_CONSOLE_READ, EC_CMD_PD_GET_LOG_ENTRY
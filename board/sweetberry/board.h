@@ -65,6 +65,7 @@
 #define CONFIG_USB_I2C
 #define CONFIG_I2C
 #define CONFIG_I2C_CONTROLLER
+#define CONFIG_I2C_XFER_ASYNC
 #define I2C_PORT_0	0
 #define I2C_PORT_1	1
 #define I2C_PORT_2	2
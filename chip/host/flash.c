@@ -13,10 +13,20 @@
 #include "persistence.h"
 #include "util.h"
 
-/* This needs to be aligned to the erase bank size for NVCTR. */
-__aligned(CONFIG_FLASH_ERASE_SIZE) char __host_flash[CONFIG_FLASH_SIZE];
+/*
+ * This needs to be aligned to the erase bank size for NVCTR, and to whole
+ * pages so that it can be mapped onto the persistent storage.  A partial last
+ * page would map the file over whatever follows __host_flash.
+ */
+#define HOST_FLASH_ALIGN PERSISTENT_STORAGE_ALIGN
+BUILD_ASSERT(HOST_FLASH_ALIGN % CONFIG_FLASH_ERASE_SIZE == 0);
+BUILD_ASSERT(CONFIG_FLASH_SIZE % HOST_FLASH_ALIGN == 0);
+__aligned(HOST_FLASH_ALIGN) char __host_flash[CONFIG_FLASH_SIZE];
 uint8_t __host_flash_protect[PHYSICAL_BANKS];
 
+/* Set once __host_flash is backed by the persistent storage. */
+static int flash_mapped;
+
 /* Override this function to make flash erase/write operation fail */
 test_mockable int flash_pre_op(void)
 {
@@ -36,11 +46,27 @@ static int flash_check_protect(int offset, int size)
 	return 0;
 }
 
-static void flash_set_persistent(void)
+static void flash_set_persistent(int offset, int size)
 {
-	FILE *f = get_persistent_storage("flash", "wb");
+	FILE *f;
 	int sz;
 
+	if (flash_mapped) {
+		mark_persistent_storage_dirty(__host_flash + offset, size);
+		return;
+	}
+
+	/*
+	 * Copy the image out once and map it, so later writes only touch
+	 * the pages they change.
+	 */
+	if (!map_persistent_storage("flash", __host_flash,
+				    sizeof(__host_flash), 1)) {
+		flash_mapped = 1;
+		return;
+	}
+
+	f = get_persistent_storage("flash", "wb");
 	ASSERT(f != NULL);
 
 	sz = fwrite(__host_flash, sizeof(__host_flash), 1, f);
@@ -51,8 +77,15 @@ static void flash_set_persistent(void)
 
 static void flash_get_persistent(void)
 {
-	FILE *f = get_persistent_storage("flash", "rb");
+	FILE *f;
+
+	if (!map_persistent_storage("flash", __host_flash,
+				    sizeof(__host_flash), 0)) {
+		flash_mapped = 1;
+		return;
+	}
 
+	f = get_persistent_storage("flash", "rb");
 	if (f == NULL) {
 		fprintf(stderr,
 			"No flash storage found. Initializing to 0xff.\n");
@@ -76,7 +109,7 @@ int flash_physical_write(int offset, int size, const char *data)
 		return EC_ERROR_ACCESS_DENIED;
 
 	memcpy(__host_flash + offset, data, size);
-	flash_set_persistent();
+	flash_set_persistent(offset, size);
 
 	return EC_SUCCESS;
 }
@@ -92,7 +125,7 @@ int flash_physical_erase(int offset, int size)
 		return EC_ERROR_ACCESS_DENIED;
 
 	memset(__host_flash + offset, 0xff, size);
-	flash_set_persistent();
+	flash_set_persistent(offset, size);
 
 	return EC_SUCCESS;
 }
@@ -5,16 +5,34 @@
 
 /* Persistence module for emulator */
 
+#include <fcntl.h>
 #include <linux/limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "compile_time_macros.h"
+#include "persistence.h"
+
+/* Storage mapped with map_persistent_storage() */
+static struct {
+	char *addr;
+	size_t size;
+	/* Range written since the last sync, empty if start >= end */
+	size_t dirty_start;
+	size_t dirty_end;
+} maps[4];
+
 static void get_storage_path(char *out)
 {
 	char buf[PATH_MAX];
 	int sz;
 	char *current;
+	const char *dir;
 
 	sz = readlink("/proc/self/exe", buf, PATH_MAX - 1);
 	buf[sz] = '\0';
@@ -26,14 +44,18 @@ static void get_storage_path(char *out)
 		current = strchr(current, '/');
 	}
 
-	snprintf(out, PATH_MAX - 1, "/dev/shm/EC_persist_%s", buf);
+	/* Test runners can give each test its own directory. */
+	dir = getenv("EC_PERSIST_DIR");
+	if (dir == NULL)
+		dir = "/dev/shm";
+
+	snprintf(out, PATH_MAX - 1, "%s/EC_persist_%s", dir, buf);
 	out[PATH_MAX - 1] = '\0';
 }
 
-FILE *get_persistent_storage(const char *tag, const char *mode)
+static void get_tag_path(const char *tag, char *path)
 {
 	char buf[PATH_MAX];
-	char path[PATH_MAX];
 
 	/*
 	 * The persistent storage with tag 'foo' for test 'bar' would
@@ -42,6 +64,13 @@ FILE *get_persistent_storage(const char *tag, const char *mode)
 	get_storage_path(buf);
 	snprintf(path, PATH_MAX - 1, "%s_%s", buf, tag);
 	path[PATH_MAX - 1] = '\0';
+}
+
+FILE *get_persistent_storage(const char *tag, const char *mode)
+{
+	char path[PATH_MAX];
+
+	get_tag_path(tag, path);
 
 	return fopen(path, mode);
 }
@@ -53,12 +82,113 @@ void release_persistent_storage(FILE *ps)
 
 void remove_persistent_storage(const char *tag)
 {
-	char buf[PATH_MAX];
 	char path[PATH_MAX];
 
-	get_storage_path(buf);
-	snprintf(path, PATH_MAX - 1, "%s_%s", buf, tag);
-	path[PATH_MAX - 1] = '\0';
+	get_tag_path(tag, path);
 
 	unlink(path);
 }
+
+static int write_all(int fd, const char *data, size_t size)
+{
+	while (size) {
+		ssize_t n = write(fd, data, size);
+
+		if (n <= 0)
+			return -1;
+		data += n;
+		size -= n;
+	}
+	return 0;
+}
+
+int map_persistent_storage(const char *tag, void *addr, size_t size,
+			   int create)
+{
+	char path[PATH_MAX];
+	struct stat st;
+	void *p;
+	int fd;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(maps); i++)
+		if (!maps[i].addr)
+			break;
+	if (i == ARRAY_SIZE(maps) ||
+	    sysconf(_SC_PAGESIZE) > PERSISTENT_STORAGE_ALIGN ||
+	    (uintptr_t)addr % PERSISTENT_STORAGE_ALIGN != 0 ||
+	    size % PERSISTENT_STORAGE_ALIGN != 0)
+		return -1;
+
+	get_tag_path(tag, path);
+
+	if (create) {
+		/* Seed the storage with what is in memory now. */
+		fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0)
+			return -1;
+		if (write_all(fd, addr, size)) {
+			close(fd);
+			return -1;
+		}
+	} else {
+		fd = open(path, O_RDWR);
+		if (fd < 0)
+			return -1;
+		if (fstat(fd, &st) || (size_t)st.st_size != size) {
+			close(fd);
+			return -1;
+		}
+	}
+
+	p = mmap(addr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+		 fd, 0);
+	/* The mapping keeps its own reference to the file. */
+	close(fd);
+	if (p == MAP_FAILED)
+		return -1;
+
+	maps[i].addr = addr;
+	maps[i].size = size;
+	maps[i].dirty_start = size;
+	maps[i].dirty_end = 0;
+	return 0;
+}
+
+void mark_persistent_storage_dirty(const void *addr, size_t size)
+{
+	const char *p = addr;
+	size_t offset;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(maps); i++) {
+		if (!maps[i].addr || p < maps[i].addr ||
+		    p >= maps[i].addr + maps[i].size)
+			continue;
+
+		offset = p - maps[i].addr;
+		if (offset < maps[i].dirty_start)
+			maps[i].dirty_start = offset;
+		if (offset + size > maps[i].dirty_end)
+			maps[i].dirty_end = offset + size;
+		return;
+	}
+}
+
+void sync_persistent_storage(void)
+{
+	const size_t page = sysconf(_SC_PAGESIZE);
+	size_t start;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(maps); i++) {
+		if (maps[i].dirty_start >= maps[i].dirty_end)
+			continue;
+
+		start = maps[i].dirty_start & ~(page - 1);
+		msync(maps[i].addr + start, maps[i].dirty_end - start,
+		      MS_SYNC);
+		maps[i].dirty_start = maps[i].size;
+		maps[i].dirty_end = 0;
+	}
+}
@@ -20,6 +20,37 @@ void release_persistent_storage(FILE *ps);
 
 void remove_persistent_storage(const char *tag);
 
+/*
+ * Alignment of memory that can be backed by persistent storage.  This is the
+ * usual host page size; on a host with larger pages, mapping is refused and
+ * callers fall back to stdio.  Larger alignments put .bss in a segment that
+ * some emulator images crash loading.
+ */
+#define PERSISTENT_STORAGE_ALIGN 4096
+
+/*
+ * Back |size| bytes of memory at |addr| with the persistent storage |tag|,
+ * so that stores to that memory reach the storage without any copy. |addr|
+ * and |size| must be multiples of PERSISTENT_STORAGE_ALIGN. With |create|
+ * set, the storage is (re)created from the current contents of the memory;
+ * otherwise it must already exist with exactly |size| bytes, and replaces the
+ * contents of the memory.
+ *
+ * Return 0 on success, or -1 if the memory could not be mapped, in which
+ * case the memory is left untouched.
+ */
+int map_persistent_storage(const char *tag, void *addr, size_t size,
+			   int create);
+
+/*
+ * Record that |size| bytes at |addr|, within mapped storage, were written.
+ * Only the written range is flushed by sync_persistent_storage().
+ */
+void mark_persistent_storage_dirty(const void *addr, size_t size);
+
+/* Flush written ranges of mapped storage to the backing files. */
+void sync_persistent_storage(void);
+
 #ifdef __cplusplus
 }
 #endif
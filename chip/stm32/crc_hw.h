@@ -33,6 +33,28 @@ static inline void crc32_hash16(uint16_t val)
 	STM32_CRC_DR16 = val;
 }
 
+static inline void crc32_hash_buf(const void *buf, int size)
+{
+	const uint8_t *p = buf;
+
+	/* Feed whole words, then the remaining bytes */
+	for (; size >= 4; size -= 4, p += 4)
+		STM32_CRC_DR = p[0] | (p[1] << 8) | (p[2] << 16) |
+			       ((uint32_t)p[3] << 24);
+	if (size == 0)
+		return;
+
+	/*
+	 * Word input reversal would mirror each tail byte across 32 bits, so
+	 * reverse bytes on their own while feeding them.
+	 */
+	STM32_CRC_CR = (STM32_CRC_CR & ~STM32_CRC_CR_REV_IN_WORD) |
+		       STM32_CRC_CR_REV_IN_BYTE;
+	for (; size > 0; size--)
+		STM32_CRC_DR8 = *p++;
+	STM32_CRC_CR |= STM32_CRC_CR_REV_IN_WORD;
+}
+
 static inline uint32_t crc32_result(void)
 {
 	return STM32_CRC_DR ^ 0xFFFFFFFF;
@@ -79,8 +79,13 @@ static const struct dma_option dma_rx_option = {
  * to handle a request/response header, flash write offset/size, and 512 bytes
  * of flash data.
  */
+#ifdef CONFIG_SPI_HOST_PACKET_SIZE
+#define SPI_MAX_REQUEST_SIZE CONFIG_SPI_HOST_PACKET_SIZE
+#define SPI_MAX_RESPONSE_SIZE CONFIG_SPI_HOST_PACKET_SIZE
+#else
 #define SPI_MAX_REQUEST_SIZE 0x220
 #define SPI_MAX_RESPONSE_SIZE 0x220
+#endif
 
 /*
  * The AP blindly clocks back bytes over the SPI interface looking for a
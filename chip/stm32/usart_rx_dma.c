@@ -14,7 +14,7 @@
 #include "util.h"
 
 typedef size_t (*add_data_t)(struct usart_config const *config,
-	const uint8_t *src, size_t count);
+	struct queue_chunk const *chunks, size_t n);
 
 void usart_rx_dma_init(struct usart_config const *config)
 {
@@ -58,25 +58,32 @@ static void usart_rx_dma_interrupt_common(
 	size_t     added     = 0;
 
 	if (new_index > old_index) {
-		new_bytes = new_index - old_index;
+		struct queue_chunk chunk = {
+			.count  = new_index - old_index,
+			.buffer = dma_config->fifo_buffer + old_index,
+		};
 
-		added = add_data(config,
-				dma_config->fifo_buffer + old_index,
-				new_bytes);
+		new_bytes = chunk.count;
+		added = add_data(config, &chunk, 1);
 	} else if (new_index < old_index) {
 		/*
 		 * Handle the case where the received bytes are not contiguous
-		 * in the circular DMA buffer.  This is done with two queue
-		 * adds.
+		 * in the circular DMA buffer.  Both pieces are handed over as
+		 * one batch, so the consumer is only notified once.
 		 */
-		new_bytes = dma_config->fifo_size - (old_index - new_index);
-
-		added = add_data(config,
-				dma_config->fifo_buffer + old_index,
-				dma_config->fifo_size - old_index) +
-			add_data(config,
-				dma_config->fifo_buffer,
-				new_index);
+		struct queue_chunk chunks[2] = {
+			{
+				.count  = dma_config->fifo_size - old_index,
+				.buffer = dma_config->fifo_buffer + old_index,
+			},
+			{
+				.count  = new_index,
+				.buffer = dma_config->fifo_buffer,
+			},
+		};
+
+		new_bytes = chunks[0].count + chunks[1].count;
+		added = add_data(config, chunks, ARRAY_SIZE(chunks));
 	} else {
 		/* (new_index == old_index): nothing to add to the queue. */
 	}
@@ -90,9 +97,9 @@ static void usart_rx_dma_interrupt_common(
 }
 
 static size_t queue_add(struct usart_config const *config,
-			const uint8_t *src, size_t count)
+			struct queue_chunk const *chunks, size_t n)
 {
-	return queue_add_units(config->producer.queue, (void *)src, count);
+	return queue_add_chunks(config->producer.queue, chunks, n);
 }
 
 void usart_rx_dma_interrupt(struct usart_config const *config)
@@ -102,10 +109,23 @@ void usart_rx_dma_interrupt(struct usart_config const *config)
 
 
 #if defined(CONFIG_USART_HOST_COMMAND)
+static size_t host_command_add(struct usart_config const *config,
+			       struct queue_chunk const *chunks, size_t n)
+{
+	size_t added = 0;
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		added += usart_host_command_rx_append_data(config,
+							   chunks[i].buffer,
+							   chunks[i].count);
+
+	return added;
+}
+
 void usart_host_command_rx_dma_interrupt(struct usart_config const *config)
 {
-	usart_rx_dma_interrupt_common(config,
-				      &usart_host_command_rx_append_data);
+	usart_rx_dma_interrupt_common(config, &host_command_add);
 }
 #endif /* CONFIG_USART_HOST_COMMAND */
 
@@ -17,7 +17,12 @@
 #define CPRINTS(format, args...) cprints(CC_I2C, format, ## args)
 
 static int usb_power_init_inas(struct usb_power_config const *config);
+static int usb_power_init_buses(struct usb_power_config const *config);
+static int reg_type_mapping(enum usb_power_ina_type ina_type);
+static int32_t usb_power_sample_value(const struct usb_power_ina_cfg *ina,
+				      uint16_t val);
 static int usb_power_read(struct usb_power_config const *config);
+static int usb_power_get_samples(struct usb_power_config const *config);
 static int usb_power_write_line(struct usb_power_config const *config);
 
 void usb_power_deferred_rx(struct usb_power_config const *config)
@@ -73,12 +78,10 @@ void usb_power_event(struct usb_power_config const *config,
 static int usb_power_write_line(struct usb_power_config const *config)
 {
 	struct usb_power_state *state = config->state;
-	struct usb_power_report *r = (struct usb_power_report *)(
-		state->reports_data_area +
-		(USB_POWER_RECORD_SIZE(state->ina_count)
-		* state->reports_tail));
+	uint8_t *r = state->reports_data_area +
+		(state->stride_bytes * state->reports_tail);
 	/* status + size + timestamps + power list */
-	size_t bytes = USB_POWER_RECORD_SIZE(state->ina_count);
+	size_t bytes = state->stride_bytes;
 
 	/* Check if queue has active data. */
 	if (config->state->reports_head != config->state->reports_tail) {
@@ -112,6 +115,7 @@ static int usb_power_state_reset(struct usb_power_config const *config)
 	state->reports_head = 0;
 	state->reports_tail = 0;
 	state->reports_xmit_active = 0;
+	state->policy = USB_POWER_OVERFLOW_STOP;
 
 	CPRINTS("[RESET] STATE -> OFF");
 	return USB_POWER_SUCCESS;
@@ -145,6 +149,9 @@ static int usb_power_state_start(struct usb_power_config const *config,
 	struct usb_power_state *state = config->state;
 	int integration_us = cmd->start.integration_us;
 	int ret;
+#ifdef CONFIG_I2C_XFER_ASYNC
+	int i;
+#endif
 
 	if (state->state != USB_POWER_STATE_SETUP) {
 		CPRINTS("[START] Error not setup.");
@@ -162,9 +169,29 @@ static int usb_power_state_start(struct usb_power_config const *config,
 		return USB_POWER_ERROR_UNKNOWN;
 	}
 
+#ifdef CONFIG_I2C_XFER_ASYNC
+	/* Reads from a previous capture must finish before we reuse them. */
+	for (i = 0; i < state->bus_count; i++) {
+		if (i2c_xfer_busy(&state->bus[i].req)) {
+			CPRINTS("[START] Error previous capture still reading");
+			return USB_POWER_ERROR_BUSY;
+		}
+	}
+#endif
+
 	/* Calculate the reports array */
-	state->stride_bytes = USB_POWER_RECORD_SIZE(state->ina_count);
-	state->max_cached = USB_POWER_MAX_CACHED(state->ina_count);
+	if (state->policy == USB_POWER_OVERFLOW_STOP)
+		state->stride_bytes = USB_POWER_RECORD_SIZE(state->ina_count);
+	else
+		state->stride_bytes = USB_POWER_BATCH_SIZE(state->ina_count);
+	state->max_cached = USB_POWER_DATA_SIZE / state->stride_bytes;
+
+	state->decimation = 0;
+	state->decimation_count = 0;
+	state->decimation_status = USB_POWER_SUCCESS;
+	memset(state->decimation_sum, 0, sizeof(state->decimation_sum));
+	memset(state->decimation_reads, 0, sizeof(state->decimation_reads));
+	state->dropped = 0;
 
 	state->integration_us = integration_us;
 	ret = usb_power_init_inas(config);
@@ -172,6 +199,10 @@ static int usb_power_state_start(struct usb_power_config const *config,
 	if (ret)
 		return USB_POWER_ERROR_INVAL;
 
+	ret = usb_power_init_buses(config);
+	if (ret)
+		return ret;
+
 	state->state = USB_POWER_STATE_CAPTURING;
 	CPRINTS("[START] STATE: SETUP -> CAPTURING %dus", integration_us);
 
@@ -202,6 +233,35 @@ static int usb_power_state_settime(struct usb_power_config const *config,
 }
 
 
+static int usb_power_state_setpolicy(struct usb_power_config const *config,
+				 union usb_power_command_data *cmd, int count)
+{
+	struct usb_power_state *state = config->state;
+
+	/* Only valid from OFF or SETUP */
+	if ((state->state != USB_POWER_STATE_OFF) &&
+	    (state->state != USB_POWER_STATE_SETUP)) {
+		CPRINTS("[SETPOLICY] Error incorrect state.");
+		return USB_POWER_ERROR_NOT_SETUP;
+	}
+
+	if (count != sizeof(struct usb_power_command_setpolicy)) {
+		CPRINTS("[SETPOLICY] Error count %d is not %d",
+			(int)count, sizeof(struct usb_power_command_setpolicy));
+		return USB_POWER_ERROR_READ_SIZE;
+	}
+
+	if (cmd->setpolicy.policy > USB_POWER_OVERFLOW_DECIMATE) {
+		CPRINTS("[SETPOLICY] Error policy 0x%x invalid",
+			(int)(cmd->setpolicy.policy));
+		return USB_POWER_ERROR_INVAL;
+	}
+
+	state->policy = cmd->setpolicy.policy;
+	return USB_POWER_SUCCESS;
+}
+
+
 static int usb_power_state_addina(struct usb_power_config const *config,
 				 union usb_power_command_data *cmd, int count)
 {
@@ -252,6 +312,7 @@ static int usb_power_state_addina(struct usb_power_config const *config,
 	ina->addr_flags = cmd->addina.addr_flags;
 	ina->rs = cmd->addina.rs;
 	ina->type = cmd->addina.type;
+	ina->reg = reg_type_mapping(ina->type);
 
 	/*
 	 * INAs can be shared, in that they will have various values
@@ -334,6 +395,10 @@ static int usb_power_read(struct usb_power_config const *config)
 		result = usb_power_state_settime(config, cmd, count);
 		break;
 
+	case USB_POWER_CMD_SETPOLICY:
+		result = usb_power_state_setpolicy(config, cmd, count);
+		break;
+
 	case USB_POWER_CMD_NEXT:
 		if (state->state == USB_POWER_STATE_CAPTURING) {
 			int ret;
@@ -389,7 +454,10 @@ static int usb_power_read(struct usb_power_config const *config)
 #define INA231_MODE_BUS			0x6
 #define INA231_MODE_BOTH		0x7
 
-int reg_type_mapping(enum usb_power_ina_type ina_type)
+/* Value reported for a register that could not be read. */
+#define INA231_READ_FAILED		0x0bad
+
+static int reg_type_mapping(enum usb_power_ina_type ina_type)
 {
 	switch (ina_type) {
 	case USBP_INA231_POWER:
@@ -406,6 +474,22 @@ int reg_type_mapping(enum usb_power_ina_type ina_type)
 	}
 }
 
+/*
+ * Value of a register read for averaging.  Current and shunt voltage are
+ * two's complement, power and bus voltage are unsigned.
+ */
+static int32_t usb_power_sample_value(const struct usb_power_ina_cfg *ina,
+				      uint16_t val)
+{
+	switch (reg_type_mapping(ina->type)) {
+	case INA231_REG_CURR:
+	case INA231_REG_RSHV:
+		return (int16_t)val;
+	default:
+		return val;
+	}
+}
+
 uint16_t ina2xx_readagain(uint8_t port, uint16_t slave_addr_flags)
 {
 	int res;
@@ -417,7 +501,7 @@ uint16_t ina2xx_readagain(uint8_t port, uint16_t slave_addr_flags)
 	if (res) {
 		CPRINTS("INA2XX I2C readagain failed p:%d a:%02x",
 			(int)port, (int)I2C_STRIP_FLAGS(slave_addr_flags));
-		return 0x0bad;
+		return INA231_READ_FAILED;
 	}
 	return (val >> 8) | ((val & 0xff) << 8);
 }
@@ -434,7 +518,7 @@ uint16_t ina2xx_read(uint8_t port, uint16_t slave_addr_flags,
 		CPRINTS("INA2XX I2C read failed p:%d a:%02x, r:%02x",
 			(int)port, (int)I2C_STRIP_FLAGS(slave_addr_flags),
 			(int)reg);
-		return 0x0bad;
+		return INA231_READ_FAILED;
 	}
 	return (val >> 8) | ((val & 0xff) << 8);
 }
@@ -590,8 +674,7 @@ static int usb_power_init_inas(struct usb_power_config const *config)
 		 * will be cached and all ina2xx_readagain() calls will read
 		 * from the same address.
 		 */
-		ina2xx_read(ina->port, ina->addr_flags,
-			    reg_type_mapping(ina->type));
+		ina2xx_read(ina->port, ina->addr_flags, ina->reg);
 #ifdef USB_POWER_VERBOSE
 		CPRINTS("[CAP] %d (%d,0x%02x): type:%d", (int)(ina->type));
 #endif
@@ -602,42 +685,302 @@ static int usb_power_init_inas(struct usb_power_config const *config)
 
 
 /*
- * Read each INA's power integration measurement.
- *
- * INAs recall the most recent address, so no register access write is
- * necessary, simply read 16 bits from each INA and fill the result into
- * the power record.
+ * Queue the values in state->sample as a power record taken at time.
  *
- * If the power record ringbuffer is full, fail with USB_POWER_ERROR_OVERFLOW.
+ * If the power record ringbuffer is full, the overflow policy decides what
+ * to lose: the whole capture (fail with USB_POWER_ERROR_OVERFLOW), the oldest
+ * queued record, or resolution, by averaging twice as many samples into each
+ * record from then on.  Decimation steps back down once the host catches up.
  */
-static int usb_power_get_samples(struct usb_power_config const *config)
+static int usb_power_queue_sample(struct usb_power_config const *config,
+				  uint64_t time, int status)
 {
-	uint64_t time = get_time().val;
 	struct usb_power_state *state = config->state;
-	struct usb_power_report *r = (struct usb_power_report *)(
-		state->reports_data_area +
-		(USB_POWER_RECORD_SIZE(state->ina_count)
-		* state->reports_head));
-	struct usb_power_ina_cfg *inas = state->ina_cfg;
+	uint8_t *r;
+	int next;
 	int i;
 
-	/* TODO(nsanders): Would we prefer to evict oldest? */
-	if (((state->reports_head + 1) % USB_POWER_MAX_CACHED(state->ina_count))
-	    == state->reports_xmit_active) {
-		CPRINTS("Overflow! h:%d a:%d t:%d (%d)",
-			state->reports_head, state->reports_xmit_active,
-			state->reports_tail,
-			USB_POWER_MAX_CACHED(state->ina_count));
-		return USB_POWER_ERROR_OVERFLOW;
+	if (state->policy == USB_POWER_OVERFLOW_DECIMATE) {
+		/* Failed reads are left out of the average. */
+		for (i = 0; i < state->ina_count; i++) {
+			if (state->sample[i] == INA231_READ_FAILED)
+				continue;
+			state->decimation_sum[i] += usb_power_sample_value(
+				state->ina_cfg + i, state->sample[i]);
+			state->decimation_reads[i]++;
+		}
+		if (status != USB_POWER_SUCCESS)
+			state->decimation_status = status;
+
+		state->decimation_count++;
+		if (state->decimation_count < (1 << state->decimation))
+			return EC_SUCCESS;
+
+		for (i = 0; i < state->ina_count; i++) {
+			if (state->decimation_reads[i])
+				state->sample[i] = state->decimation_sum[i] /
+						   state->decimation_reads[i];
+			else
+				state->sample[i] = INA231_READ_FAILED;
+			state->decimation_sum[i] = 0;
+			state->decimation_reads[i] = 0;
+		}
+		status = state->decimation_status;
+		state->decimation_status = USB_POWER_SUCCESS;
+		state->decimation_count = 0;
+	}
+
+	next = (state->reports_head + 1) % state->max_cached;
+	if (next == state->reports_xmit_active) {
+		switch (state->policy) {
+		case USB_POWER_OVERFLOW_EVICT:
+			/*
+			 * Records already handed to USB can't be touched, so
+			 * if the oldest one is in flight drop this one instead.
+			 */
+			if ((state->reports_xmit_active != state->reports_tail)
+			    || (state->reports_tail == state->reports_head)) {
+				state->dropped++;
+				return EC_SUCCESS;
+			}
+			r = state->reports_data_area +
+				(state->stride_bytes * state->reports_tail);
+			i = ((struct usb_power_batch *)r)->dropped + 1;
+
+			state->reports_tail = (state->reports_tail + 1) %
+				state->max_cached;
+			state->reports_xmit_active = state->reports_tail;
+
+			/* The new oldest record owns the gap before it. */
+			r = state->reports_data_area +
+				(state->stride_bytes * state->reports_tail);
+			i += ((struct usb_power_batch *)r)->dropped;
+			((struct usb_power_batch *)r)->dropped = MIN(i, 0xff);
+			break;
+
+		case USB_POWER_OVERFLOW_DECIMATE:
+			if (state->decimation < USB_POWER_MAX_DECIMATION)
+				state->decimation++;
+			state->dropped++;
+			return EC_SUCCESS;
+
+		default:
+			CPRINTS("Overflow! h:%d a:%d t:%d (%d)",
+				state->reports_head, state->reports_xmit_active,
+				state->reports_tail, state->max_cached);
+			return USB_POWER_ERROR_OVERFLOW;
+		}
 	}
 
-	r->status = USB_POWER_SUCCESS;
-	r->size = state->ina_count;
 	if (config->state->wall_offset)
 		time = time + config->state->wall_offset;
 	else
 		time -= config->state->base_time;
-	r->timestamp = time;
+
+	r = state->reports_data_area +
+		(state->stride_bytes * state->reports_head);
+	if (state->policy == USB_POWER_OVERFLOW_STOP) {
+		struct usb_power_report *report = (struct usb_power_report *)r;
+
+		report->status = status;
+		report->size = state->ina_count;
+		report->timestamp = time;
+		for (i = 0; i < state->ina_count; i++)
+			report->power[i] = state->sample[i];
+	} else {
+		struct usb_power_batch *batch = (struct usb_power_batch *)r;
+
+		batch->status = status;
+		batch->size = state->ina_count;
+		batch->decimation = state->decimation;
+		batch->dropped = MIN(state->dropped, 0xff);
+		batch->timestamp = time;
+		for (i = 0; i < state->ina_count; i++)
+			batch->power[i] = state->sample[i];
+		state->dropped = 0;
+	}
+
+	/* Mark this slot as used. */
+	state->reports_head = next;
+
+	if (state->decimation &&
+	    ((state->reports_head - state->reports_xmit_active +
+	      state->max_cached) % state->max_cached)
+	    < (state->max_cached / 4))
+		state->decimation--;
+
+	return EC_SUCCESS;
+}
+
+#ifdef CONFIG_I2C_XFER_ASYNC
+/*
+ * Called from the HOOKS task as each bus finishes its reads.  Once the last
+ * bus is done, the sample is complete and can be queued.
+ */
+static void usb_power_bus_done(struct i2c_async_req *req)
+{
+	struct usb_power_bus *bus = DOWNCAST(req, struct usb_power_bus, req);
+	struct usb_power_config const *config = bus->config;
+	struct usb_power_state *state = config->state;
+	int i;
+
+	if (req->rv != EC_SUCCESS) {
+		CPRINTS("INA2XX I2C read failed p:%d", req->port);
+		state->sample_status = USB_POWER_ERROR_I2C;
+	}
+
+	/* INAs return big endian values. */
+	for (i = 0; i < req->count; i++) {
+		uint16_t *val = (uint16_t *)req->ops[i].in;
+
+		if (req->rv != EC_SUCCESS)
+			*val = INA231_READ_FAILED;
+		else
+			*val = (*val >> 8) | ((*val & 0xff) << 8);
+	}
+
+	if (--state->bus_pending)
+		return;
+
+	/* Stopped or reset while this sample was being read. */
+	if (state->state != USB_POWER_STATE_CAPTURING)
+		return;
+
+	if (usb_power_queue_sample(config, state->sample_time,
+				   state->sample_status) ==
+	    USB_POWER_ERROR_OVERFLOW) {
+		CPRINTS("[CAP] usb_power_bus_done: OVERFLOW");
+		hook_call_deferred(config->deferred_cap, -1);
+		return;
+	}
+
+	/* A timeslice came up during the reads: take it now. */
+	if (state->sample_waiting)
+		usb_power_get_samples(config);
+}
+#endif
+
+/*
+ * Group the INAs by I2C bus, so that a sample is one request per bus, with
+ * all the buses queued at once rather than each INA read in turn.
+ */
+static int usb_power_init_buses(struct usb_power_config const *config)
+{
+#ifdef CONFIG_I2C_XFER_ASYNC
+	struct usb_power_state *state = config->state;
+	int op = 0;
+	int i, j;
+
+	state->bus_count = 0;
+	state->bus_pending = 0;
+	state->sample_waiting = 0;
+
+	for (i = 0; i < state->ina_count; i++) {
+		struct usb_power_ina_cfg *ina = state->ina_cfg + i;
+		struct usb_power_bus *bus;
+
+		/* Skip buses already grouped for an earlier INA. */
+		for (j = 0; j < i; j++) {
+			if (state->ina_cfg[j].port == ina->port)
+				break;
+		}
+		if (j < i)
+			continue;
+
+		if (state->bus_count >= USB_POWER_MAX_BUSES) {
+			CPRINTS("[START] Error more than %d I2C buses",
+				USB_POWER_MAX_BUSES);
+			return USB_POWER_ERROR_INVAL;
+		}
+
+		bus = state->bus + state->bus_count;
+		state->bus_count++;
+
+		bus->config = config;
+		bus->req.port = ina->port;
+		bus->req.ops = state->ops + op;
+		bus->req.count = 0;
+		bus->req.done = usb_power_bus_done;
+		bus->req.event = 0;
+
+		for (j = i; j < state->ina_count; j++) {
+			struct usb_power_ina_cfg *tmp = state->ina_cfg + j;
+			struct i2c_async_op *o = state->ops + op;
+
+			if (tmp->port != ina->port)
+				continue;
+
+			/*
+			 * Unshared INAs still point at the register set up in
+			 * usb_power_init_inas(), so a bare read is enough.
+			 */
+			o->addr_flags = tmp->addr_flags;
+			o->out = &tmp->reg;
+			o->out_size = tmp->shared ? 1 : 0;
+			o->in = (uint8_t *)(state->sample + j);
+			o->in_size = sizeof(uint16_t);
+			bus->req.count++;
+			op++;
+		}
+	}
+#endif
+	return EC_SUCCESS;
+}
+
+#ifdef CONFIG_I2C_XFER_ASYNC
+/*
+ * Queue one read request per I2C bus.  Each INA's value lands straight in
+ * its state->sample slot, and the sample is queued as a power record by
+ * usb_power_bus_done() once every bus has finished.
+ *
+ * If the previous sample is still being read, this timeslice is skipped and
+ * counted as dropped.  Records in the stop policy have no room to report
+ * drops, so there the next sample starts as soon as the previous one is done
+ * instead, as it would with blocking reads.
+ */
+static int usb_power_get_samples(struct usb_power_config const *config)
+{
+	struct usb_power_state *state = config->state;
+	int i;
+
+	if (state->bus_pending) {
+		if (state->policy == USB_POWER_OVERFLOW_STOP)
+			state->sample_waiting = 1;
+		else
+			state->dropped++;
+		return EC_SUCCESS;
+	}
+
+	state->sample_waiting = 0;
+
+	state->sample_time = get_time().val;
+	state->sample_status = USB_POWER_SUCCESS;
+	state->bus_pending = state->bus_count;
+
+	for (i = 0; i < state->bus_count; i++) {
+		struct i2c_async_req *req = &state->bus[i].req;
+
+		req->rv = i2c_xfer_submit(req);
+		if (req->rv != EC_SUCCESS)
+			usb_power_bus_done(req);
+	}
+
+	return EC_SUCCESS;
+}
+#else
+/*
+ * Read each INA's power integration measurement.
+ *
+ * INAs recall the most recent address, so no register access write is
+ * necessary, simply read 16 bits from each INA and fill the result into
+ * the power record.
+ */
+static int usb_power_get_samples(struct usb_power_config const *config)
+{
+	uint64_t time = get_time().val;
+	struct usb_power_state *state = config->state;
+	struct usb_power_ina_cfg *inas = state->ina_cfg;
+	int i;
 
 	for (i = 0; i < state->ina_count; i++) {
 		int regval;
@@ -650,11 +993,11 @@ static int usb_power_get_samples(struct usb_power_config const *config)
 		 */
 		if (ina->shared)
 			regval = ina2xx_read(ina->port, ina->addr_flags,
-					reg_type_mapping(ina->type));
+					     ina->reg);
 		else
 			regval = ina2xx_readagain(ina->port,
 						  ina->addr_flags);
-		r->power[i] = regval;
+		state->sample[i] = regval;
 #ifdef USB_POWER_VERBOSE
 		{
 		int current;
@@ -688,12 +1031,9 @@ static int usb_power_get_samples(struct usb_power_config const *config)
 #endif
 	}
 
-	/* Mark this slot as used. */
-	state->reports_head = (state->reports_head + 1) %
-		USB_POWER_MAX_CACHED(state->ina_count);
-
-	return EC_SUCCESS;
+	return usb_power_queue_sample(config, time, USB_POWER_SUCCESS);
 }
+#endif
 
 /*
  * This function is called every [interval] uS, and reads the accumulated
@@ -10,6 +10,7 @@
 
 #include "compile_time_macros.h"
 #include "hooks.h"
+#include "i2c.h"
 #include "usb_descriptor.h"
 #include "usb_hw.h"
 
@@ -66,6 +67,31 @@
  *     | 0x0005 | 8B: Wall clock time |
  *     +--------+---------------------+
  *
+ *     setpolicy:	0x0006
+ *     +--------+------------------------+
+ *     | 0x0006 | 1B: overflow policy    |
+ *     +--------+------------------------+
+ *
+ *     Valid before start.  Selects what happens when samples are taken
+ *     faster than the host reads them, until the next reset.  Policies
+ *     other than 0x00 also switch next responses to batch records:
+ *
+ *	 0x00: Stop sampling (default)
+ *	 0x01: Evict the oldest queued record
+ *	 0x02: Decimate, averaging 2, 4, 8... samples into each record
+ *
+ *     next response with batch records:
+ *     +-------------+----------+-----------------+--------------+
+ *     | status : 1B | size: 1B | decimation : 1B | dropped : 1B |
+ *     +-------------+----------+-----------------+--------------+
+ *     +----------------+----------------------------+
+ *     | timestamp : 8B | payload : may span packets |
+ *     +----------------+----------------------------+
+ *
+ *     decimation: log2 of the number of samples averaged into this record
+ *
+ *     dropped: records lost since the previous one, saturating at 255
+ *
  *
  *     Status: 1 byte status
  *
@@ -84,7 +110,7 @@
  *
  *     size: 1 byte incoming INA reads count
  *
- *     timestamp: 4 byte timestamp associated with these samples
+ *     timestamp: 8 byte timestamp associated with these samples
  *
  */
 
@@ -111,6 +137,14 @@ enum usb_power_command {
 	USB_POWER_CMD_START	= 0x0003,
 	USB_POWER_CMD_NEXT	= 0x0004,
 	USB_POWER_CMD_SETTIME	= 0x0005,
+	USB_POWER_CMD_SETPOLICY	= 0x0006,
+};
+
+/* Setpolicy "overflow policy" field. */
+enum usb_power_overflow_policy {
+	USB_POWER_OVERFLOW_STOP		= 0x00,
+	USB_POWER_OVERFLOW_EVICT	= 0x01,
+	USB_POWER_OVERFLOW_DECIMATE	= 0x02,
 };
 
 /* Addina "INA Type" field. */
@@ -130,6 +164,10 @@ enum usb_power_states {
 
 #define USB_POWER_MAX_READ_COUNT 64
 #define USB_POWER_MIN_CACHED 10
+/* Largest log2 decimation, 128 samples per record. */
+#define USB_POWER_MAX_DECIMATION 7
+/* I2C buses sampled in parallel, one request each. */
+#define USB_POWER_MAX_BUSES I2C_PORT_COUNT
 
 struct usb_power_ina_cfg {
 	/*
@@ -152,6 +190,8 @@ struct usb_power_ina_cfg {
 	int type;
 	/* Is this INA returning the one value only and can use readagain? */
 	int shared;
+	/* Register read each sample, written before the read if shared. */
+	uint8_t reg;
 };
 
 
@@ -162,11 +202,25 @@ struct __attribute__ ((__packed__)) usb_power_report {
 	uint16_t power[USB_POWER_MAX_READ_COUNT];
 };
 
+/* Power report used once an overflow policy has been set. */
+struct __attribute__ ((__packed__)) usb_power_batch {
+	uint8_t status;
+	uint8_t size;
+	uint8_t decimation;
+	uint8_t dropped;
+	uint64_t timestamp;
+	uint16_t power[USB_POWER_MAX_READ_COUNT];
+};
+
 /* Must be 4 byte aligned */
 #define USB_POWER_RECORD_SIZE(ina_count)				\
 	((((sizeof(struct usb_power_report)				\
 	- (sizeof(uint16_t) * USB_POWER_MAX_READ_COUNT)			\
 	+ (sizeof(uint16_t) * (ina_count))) + 3) / 4) * 4)
+#define USB_POWER_BATCH_SIZE(ina_count)					\
+	((((sizeof(struct usb_power_batch)				\
+	- (sizeof(uint16_t) * USB_POWER_MAX_READ_COUNT)			\
+	+ (sizeof(uint16_t) * (ina_count))) + 3) / 4) * 4)
 
 #define USB_POWER_DATA_SIZE						\
 	(sizeof(struct usb_power_report) * (USB_POWER_MIN_CACHED + 1))
@@ -207,6 +261,37 @@ struct usb_power_state {
 	/* Xmit_active -> tail is active usb DMA */
 	int reports_xmit_active;
 
+	/* What to do when the ringbuffer is full. */
+	int policy;
+	/* log2 of samples averaged into each record. */
+	int decimation;
+	/* Samples summed so far for the next decimated record. */
+	int decimation_count;
+	int decimation_status;
+	int32_t decimation_sum[USB_POWER_MAX_READ_COUNT];
+	/* Successful reads in each sum, failed ones are left out. */
+	uint8_t decimation_reads[USB_POWER_MAX_READ_COUNT];
+	/* Records lost since the last one queued. */
+	int dropped;
+
+	/* Values read in the current sample, in INA order. */
+	uint16_t sample[USB_POWER_MAX_READ_COUNT];
+#ifdef CONFIG_I2C_XFER_ASYNC
+	/* One request per I2C bus, with its reads contiguous in ops. */
+	struct usb_power_bus {
+		struct i2c_async_req req;
+		struct usb_power_config const *config;
+	} bus[USB_POWER_MAX_BUSES];
+	int bus_count;
+	/* Buses still reading the current sample. */
+	int bus_pending;
+	uint64_t sample_time;
+	int sample_status;
+	/* A timeslice came up while reading, in the stop policy. */
+	int sample_waiting;
+	struct i2c_async_op ops[USB_POWER_MAX_READ_COUNT];
+#endif
+
 	/* Pointers to RAM. */
 	uint8_t rx_buf[USB_MAX_PACKET_SIZE];
 	uint8_t tx_buf[USB_MAX_PACKET_SIZE * 4];
@@ -253,11 +338,17 @@ struct __attribute__ ((__packed__)) usb_power_command_settime {
 	uint64_t time;
 };
 
+struct __attribute__ ((__packed__)) usb_power_command_setpolicy {
+	uint16_t command;
+	uint8_t policy;
+};
+
 union usb_power_command_data {
 	uint16_t command;
 	struct usb_power_command_start start;
 	struct usb_power_command_addina addina;
 	struct usb_power_command_settime settime;
+	struct usb_power_command_setpolicy setpolicy;
 };
 
 
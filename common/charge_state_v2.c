@@ -1494,6 +1494,10 @@ static void notify_host_of_low_battery_charge(void)
 
 static void set_charge_state(enum charge_state_v2 state)
 {
+	/* Don't let cached battery values lag behind a new charge state. */
+	if (state != curr.state)
+		battery_cache_invalidate();
+
 	prev_state = curr.state;
 	curr.state = state;
 }
@@ -1613,6 +1617,8 @@ DECLARE_HOOK(HOOK_INIT, charger_init, HOOK_PRIO_DEFAULT);
 /* Wake up the task when something important happens */
 static void charge_wakeup(void)
 {
+	/* Read every battery value afresh on the way through. */
+	battery_cache_invalidate();
 	task_wake(TASK_ID_CHARGER);
 }
 DECLARE_HOOK(HOOK_CHIPSET_RESUME, charge_wakeup, HOOK_PRIO_DEFAULT);
@@ -1770,6 +1776,7 @@ void charger_task(void *u)
 
 		if (prev_bp != curr.batt.is_present) {
 			prev_bp = curr.batt.is_present;
+			battery_cache_invalidate();
 
 			/* Update battery info due to change of battery */
 			batt_info = battery_get_info();
@@ -2653,6 +2660,14 @@ charge_command_charge_state(struct host_cmd_handler_args *args)
 			rv = charge_get_charge_state_debug(
 				in->get_param.param, &val);
 		} else
+#endif
+#ifdef CONFIG_BATTERY_SMART_CACHE
+		/* battery value ages and refresh periods */
+		if (in->get_param.param >= CS_PARAM_BATT_AGE_MIN &&
+		    in->get_param.param <= CS_PARAM_BATT_REFRESH_MAX) {
+			rv = battery_cache_get_param(in->get_param.param,
+						     &val);
+		} else
 #endif
 			/* standard params */
 			switch (in->get_param.param) {
@@ -2709,6 +2724,13 @@ charge_command_charge_state(struct host_cmd_handler_args *args)
 			rv  = charger_profile_override_set_param(
 				in->set_param.param, val);
 		} else
+#endif
+#ifdef CONFIG_BATTERY_SMART_CACHE
+		/* battery refresh periods */
+		if (in->set_param.param >= CS_PARAM_BATT_AGE_MIN &&
+		    in->set_param.param <= CS_PARAM_BATT_REFRESH_MAX) {
+			rv = battery_cache_set_param(in->set_param.param, val);
+		} else
 #endif
 			switch (in->set_param.param) {
 			case CS_PARAM_CHG_VOLTAGE:
@@ -47,6 +47,11 @@ static int input_pos;
 /* Was last received character a carriage return? */
 static int last_rx_was_cr;
 
+#ifdef CONFIG_CONSOLE_BATCH
+/* A command finished this wakeup; its prompt hasn't been printed yet */
+static int prompt_pending;
+#endif
+
 #ifndef CONFIG_EXPERIMENTAL_CONSOLE
 /* State of input escape code */
 static enum {
@@ -122,32 +127,46 @@ static int split_words(char *input, int *argc, char **argv)
  * command.  So "foo" will match "foobar" as long as there isn't also a
  * command "food".
  *
+ * The linker script sorts the .rodata.cmds.* sections by name, and command
+ * names are lower case, so __cmds is in strcasecmp() order.  All commands
+ * sharing a prefix are therefore adjacent; a binary search finds the first
+ * one, and the entry after it tells whether the prefix is ambiguous.
+ *
  * @param name		Command name to find.
  *
  * @return A pointer to the command structure, or NULL if no match found.
  */
 static const struct console_command *find_command(char *name)
 {
-	const struct console_command *cmd, *match = NULL;
+	const struct console_command *l = __cmds, *r = __cmds_end, *m;
 	int match_length = strlen(name);
 
-	for (cmd = __cmds; cmd < __cmds_end; cmd++) {
-		if (!strncasecmp(name, cmd->name, match_length)) {
-			if (match)
-				return NULL;
-			/*
-			 * Check if 'cmd->name' is of the same length as
-			 * 'name'. If yes, then we have a full match.
-			 */
-			if (cmd->name[match_length] == '\0')
-				return cmd;
-			match = cmd;
-		}
+	/* Find the first command that doesn't sort before the prefix */
+	while (l < r) {
+		m = l + (r - l) / 2;
+		if (strncasecmp(m->name, name, match_length) < 0)
+			l = m + 1;
+		else
+			r = m;
 	}
 
-	return match;
-}
+	if (l == __cmds_end || strncasecmp(l->name, name, match_length))
+		return NULL;
+
+	/*
+	 * Check if 'l->name' is of the same length as 'name'. If yes, then we
+	 * have a full match.  It sorts first among the commands it prefixes.
+	 */
+	if (l->name[match_length] == '\0')
+		return l;
+
+	/* A second command with the same prefix makes the match ambiguous */
+	if (l + 1 < __cmds_end &&
+	    !strncasecmp(l[1].name, name, match_length))
+		return NULL;
 
+	return l;
+}
 
 static const char *const errmsgs[] = {
 	"OK",
@@ -459,6 +478,26 @@ static int handle_esc(int c)
 }
 #endif /* !defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
+#ifdef CONFIG_CONSOLE_BATCH
+/*
+ * Print the prompt held back by the last command.  If the next line was
+ * already started in the same wakeup, its echo is on screen without a prompt,
+ * so return to the start of the line and redraw it after the prompt.
+ */
+static void console_flush_prompt(void)
+{
+	if (!prompt_pending)
+		return;
+
+	prompt_pending = 0;
+	if (input_len)
+		console_putc('\r');
+	ccputs(PROMPT);
+	ccputs(input_buf);
+	repeat_char('\b', input_len - input_pos);
+}
+#endif
+
 static void console_handle_char(int c)
 {
 #ifdef CONFIG_EXPERIMENTAL_CONSOLE
@@ -496,6 +535,15 @@ static void console_handle_char(int c)
 	}
 #endif /* !defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
+#ifdef CONFIG_CONSOLE_BATCH
+	/*
+	 * Line editing keys need the prompt and current line on screen.
+	 * Extended KEY_* codes are above the range isprint() accepts.
+	 */
+	if (c != -1 && c != '\n' && (c >= 0x100 || !isprint(c)))
+		console_flush_prompt();
+#endif
+
 	switch (c) {
 #ifndef CONFIG_EXPERIMENTAL_CONSOLE
 	case KEY_DEL:
@@ -534,10 +582,13 @@ static void console_handle_char(int c)
 		input_pos = input_len = 0;
 		input_buf[0] = '\0';
 
-#ifndef CONFIG_EXPERIMENTAL_CONSOLE
+#ifdef CONFIG_CONSOLE_BATCH
+		/* Reprint prompt once the pending input has been handled */
+		prompt_pending = 1;
+#elif !defined(CONFIG_EXPERIMENTAL_CONSOLE)
 		/* Reprint prompt */
 		ccputs(PROMPT);
-#endif /* !defined(CONFIG_EXPERIMENTAL_CONSOLE) */
+#endif
 		break;
 
 #ifndef CONFIG_EXPERIMENTAL_CONSOLE
@@ -609,8 +660,8 @@ static void console_handle_char(int c)
 #endif /* !defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
 	default:
-		/* Ignore non-printing characters */
-		if (!isprint(c))
+		/* Ignore non-printing characters and extended key codes */
+		if (c >= 0x100 || !isprint(c))
 			break;
 
 #ifndef CONFIG_EXPERIMENTAL_CONSOLE
@@ -669,6 +720,9 @@ void console_task(void *u)
 			console_handle_char(c);
 		}
 
+#ifdef CONFIG_CONSOLE_BATCH
+		console_flush_prompt();
+#endif
 		task_wait_event(-1);  /* Wait for more input */
 	}
 }
@@ -57,6 +57,9 @@ static uint32_t matching_time_us;
 static uint32_t overall_time_us;
 static timestamp_t overall_t0;
 static uint8_t timestamps_invalid;
+static timestamp_t frame_upload_t0;
+static uint32_t frame_upload_time_us;
+static uint16_t frame_upload_chunks;
 
 BUILD_ASSERT(sizeof(struct ec_fp_template_encryption_metadata) % 4 == 0);
 
@@ -375,6 +378,20 @@ int validate_fp_buffer_offset(const uint32_t buffer_size, const uint32_t offset,
 	return EC_SUCCESS;
 }
 
+/*
+ * Account for one chunk of a frame or template served to the host. The upload
+ * starts with the chunk at offset 0.
+ */
+static void fp_frame_upload_progress(uint32_t offset)
+{
+	if (!offset) {
+		frame_upload_t0 = get_time();
+		frame_upload_chunks = 0;
+	}
+	frame_upload_chunks++;
+	frame_upload_time_us = time_since32(frame_upload_t0);
+}
+
 static enum ec_status fp_command_frame(struct host_cmd_handler_args *args)
 {
 	const struct ec_params_fp_frame *params = args->params;
@@ -404,6 +421,7 @@ static enum ec_status fp_command_frame(struct host_cmd_handler_args *args)
 
 		memcpy(out, fp_buffer + offset, size);
 		args->response_size = size;
+		fp_frame_upload_progress(params->offset & FP_FRAME_OFFSET_MASK);
 		return EC_RES_SUCCESS;
 	}
 
@@ -492,6 +510,7 @@ static enum ec_status fp_command_frame(struct host_cmd_handler_args *args)
 	}
 	memcpy(out, fp_enc_buffer + offset, size);
 	args->response_size = size;
+	fp_frame_upload_progress(offset);
 
 	return EC_RES_SUCCESS;
 }
@@ -512,11 +531,16 @@ static enum ec_status fp_command_stats(struct host_cmd_handler_args *args)
 	 * secret is read/disabled, and we are not using this field in biod.
 	 */
 	r->template_matched = positive_match_secret_state.template_matched;
+	r->frame_upload_chunks = frame_upload_chunks;
+	r->frame_upload_time_us = frame_upload_time_us;
 
-	args->response_size = sizeof(*r);
+	/* V1 is identical to V0 with more information appended */
+	args->response_size = args->version ? sizeof(*r) :
+			sizeof(struct ec_response_fp_stats_v0);
 	return EC_RES_SUCCESS;
 }
-DECLARE_HOST_COMMAND(EC_CMD_FP_STATS, fp_command_stats, EC_VER_MASK(0));
+DECLARE_HOST_COMMAND(EC_CMD_FP_STATS, fp_command_stats,
+		     EC_VER_MASK(0) | EC_VER_MASK(1));
 
 static bool template_needs_validation_value(
 	struct ec_fp_template_encryption_metadata *enc_info)
@@ -17,6 +17,43 @@
 #error "fpsensor requires AES, AES_GCM and ROLLBACK_SECRET_SIZE"
 #endif
 
+static int sw_aes_gcm_encrypt(const uint8_t *key, int key_size,
+			      const uint8_t *plaintext,
+			      uint8_t *ciphertext, int text_size,
+			      const uint8_t *nonce, int nonce_size,
+			      uint8_t *tag, int tag_size);
+static int sw_aes_gcm_decrypt(const uint8_t *key, int key_size,
+			      uint8_t *plaintext,
+			      const uint8_t *ciphertext, int text_size,
+			      const uint8_t *nonce, int nonce_size,
+			      const uint8_t *tag, int tag_size);
+
+const struct fp_crypto_backend fp_crypto_sw = {
+	.name = "sw",
+	.aes_gcm_encrypt = sw_aes_gcm_encrypt,
+	.aes_gcm_decrypt = sw_aes_gcm_decrypt,
+	.hmac_sha256 = hmac_SHA256,
+};
+
+#define FP_CRYPTO_DEFAULT (&fp_crypto_sw)
+
+#ifdef TEST_BUILD
+static const struct fp_crypto_backend *crypto = FP_CRYPTO_DEFAULT;
+
+void fp_crypto_set_backend(const struct fp_crypto_backend *backend)
+{
+	crypto = backend ? backend : FP_CRYPTO_DEFAULT;
+}
+#else
+/* Fixed at build time, so it can't be swapped out from under the keys. */
+static const struct fp_crypto_backend *const crypto = FP_CRYPTO_DEFAULT;
+#endif
+
+const struct fp_crypto_backend *fp_crypto_get_backend(void)
+{
+	return crypto;
+}
+
 static int get_ikm(uint8_t *ikm)
 {
 	int ret;
@@ -51,7 +88,7 @@ static void hkdf_extract(uint8_t *prk, const uint8_t *salt, size_t salt_size,
 	 * Derive a key with the "extract" step of HKDF
 	 * https://tools.ietf.org/html/rfc5869#section-2.2
 	 */
-	hmac_SHA256(prk, salt, salt_size, ikm, ikm_size);
+	crypto->hmac_sha256(prk, salt, salt_size, ikm, ikm_size);
 }
 
 static int hkdf_expand_one_step(uint8_t *out_key, size_t out_key_size,
@@ -75,7 +112,8 @@ static int hkdf_expand_one_step(uint8_t *out_key, size_t out_key_size,
 	memcpy(message_buf, info, info_size);
 	/* 1 step, set the counter byte to 1. */
 	message_buf[info_size] = 0x01;
-	hmac_SHA256(key_buf, prk, prk_size, message_buf, info_size + 1);
+	crypto->hmac_sha256(key_buf, prk, prk_size, message_buf,
+			    info_size + 1);
 
 	memcpy(out_key, key_buf, out_key_size);
 	always_memset(key_buf, 0, sizeof(key_buf));
@@ -123,8 +161,8 @@ int hkdf_expand(uint8_t *out_key, size_t L, const uint8_t *prk,
 		memcpy(info_buffer, T, T_len);
 		memcpy(info_buffer + T_len, info, info_size);
 		info_buffer[T_len + info_size] = count;
-		hmac_SHA256(T_buffer, prk, prk_size, info_buffer,
-			    T_len + info_size + sizeof(count));
+		crypto->hmac_sha256(T_buffer, prk, prk_size, info_buffer,
+				    T_len + info_size + sizeof(count));
 		memcpy(out_key, T_buffer, block_size);
 
 		T += T_len;
@@ -216,21 +254,16 @@ int derive_encryption_key(uint8_t *out_key, const uint8_t *salt)
 	return ret;
 }
 
-int aes_gcm_encrypt(const uint8_t *key, int key_size,
-		    const uint8_t *plaintext,
-		    uint8_t *ciphertext, int text_size,
-		    const uint8_t *nonce, int nonce_size,
-		    uint8_t *tag, int tag_size)
+static int sw_aes_gcm_encrypt(const uint8_t *key, int key_size,
+			      const uint8_t *plaintext,
+			      uint8_t *ciphertext, int text_size,
+			      const uint8_t *nonce, int nonce_size,
+			      uint8_t *tag, int tag_size)
 {
 	int res;
 	AES_KEY aes_key;
 	GCM128_CONTEXT ctx;
 
-	if (nonce_size != FP_CONTEXT_NONCE_BYTES) {
-		CPRINTS("Invalid nonce size %d bytes", nonce_size);
-		return EC_ERROR_INVAL;
-	}
-
 	res = AES_set_encrypt_key(key, 8 * key_size, &aes_key);
 	if (res) {
 		CPRINTS("Failed to set encryption key: %d", res);
@@ -249,20 +282,16 @@ int aes_gcm_encrypt(const uint8_t *key, int key_size,
 	return EC_SUCCESS;
 }
 
-int aes_gcm_decrypt(const uint8_t *key, int key_size, uint8_t *plaintext,
-		    const uint8_t *ciphertext, int text_size,
-		    const uint8_t *nonce, int nonce_size,
-		    const uint8_t *tag, int tag_size)
+static int sw_aes_gcm_decrypt(const uint8_t *key, int key_size,
+			      uint8_t *plaintext,
+			      const uint8_t *ciphertext, int text_size,
+			      const uint8_t *nonce, int nonce_size,
+			      const uint8_t *tag, int tag_size)
 {
 	int res;
 	AES_KEY aes_key;
 	GCM128_CONTEXT ctx;
 
-	if (nonce_size != FP_CONTEXT_NONCE_BYTES) {
-		CPRINTS("Invalid nonce size %d bytes", nonce_size);
-		return EC_ERROR_INVAL;
-	}
-
 	res = AES_set_encrypt_key(key, 8 * key_size, &aes_key);
 	if (res) {
 		CPRINTS("Failed to set decryption key: %d", res);
@@ -284,3 +313,48 @@ int aes_gcm_decrypt(const uint8_t *key, int key_size, uint8_t *plaintext,
 	}
 	return EC_SUCCESS;
 }
+
+int aes_gcm_encrypt(const uint8_t *key, int key_size,
+		    const uint8_t *plaintext,
+		    uint8_t *ciphertext, int text_size,
+		    const uint8_t *nonce, int nonce_size,
+		    uint8_t *tag, int tag_size)
+{
+	int res;
+
+	if (nonce_size != FP_CONTEXT_NONCE_BYTES) {
+		CPRINTS("Invalid nonce size %d bytes", nonce_size);
+		return EC_ERROR_INVAL;
+	}
+
+	res = crypto->aes_gcm_encrypt(key, key_size, plaintext, ciphertext,
+				      text_size, nonce, nonce_size, tag,
+				      tag_size);
+	if (res == EC_ERROR_UNIMPLEMENTED && crypto != &fp_crypto_sw)
+		res = sw_aes_gcm_encrypt(key, key_size, plaintext, ciphertext,
+					 text_size, nonce, nonce_size, tag,
+					 tag_size);
+	return res;
+}
+
+int aes_gcm_decrypt(const uint8_t *key, int key_size, uint8_t *plaintext,
+		    const uint8_t *ciphertext, int text_size,
+		    const uint8_t *nonce, int nonce_size,
+		    const uint8_t *tag, int tag_size)
+{
+	int res;
+
+	if (nonce_size != FP_CONTEXT_NONCE_BYTES) {
+		CPRINTS("Invalid nonce size %d bytes", nonce_size);
+		return EC_ERROR_INVAL;
+	}
+
+	res = crypto->aes_gcm_decrypt(key, key_size, plaintext, ciphertext,
+				      text_size, nonce, nonce_size, tag,
+				      tag_size);
+	if (res == EC_ERROR_UNIMPLEMENTED && crypto != &fp_crypto_sw)
+		res = sw_aes_gcm_decrypt(key, key_size, plaintext, ciphertext,
+					 text_size, nonce, nonce_size, tag,
+					 tag_size);
+	return res;
+}
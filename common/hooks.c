@@ -9,6 +9,7 @@
 #include "console.h"
 #include "hooks.h"
 #include "link_defs.h"
+#include "task.h"
 #include "timer.h"
 #include "util.h"
 
@@ -22,6 +23,27 @@
 
 #define DEFERRED_FUNCS_COUNT (__deferred_funcs_end - __deferred_funcs)
 
+/*
+ * Armed deferred routines are kept in a binary min-heap ordered by firing
+ * time, so arming and cancelling are O(log N) and the next deadline is always
+ * at the root.  deferred_heap[] holds deferred function indices in heap order,
+ * and deferred_pos[] holds the 1-based heap position of each function, or 0 if
+ * it is not armed.  Both live in the RAM the linker reserves at
+ * __deferred_heap, and must only be touched with interrupts locked.
+ */
+#define deferred_heap __deferred_heap
+#define deferred_pos (__deferred_heap + DEFERRED_FUNCS_COUNT)
+#ifdef CONFIG_HOOK_DEBUG
+/* Worst observed lateness of each deferred function, in us */
+#define deferred_max_late \
+	((uint32_t *)(__deferred_heap + 2 * DEFERRED_FUNCS_COUNT))
+#endif
+
+/* DECLARE_HOOK() emits hook_data from assembly; make sure the layout agrees */
+BUILD_ASSERT(offsetof(struct hook_data, priority) ==
+	     sizeof(void (*)(void)));
+BUILD_ASSERT(sizeof(((struct hook_data *)0)->priority) == 4);
+
 struct hook_ptrs {
 	const struct hook_data *start;
 	const struct hook_data *end;
@@ -64,8 +86,10 @@ static const struct hook_ptrs hook_list[] = {
 	{__hooks_usb_pd_connect, __hooks_usb_pd_connect_end},
 };
 
-/* Times for deferrable functions */
-static int defer_new_call;
+/* Number of armed deferred functions */
+static int deferred_heap_size;
+/* Time at which the hook task will next wake up on its own */
+static uint64_t hook_next_wake;
 static int hook_task_started;
 
 #ifdef CONFIG_HOOK_DEBUG
@@ -78,6 +102,12 @@ static uint64_t avg_hook_tick_delay;
 static uint64_t avg_hook_second_delay;
 static uint64_t avg_hook_run_time[ARRAY_SIZE(hook_list)];
 
+/* Slowest single routine seen for each hook type */
+static uint64_t max_hook_routine_time[ARRAY_SIZE(hook_list)];
+static void (*max_hook_routine[ARRAY_SIZE(hook_list)])(void);
+
+static int max_deferred_heap_size;
+
 static inline void update_hook_average(uint64_t *avg, uint64_t time)
 {
 	*avg = (*avg * 7 + time) >> 3;
@@ -104,36 +134,31 @@ static void record_hook_delay(uint64_t now, uint64_t last, uint64_t interval,
 
 void hook_notify(enum hook_type type)
 {
-	const struct hook_data *start, *end, *p;
-	int count, called = 0;
-	int last_prio = HOOK_PRIO_FIRST - 1, prio;
+	const struct hook_data *p;
 #ifdef CONFIG_HOOK_DEBUG
 	uint64_t start_time = get_time().val;
-	uint64_t run_time;
+	uint64_t hook_start_time = start_time;
+	uint64_t now, run_time;
 #endif
 
 	CPRINTS("hook notify %d", type);
 
-	start = hook_list[type].start;
-	end = hook_list[type].end;
-	count = end - start;
+	/*
+	 * The linker sorts each hook table by priority (see DECLARE_HOOK()),
+	 * so calling them in table order calls them in priority order.
+	 */
+	for (p = hook_list[type].start; p < hook_list[type].end; p++) {
+		p->routine();
 
-	/* Call all the hooks in priority order */
-	while (called < count) {
-		/* Find the lowest remaining priority */
-		for (p = start, prio = HOOK_PRIO_LAST + 1; p < end; p++) {
-			if (p->priority < prio && p->priority > last_prio)
-				prio = p->priority;
-		}
-		last_prio = prio;
-
-		/* Call all the hooks with that priority */
-		for (p = start; p < end; p++) {
-			if (p->priority == prio) {
-				called++;
-				p->routine();
-			}
+#ifdef CONFIG_HOOK_DEBUG
+		now = get_time().val;
+		run_time = now - hook_start_time;
+		if (run_time > max_hook_routine_time[type]) {
+			max_hook_routine_time[type] = run_time;
+			max_hook_routine[type] = p->routine;
 		}
+		hook_start_time = now;
+#endif
 	}
 
 #ifdef CONFIG_HOOK_DEBUG
@@ -144,28 +169,129 @@ void hook_notify(enum hook_type type)
 #endif
 }
 
+static inline int deferred_before(int a, int b)
+{
+	return __deferred_until[a] < __deferred_until[b];
+}
+
+static void deferred_heap_set(int pos, int i)
+{
+	deferred_heap[pos] = i;
+	deferred_pos[i] = pos + 1;
+}
+
+static void deferred_sift_up(int pos)
+{
+	int i = deferred_heap[pos];
+
+	while (pos > 0) {
+		int parent = (pos - 1) / 2;
+
+		if (!deferred_before(i, deferred_heap[parent]))
+			break;
+		deferred_heap_set(pos, deferred_heap[parent]);
+		pos = parent;
+	}
+	deferred_heap_set(pos, i);
+}
+
+static void deferred_sift_down(int pos)
+{
+	int i = deferred_heap[pos];
+
+	while (1) {
+		int child = 2 * pos + 1;
+
+		if (child >= deferred_heap_size)
+			break;
+		if (child + 1 < deferred_heap_size &&
+		    deferred_before(deferred_heap[child + 1],
+				    deferred_heap[child]))
+			child++;
+		if (!deferred_before(deferred_heap[child], i))
+			break;
+		deferred_heap_set(pos, deferred_heap[child]);
+		pos = child;
+	}
+	deferred_heap_set(pos, i);
+}
+
+/* Arm deferred function i to fire at time until, or move its deadline. */
+static void deferred_heap_arm(int i, uint64_t until)
+{
+	int pos = deferred_pos[i] - 1;
+	uint64_t old = __deferred_until[i];
+
+	__deferred_until[i] = until;
+
+	if (pos < 0) {
+		pos = deferred_heap_size++;
+		deferred_heap_set(pos, i);
+		deferred_sift_up(pos);
+#ifdef CONFIG_HOOK_DEBUG
+		if (deferred_heap_size > max_deferred_heap_size)
+			max_deferred_heap_size = deferred_heap_size;
+#endif
+	} else if (until < old) {
+		deferred_sift_up(pos);
+	} else {
+		deferred_sift_down(pos);
+	}
+}
+
+/* Disarm deferred function i, if it is armed. */
+static void deferred_heap_cancel(int i)
+{
+	int pos = deferred_pos[i] - 1;
+	int last;
+
+	__deferred_until[i] = 0;
+
+	if (pos < 0)
+		return;
+
+	deferred_pos[i] = 0;
+	last = deferred_heap[--deferred_heap_size];
+	if (last == i)
+		return;
+
+	/* Fill the hole with the last entry and restore heap order */
+	deferred_heap_set(pos, last);
+	deferred_sift_up(pos);
+	deferred_sift_down(deferred_pos[last] - 1);
+}
+
 int hook_call_deferred(const struct deferred_data *data, int us)
 {
 	int i = data - __deferred_funcs;
+	uint64_t until;
+	uint32_t key;
+	int wake = 0;
 
 	if (data < __deferred_funcs || data >= __deferred_funcs_end)
 		return EC_ERROR_INVAL;  /* Routine not registered */
 
 	if (us == -1) {
 		/* Cancel */
-		__deferred_until[i] = 0;
+		key = irq_lock();
+		deferred_heap_cancel(i);
+		irq_unlock(key);
 	} else {
 		/* Set alarm */
-		__deferred_until[i] = get_time().val + us;
+		until = get_time().val + us;
+
+		key = irq_lock();
+		deferred_heap_arm(i, until);
 		/*
-		 * Flag that hook_call_deferred() has been called.  If the hook
-		 * task is already active, this will allow it to go through the
-		 * loop one more time before sleeping.
+		 * Only wake the task if it is going to sleep past the new
+		 * deadline.  Otherwise it will see this routine at the root of
+		 * the heap the next time it computes how long to sleep.
 		 */
-		defer_new_call = 1;
+		wake = until < hook_next_wake;
+		irq_unlock(key);
 
 		/* Wake task so it can re-sleep for the proper time */
-		if (hook_task_started)
+		if (wake && hook_task_started)
 			task_wake(TASK_ID_HOOKS);
 	}
 
@@ -188,22 +314,38 @@ void hook_task(void *u)
 
 	while (1) {
 		uint64_t t = get_time().val;
+		uint64_t until;
+		uint32_t key;
 		int next = 0;
 		int i;
 
-		/* Handle deferred routines */
-		for (i = 0; i < DEFERRED_FUNCS_COUNT; i++) {
-			if (__deferred_until[i] && __deferred_until[i] < t) {
-				CPRINTS("hook call deferred 0x%pP",
-					__deferred_funcs[i].routine);
-				/*
-				 * Call deferred function.  Clear timer first,
-				 * so it can request itself be called later.
-				 */
-				__deferred_until[i] = 0;
-				__deferred_funcs[i].routine();
-			}
+		/* Handle deferred routines, earliest first */
+		key = irq_lock();
+		while (deferred_heap_size) {
+			i = deferred_heap[0];
+			until = __deferred_until[i];
+			if (until >= t)
+				break;
+
+			/*
+			 * Clear timer before calling the function, so it can
+			 * request itself be called later.
+			 */
+			deferred_heap_cancel(i);
+			irq_unlock(key);
+
+#ifdef CONFIG_HOOK_DEBUG
+			if (t - until > deferred_max_late[i])
+				deferred_max_late[i] = MIN(t - until,
+							   UINT32_MAX);
+#endif
+			CPRINTS("hook call deferred 0x%pP",
+				__deferred_funcs[i].routine);
+			__deferred_funcs[i].routine();
+
+			key = irq_lock();
 		}
+		irq_unlock(key);
 
 		if (t - last_tick >= HOOK_TICK_INTERVAL) {
 #ifdef CONFIG_HOOK_DEBUG
@@ -231,24 +373,24 @@ void hook_task(void *u)
 			next = last_tick + HOOK_TICK_INTERVAL - t;
 
 		/* Wake earlier if needed by a deferred routine */
-		defer_new_call = 0;
-
-		for (i = 0; i < DEFERRED_FUNCS_COUNT && next > 0; i++) {
-			if (!__deferred_until[i])
-				continue;
-
-			if (__deferred_until[i] < t)
+		key = irq_lock();
+		if (deferred_heap_size && next > 0) {
+			until = __deferred_until[deferred_heap[0]];
+			if (until < t)
 				next = 0;
-			else if (__deferred_until[i] - t < next)
-				next = __deferred_until[i] - t;
+			else if (until - t < next)
+				next = until - t;
 		}
 
 		/*
-		 * If nothing is immediately pending, and hook_call_deferred()
-		 * hasn't been called since we started calculating next, sleep
-		 * until the next event.
+		 * Publish when we plan to wake, so hook_call_deferred() only
+		 * wakes us for routines due before then.  A wake that lands
+		 * between here and task_wait_event() makes it return at once.
 		 */
-		if (next > 0 && !defer_new_call)
+		hook_next_wake = t + next;
+		irq_unlock(key);
+
+		if (next > 0)
 			task_wait_event(next);
 	}
 }
@@ -279,10 +421,27 @@ static int command_stats(int argc, char **argv)
 	print_hook_delay(SECOND, max_hook_second_delay, avg_hook_second_delay);
 
 	ccprintf("Max run time for each hook:\n");
-	for (i = 0; i < ARRAY_SIZE(hook_list); ++i)
-		ccprintf("%3d:%6d us (Avg: %5d us)\n", i,
+	for (i = 0; i < ARRAY_SIZE(hook_list); ++i) {
+		ccprintf("%3d:%6d us (Avg: %5d us)", i,
 			 (uint32_t)max_hook_run_time[i],
 			 (uint32_t)avg_hook_run_time[i]);
+		if (max_hook_routine[i])
+			ccprintf(" slowest 0x%pP:%6d us",
+				 max_hook_routine[i],
+				 (uint32_t)max_hook_routine_time[i]);
+		ccprintf("\n");
+	}
+
+	ccprintf("\nDeferred queue depth: %d (max %d)\n", deferred_heap_size,
+		 max_deferred_heap_size);
+	ccprintf("Max lateness for each deferred call:\n");
+	for (i = 0; i < DEFERRED_FUNCS_COUNT; i++) {
+		if (!deferred_max_late[i])
+			continue;
+		ccprintf("  0x%pP:%7d us%s\n", __deferred_funcs[i].routine,
+			 deferred_max_late[i],
+			 deferred_pos[i] ? " (armed)" : "");
+	}
 
 	return EC_SUCCESS;
 }
@@ -31,6 +31,10 @@
 /* Stop printing repeated host commands "+" after this count */
 #define HCDEBUG_MAX_REPEAT_COUNT 5
 
+#if defined(CONFIG_HOSTCMD_STATS) && !defined(CONFIG_HOSTCMD_HASH_SLOTS)
+#error "CONFIG_HOSTCMD_STATS requires CONFIG_HOSTCMD_HASH_SLOTS"
+#endif
+
 static struct host_cmd_handler_args *pending_args;
 
 #ifndef CONFIG_HOSTCMD_X86
@@ -362,6 +366,105 @@ host_packet_bad:
 	host_packet_respond(&args0);
 }
 
+#ifdef CONFIG_HOSTCMD_HASH_SLOTS
+BUILD_ASSERT(CONFIG_HOSTCMD_HASH_SLOTS >= 2 &&
+	     POWER_OF_TWO(CONFIG_HOSTCMD_HASH_SLOTS));
+
+#define HCMD_HASH_MASK (CONFIG_HOSTCMD_HASH_SLOTS - 1)
+
+/*
+ * Open-addressed hash table of host commands, using linear probing.  A slot
+ * with a NULL cmd is empty, and at least one slot is always left empty so a
+ * failed lookup ends.
+ */
+struct hcmd_slot {
+	const struct host_command *cmd;
+#ifdef CONFIG_HOSTCMD_STATS
+	uint16_t latency[EC_HOST_COMMAND_STATS_BUCKETS];
+#endif
+};
+
+static struct hcmd_slot hcmd_hash[CONFIG_HOSTCMD_HASH_SLOTS];
+static int hcmd_hash_count;
+
+/* Set once every command in __hcmds is in the table */
+static int hcmd_hash_ready;
+
+static unsigned int hcmd_hash_index(int command)
+{
+	/* Fibonacci hashing: keep the top bits of command * 2^32 / phi */
+	return ((uint32_t)command * 2654435769u) >>
+		(32 - __fls(CONFIG_HOSTCMD_HASH_SLOTS));
+}
+
+int host_command_hash_add(const struct host_command *cmd)
+{
+	unsigned int i = hcmd_hash_index(cmd->command);
+
+	if (hcmd_hash_count >= HCMD_HASH_MASK)
+		return EC_ERROR_OVERFLOW;
+
+	while (hcmd_hash[i].cmd)
+		i = (i + 1) & HCMD_HASH_MASK;
+
+	hcmd_hash[i].cmd = cmd;
+	hcmd_hash_count++;
+
+	return EC_SUCCESS;
+}
+
+static struct hcmd_slot *hcmd_hash_find(int command)
+{
+	unsigned int i = hcmd_hash_index(command);
+
+	while (hcmd_hash[i].cmd) {
+		if (hcmd_hash[i].cmd->command == command)
+			return &hcmd_hash[i];
+		i = (i + 1) & HCMD_HASH_MASK;
+	}
+
+	return NULL;
+}
+
+#ifndef CONFIG_ZEPHYR
+static void hcmd_hash_build(void)
+{
+	const struct host_command *cmd;
+
+	for (cmd = __hcmds; cmd < __hcmds_end; cmd++) {
+		if (host_command_hash_add(cmd) != EC_SUCCESS) {
+			/* Lookups keep searching __hcmds instead */
+			CPRINTS("HC hash table full at %d commands",
+				hcmd_hash_count);
+			return;
+		}
+	}
+
+	hcmd_hash_ready = 1;
+}
+#endif /* !CONFIG_ZEPHYR */
+#endif /* CONFIG_HOSTCMD_HASH_SLOTS */
+
+#ifdef CONFIG_HOSTCMD_STATS
+/* Bucket i counts runs under 4^(i+1) us, the last one everything longer */
+static void host_command_stats_record(int command, uint32_t us)
+{
+	struct hcmd_slot *slot;
+	int b = us ? __fls(us) / 2 : 0;
+
+	if (!hcmd_hash_ready && !IS_ENABLED(CONFIG_ZEPHYR))
+		return;
+
+	slot = hcmd_hash_find(command);
+	if (!slot)
+		return;
+
+	b = MIN(b, EC_HOST_COMMAND_STATS_BUCKETS - 1);
+	if (slot->latency[b] != UINT16_MAX)
+		slot->latency[b]++;
+}
+#endif
+
 /**
  * Find a command by command number.
  *
@@ -370,8 +473,16 @@ host_packet_bad:
  */
 static const struct host_command *find_host_command(int command)
 {
+#ifdef CONFIG_HOSTCMD_HASH_SLOTS
+	if (hcmd_hash_ready || IS_ENABLED(CONFIG_ZEPHYR)) {
+		const struct hcmd_slot *slot = hcmd_hash_find(command);
+
+		return slot ? slot->cmd : NULL;
+	}
+#endif
+
 	if (IS_ENABLED(CONFIG_ZEPHYR)) {
-		/* TODO(b/172678200): shim host commands for Zephyr */
+		/* Zephyr registers host commands in the hash table only */
 		return NULL;
 	} else if (IS_ENABLED(CONFIG_HOSTCMD_SECTION_SORTED)) {
 		const struct host_command *l, *r, *m;
@@ -423,6 +534,10 @@ static void host_command_init(void)
 #ifdef CONFIG_SUPPRESSED_HOST_COMMANDS
 	suppressed_cmd_deadline.val = get_time().val + SUPPRESSED_CMD_INTERVAL;
 #endif
+
+#if defined(CONFIG_HOSTCMD_HASH_SLOTS) && !defined(CONFIG_ZEPHYR)
+	hcmd_hash_build();
+#endif
 }
 
 void host_command_task(void *u)
@@ -708,6 +823,10 @@ uint16_t host_command_process(struct host_cmd_handler_args *args)
 	} else
 #endif
 	{
+#ifdef CONFIG_HOSTCMD_STATS
+		uint32_t t0 = get_time().le.lo;
+#endif
+
 		cmd = find_host_command(args->command);
 		if (!cmd)
 			rv = EC_RES_INVALID_COMMAND;
@@ -715,6 +834,12 @@ uint16_t host_command_process(struct host_cmd_handler_args *args)
 			rv = EC_RES_INVALID_VERSION;
 		else
 			rv = cmd->handler(args);
+
+#ifdef CONFIG_HOSTCMD_STATS
+		if (cmd)
+			host_command_stats_record(args->command,
+						  get_time().le.lo - t0);
+#endif
 	}
 
 	if (rv != EC_RES_SUCCESS)
@@ -796,6 +921,58 @@ DECLARE_HOST_COMMAND(EC_CMD_GET_FEATURES,
 		     host_command_get_features,
 		     EC_VER_MASK(0));
 
+#ifdef CONFIG_HOSTCMD_STATS
+static enum ec_status
+host_command_stats(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_host_command_stats *p = args->params;
+	struct ec_response_host_command_stats *r = args->response;
+	const int max_entries = (args->response_max - sizeof(*r)) /
+				sizeof(r->entries[0]);
+	int i, j;
+
+	if (p->flags & EC_HOST_COMMAND_STATS_CLEAR) {
+		for (i = 0; i < CONFIG_HOSTCMD_HASH_SLOTS; i++)
+			memset(hcmd_hash[i].latency, 0,
+			       sizeof(hcmd_hash[i].latency));
+		return EC_RES_SUCCESS;
+	}
+
+	r->num_cmds = 0;
+	r->num_entries = 0;
+	for (i = 0; i < CONFIG_HOSTCMD_HASH_SLOTS; i++) {
+		const struct hcmd_slot *slot = &hcmd_hash[i];
+		struct ec_host_command_stats_entry *e;
+
+		if (!slot->cmd)
+			continue;
+
+		for (j = 0; j < EC_HOST_COMMAND_STATS_BUCKETS; j++)
+			if (slot->latency[j])
+				break;
+		if (j == EC_HOST_COMMAND_STATS_BUCKETS)
+			continue;
+
+		if (r->num_cmds++ < p->index ||
+		    r->num_entries >= max_entries)
+			continue;
+
+		e = &r->entries[r->num_entries++];
+		e->command = slot->cmd->command;
+		for (j = 0; j < EC_HOST_COMMAND_STATS_BUCKETS; j++)
+			e->latency[j] = slot->latency[j];
+	}
+
+	args->response_size = sizeof(*r) +
+			      r->num_entries * sizeof(r->entries[0]);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_HOST_COMMAND_STATS,
+		     host_command_stats,
+		     EC_VER_MASK(0));
+#endif /* CONFIG_HOSTCMD_STATS */
+
 
 /*****************************************************************************/
 /* Console commands */
@@ -12,11 +12,13 @@
 #include "crc8.h"
 #include "host_command.h"
 #include "gpio.h"
+#include "hooks.h"
 #include "i2c.h"
 #include "i2c_bitbang.h"
 #include "i2c_private.h"
 #include "system.h"
 #include "task.h"
+#include "timer.h"
 #include "usb_pd.h"
 #include "usb_pd_tcpm.h"
 #include "util.h"
@@ -114,10 +116,14 @@ __maybe_unused static int chip_i2c_xfer_with_notify(
 	int ret;
 	uint16_t no_pec_af = addr_flags;
 	const struct i2c_port_t *i2c_port = get_i2c_port(port);
+	uint32_t start = 0;
 
 	if (IS_ENABLED(CONFIG_I2C_XFER_BOARD_CALLBACK))
 		i2c_start_xfer_notify(port, addr_flags);
 
+	if (IS_ENABLED(CONFIG_I2C_DEBUG))
+		start = get_time().le.lo;
+
 	if (IS_ENABLED(CONFIG_SMBUS_PEC))
 		/*
 		 * Since we've done PEC processing here,
@@ -135,6 +141,8 @@ __maybe_unused static int chip_i2c_xfer_with_notify(
 		i2c_end_xfer_notify(port, addr_flags);
 
 	if (IS_ENABLED(CONFIG_I2C_DEBUG)) {
+		i2c_trace_stats_xfer(port, out_size + in_size,
+				     get_time().le.lo - start);
 		i2c_trace_notify(port, addr_flags, out, out_size,
 				 in, in_size);
 	}
@@ -270,6 +278,144 @@ void i2c_lock(int port, int lock)
 	}
 }
 
+#ifdef CONFIG_I2C_XFER_ASYNC
+#define I2C_ASYNC_PORTS (I2C_PORT_COUNT + I2C_BITBANG_PORT_COUNT)
+
+/* Requests waiting to run on each port, oldest first */
+static struct i2c_async_req *async_head[I2C_ASYNC_PORTS];
+static struct i2c_async_req *async_tail[I2C_ASYNC_PORTS];
+static int async_depth[I2C_ASYNC_PORTS];
+
+static struct i2c_async_req *i2c_async_pop(int port)
+{
+	struct i2c_async_req *req;
+	uint32_t irq_lock_key = irq_lock();
+
+	req = async_head[port];
+	if (req) {
+		async_head[port] = req->next;
+		if (!async_head[port])
+			async_tail[port] = NULL;
+		async_depth[port]--;
+	}
+
+	irq_unlock(irq_lock_key);
+	return req;
+}
+
+static void i2c_async_run(int port, struct i2c_async_req *req)
+{
+	int i;
+
+	if (IS_ENABLED(CONFIG_I2C_DEBUG))
+		i2c_trace_stats_async(port,
+				      get_time().le.lo - req->queued_at,
+				      req->depth);
+
+	req->rv = EC_SUCCESS;
+	for (i = 0; i < req->count && req->rv == EC_SUCCESS; i++) {
+		const struct i2c_async_op *op = &req->ops[i];
+
+		req->rv = i2c_xfer_unlocked(port, op->addr_flags,
+					    op->out, op->out_size,
+					    op->in, op->in_size,
+					    I2C_XFER_SINGLE);
+	}
+}
+
+static void i2c_async_worker(void)
+{
+	int port;
+
+	for (port = 0; port < I2C_ASYNC_PORTS; port++) {
+		while (async_head[port]) {
+			struct i2c_async_req *done = NULL;
+			struct i2c_async_req *done_tail = NULL;
+			struct i2c_async_req *req;
+
+			/*
+			 * Run everything queued on the port back-to-back, then
+			 * drop the lock before completing, so that completions
+			 * can use the port again.
+			 */
+			i2c_lock(port, 1);
+			while ((req = i2c_async_pop(port)) != NULL) {
+				i2c_async_run(port, req);
+				/* Complete in submission order */
+				req->next = NULL;
+				if (done_tail)
+					done_tail->next = req;
+				else
+					done = req;
+				done_tail = req;
+			}
+			i2c_lock(port, 0);
+
+			while (done) {
+				void (*cb)(struct i2c_async_req *req);
+				task_id_t task;
+				uint32_t event;
+
+				req = done;
+				done = req->next;
+				/*
+				 * Once busy is clear the owner may reuse the
+				 * request, so latch everything we still need.
+				 */
+				cb = req->done;
+				task = req->task;
+				event = req->event;
+				req->busy = 0;
+				if (cb)
+					cb(req);
+				if (event)
+					task_set_event(task, event, 0);
+			}
+		}
+	}
+}
+DECLARE_DEFERRED(i2c_async_worker);
+
+int i2c_xfer_submit(struct i2c_async_req *req)
+{
+	uint32_t irq_lock_key;
+	int port = req->port;
+
+	if (port < 0 || port >= I2C_ASYNC_PORTS || !get_i2c_port(port) ||
+	    req->count <= 0)
+		return EC_ERROR_INVAL;
+
+	irq_lock_key = irq_lock();
+
+	if (req->busy) {
+		irq_unlock(irq_lock_key);
+		return EC_ERROR_BUSY;
+	}
+
+	req->busy = 1;
+	req->next = NULL;
+	req->queued_at = get_time().le.lo;
+	req->depth = MIN(async_depth[port], UINT8_MAX);
+	async_depth[port]++;
+	if (async_tail[port])
+		async_tail[port]->next = req;
+	else
+		async_head[port] = req;
+	async_tail[port] = req;
+
+	irq_unlock(irq_lock_key);
+
+	hook_call_deferred(&i2c_async_worker_data, 0);
+
+	return EC_SUCCESS;
+}
+
+int i2c_xfer_busy(const struct i2c_async_req *req)
+{
+	return req->busy;
+}
+#endif /* CONFIG_I2C_XFER_ASYNC */
+
 void i2c_prepare_sysjump(void)
 {
 	int i;
@@ -8,6 +8,7 @@
 #include "i2c.h"
 #include "stddef.h"
 #include "stdbool.h"
+#include "timer.h"
 #include "util.h"
 
 #define CPUTS(outstr) cputs(CC_I2C, outstr)
@@ -23,6 +24,52 @@ struct i2c_trace_range {
 
 static struct i2c_trace_range trace_entries[8];
 
+#ifndef CONFIG_I2C_BITBANG
+#define I2C_BITBANG_PORT_COUNT 0
+#endif
+
+struct i2c_port_stats {
+	uint32_t xfers;
+	uint32_t bytes;
+	uint32_t busy_us;
+	uint32_t async_reqs;
+	uint32_t async_wait_us;
+	uint32_t async_wait_max_us;
+	uint32_t async_depth_max;
+};
+
+static struct i2c_port_stats port_stats[I2C_PORT_COUNT +
+					I2C_BITBANG_PORT_COUNT];
+/* When port_stats was last cleared */
+static timestamp_t stats_since;
+
+void i2c_trace_stats_xfer(int port, size_t bytes, uint32_t us)
+{
+	struct i2c_port_stats *stats;
+
+	if (port < 0 || port >= ARRAY_SIZE(port_stats))
+		return;
+
+	stats = &port_stats[port];
+	stats->xfers++;
+	stats->bytes += bytes;
+	stats->busy_us += us;
+}
+
+void i2c_trace_stats_async(int port, uint32_t wait_us, int depth)
+{
+	struct i2c_port_stats *stats;
+
+	if (port < 0 || port >= ARRAY_SIZE(port_stats))
+		return;
+
+	stats = &port_stats[port];
+	stats->async_reqs++;
+	stats->async_wait_us += wait_us;
+	stats->async_wait_max_us = MAX(stats->async_wait_max_us, wait_us);
+	stats->async_depth_max = MAX(stats->async_depth_max, depth);
+}
+
 void i2c_trace_notify(int port, uint16_t slave_addr_flags,
 		      const uint8_t *out_data, size_t out_size,
 		      const uint8_t *in_data, size_t in_size)
@@ -80,6 +127,32 @@ static int command_i2ctrace_list(void)
 	return EC_SUCCESS;
 }
 
+static int command_i2ctrace_stats(void)
+{
+	size_t i;
+	uint32_t elapsed_us = get_time().val - stats_since.val;
+
+	ccprintf("port xfers    bytes    busy  async  wait avg/max us  depth\n");
+
+	for (i = 0; i < ARRAY_SIZE(port_stats); i++) {
+		const struct i2c_port_stats *stats = &port_stats[i];
+
+		if (!stats->xfers && !stats->async_reqs)
+			continue;
+
+		ccprintf("%-4zd %-8u %-8u %3u%%  %-6u %u/%u  %u\n",
+			 i, stats->xfers, stats->bytes,
+			 elapsed_us ? (uint32_t)(stats->busy_us * 100ULL /
+						 elapsed_us) : 0,
+			 stats->async_reqs,
+			 stats->async_reqs ?
+				stats->async_wait_us / stats->async_reqs : 0,
+			 stats->async_wait_max_us, stats->async_depth_max);
+	}
+
+	return EC_SUCCESS;
+}
+
 static int command_i2ctrace_disable(size_t id)
 {
 	if (id >= ARRAY_SIZE(trace_entries))
@@ -173,6 +246,17 @@ static int command_i2ctrace(int argc, char **argv)
 	if (!strcasecmp(argv[1], "list") && argc == 2)
 		return command_i2ctrace_list();
 
+	if (!strcasecmp(argv[1], "stats")) {
+		if (argc == 2)
+			return command_i2ctrace_stats();
+		if (argc == 3 && !strcasecmp(argv[2], "reset")) {
+			memset(port_stats, 0, sizeof(port_stats));
+			stats_since = get_time();
+			return EC_SUCCESS;
+		}
+		return EC_ERROR_PARAM2;
+	}
+
 	if (argc < 3)
 		return EC_ERROR_PARAM_COUNT;
 
@@ -206,6 +290,7 @@ static int command_i2ctrace(int argc, char **argv)
 }
 DECLARE_CONSOLE_COMMAND(i2ctrace,
 			command_i2ctrace,
-			"[list | disable <id> | enable <port> <address> | "
+			"[list | stats [reset] | disable <id> | "
+			"enable <port> <address> | "
 			"enable <port> <address-low> <address-high>]",
 			"Trace I2C transactions");
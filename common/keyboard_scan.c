@@ -133,6 +133,27 @@ static volatile int kbd_polls;
 /* If true, we'll force a keyboard poll */
 static volatile int force_poll;
 
+/* Set by the last scan if nothing changed, debounced or ghosted */
+static int scan_steady;
+
+/* Scan activity and latency, shown by ksstate */
+struct kb_scan_stats {
+	/* Scans done */
+	uint32_t scans;
+	/* Time spent scanning, less time slept waiting for columns to settle */
+	uint32_t busy_us;
+	/* Time spent in polling mode with keys held, and scanning in it */
+	uint32_t held_us;
+	uint32_t held_busy_us;
+	/* Time from the scan before a key edge to the edge being reported */
+	uint32_t latency_us;
+	uint32_t latency_max_us;
+};
+static struct kb_scan_stats __bss_slow scan_stats;
+
+/* Start of the first scan in this polling session */
+static uint32_t __bss_slow poll_start_time;
+
 static int keyboard_scan_is_enabled(void)
 {
 	/* NOTE: this is just an instantaneous glimpse of the variable. */
@@ -234,11 +255,81 @@ static void simulate_key(int row, int col, int pressed)
 	ensure_keyboard_scanned(kbd_polls);
 }
 
+BUILD_ASSERT(KEYBOARD_COLS_MAX <= 32);
+BUILD_ASSERT(KEYBOARD_ROWS <= 8);
+
+/**
+ * Transpose a keyboard state into the set of columns pressed in each row.
+ *
+ * @param state		Keyboard state.
+ * @param row_cols	Destination for column masks (KEYBOARD_ROWS long).
+ */
+static void get_row_cols(const uint8_t *state, uint32_t *row_cols)
+{
+	int c;
+
+	memset(row_cols, 0, KEYBOARD_ROWS * sizeof(*row_cols));
+
+	for (c = 0; c < keyboard_cols; c++) {
+		uint32_t rows = state[c];
+
+		while (rows)
+			row_cols[get_next_bit(&rows)] |= BIT(c);
+	}
+}
+
+/**
+ * Merge columns whose state changed part way through a scan.
+ *
+ * If two columns share at least one key but their states are different, maybe
+ * the state changed between two keyboard_raw_read_rows()s.  If this happened,
+ * update both columns to the union of them.  Columns are merged a whole row at
+ * a time, and the merge repeats until the newly added bits don't introduce any
+ * more inconsistency.
+ *
+ * @param state		Keyboard state to fix up.
+ */
+static void merge_transitional_ghosts(uint8_t *state)
+{
+	uint32_t row_cols[KEYBOARD_ROWS];
+	int changed;
+	int r;
+
+	do {
+		changed = 0;
+		get_row_cols(state, row_cols);
+
+		for (r = 0; r < KEYBOARD_ROWS; r++) {
+			uint32_t cols = row_cols[r];
+			uint8_t merged = 0;
+
+			/* Nothing to merge unless 2 columns share the row */
+			if (!(cols & (cols - 1)))
+				continue;
+
+			while (cols)
+				merged |= state[get_next_bit(&cols)];
+
+			cols = row_cols[r];
+			while (cols) {
+				int c = get_next_bit(&cols);
+
+				if (state[c] != merged) {
+					state[c] = merged;
+					changed = 1;
+				}
+			}
+		}
+	} while (changed);
+}
+
 /**
  * Read the raw keyboard matrix state.
  *
  * Used in pre-init, so must not make task-switching-dependent calls; udelay()
- * is ok because it's a spin-loop.
+ * is ok because it's a spin-loop.  With CONFIG_KEYBOARD_SCAN_SLEEP_SETTLE the
+ * task sleeps while each column settles, which usleep() turns back into a
+ * udelay() before tasks have started.
  *
  * @param state		Destination for new state (must be KEYBOARD_COLS_MAX
  *			long).
@@ -266,7 +357,11 @@ static int read_matrix(uint8_t *state)
 
 		/* Select column, then wait a bit for it to settle */
 		keyboard_raw_drive_column(c);
-		udelay(keyscan_config.output_settle_us);
+		if (IS_ENABLED(CONFIG_KEYBOARD_SCAN_SLEEP_SETTLE) &&
+		    keyscan_config.output_settle_us)
+			usleep(keyscan_config.output_settle_us);
+		else
+			udelay(keyscan_config.output_settle_us);
 
 		/* Read the row state */
 		state[c] = keyboard_raw_read_rows();
@@ -277,28 +372,7 @@ static int read_matrix(uint8_t *state)
 	}
 
 	/* 2. Detect transitional ghost */
-	for (c = 0; c < keyboard_cols; c++) {
-		int c2;
-
-		for (c2 = 0; c2 < c; c2++) {
-			/*
-			 * If two columns shares at least one key but their
-			 * states are different, maybe the state changed between
-			 * two "keyboard_raw_read_rows"s. If this happened,
-			 * update both columns to the union of them.
-			 *
-			 * Note that in theory we need to rescan from col 0 if
-			 * anything is updated, to make sure the newly added
-			 * bits does not introduce more inconsistency.
-			 * Let's ignore this rare case for now.
-			 */
-			if ((state[c] & state[c2]) && (state[c] != state[c2])) {
-				uint8_t merged = state[c] | state[c2];
-
-				state[c] = state[c2] = merged;
-			}
-		}
-	}
+	merge_transitional_ghosts(state);
 
 	/* 3. Fix result */
 	for (c = 0; c < keyboard_cols; c++) {
@@ -475,21 +549,24 @@ static int check_runtime_keys(const uint8_t *state)
  */
 static int has_ghosting(const uint8_t *state)
 {
-	int c, c2;
+	uint32_t row_cols[KEYBOARD_ROWS];
+	int r, r2;
 
-	for (c = 0; c < keyboard_cols; c++) {
-		if (!state[c])
+	get_row_cols(state, row_cols);
+
+	for (r = 0; r < KEYBOARD_ROWS; r++) {
+		if (!(row_cols[r] & (row_cols[r] - 1)))
 			continue;
 
-		for (c2 = c + 1; c2 < keyboard_cols; c2++) {
+		for (r2 = r + 1; r2 < KEYBOARD_ROWS; r2++) {
 			/*
-			 * A little bit of cleverness here.  Ghosting happens
-			 * if 2 columns share at least 2 keys.  So we OR the
-			 * columns together and then see if more than one bit
-			 * is set.  x&(x-1) is non-zero only if x has more than
-			 * one bit set.
+			 * Ghosting happens if 2 columns share at least 2 keys,
+			 * which is the same as 2 rows sharing at least 2
+			 * columns.  There are fewer rows than columns, so
+			 * compare those.  x&(x-1) is non-zero only if x has
+			 * more than one bit set.
 			 */
-			uint8_t common = state[c] & state[c2];
+			uint32_t common = row_cols[r] & row_cols[r2];
 
 			if (common & (common - 1))
 				return 1;
@@ -521,6 +598,7 @@ static int check_keys_changed(uint8_t *state)
 
 	/* Read the raw key state */
 	any_pressed = read_matrix(new_state);
+	scan_steady = 0;
 
 	/* Ignore if so many keys are pressed that we're ghosting. */
 	if (has_ghosting(new_state))
@@ -572,6 +650,18 @@ static int check_keys_changed(uint8_t *state)
 	}
 
 	if (any_change) {
+		uint32_t prev = scan_time[(scan_time_index + SCAN_TIME_COUNT - 1) %
+					  SCAN_TIME_COUNT];
+
+		/*
+		 * The edge happened some time after the previous scan, or
+		 * after polling started if this is the first scan.
+		 */
+		if (tnow - prev > tnow - poll_start_time)
+			prev = poll_start_time;
+		scan_stats.latency_us = get_time().le.lo - prev;
+		scan_stats.latency_max_us = MAX(scan_stats.latency_max_us,
+						scan_stats.latency_us);
 
 #ifdef CONFIG_KEYBOARD_SUPPRESS_NOISE
 		/* Suppress keyboard noise */
@@ -602,6 +692,10 @@ static int check_keys_changed(uint8_t *state)
 #ifdef CONFIG_KEYBOARD_PROTOCOL_MKBP
 		keyboard_fifo_add(state);
 #endif
+	} else {
+		for (c = 0; c < keyboard_cols && !debouncing[c]; c++)
+			;
+		scan_steady = (c == keyboard_cols);
 	}
 
 	kbd_polls++;
@@ -767,6 +861,7 @@ void keyboard_scan_task(void *u)
 {
 	timestamp_t poll_deadline, start;
 	int wait_time;
+	int scan_period;
 	uint32_t local_disable_scanning = 0;
 
 	print_state(debounced_state, "init state");
@@ -834,21 +929,47 @@ void keyboard_scan_task(void *u)
 		keyboard_raw_enable_interrupt(0);
 		keyboard_raw_drive_column(KEYBOARD_COLUMN_NONE);
 
+		scan_period = keyscan_config.scan_period_us;
+		poll_start_time = get_time().le.lo;
+
 		/* Busy polling keyboard state. */
 		while (keyboard_scan_is_enabled()) {
+			int held;
+			uint32_t scan_us, busy_us;
+
 			start = get_time();
 
 			/* Check for keys down */
-			if (check_keys_changed(debounced_state)) {
+			held = check_keys_changed(debounced_state);
+			if (held) {
 				poll_deadline.val = start.val
 					+ keyscan_config.poll_timeout_us;
 			} else if (timestamp_expired(poll_deadline, &start)) {
 				break;
 			}
 
+			scan_us = get_time().val - start.val;
+			busy_us = scan_us;
+			if (IS_ENABLED(CONFIG_KEYBOARD_SCAN_SLEEP_SETTLE))
+				busy_us -= MIN(busy_us, keyboard_cols *
+					       keyscan_config.output_settle_us);
+			scan_stats.scans++;
+			scan_stats.busy_us += busy_us;
+
+			/*
+			 * Back off the scan rate while keys are only being
+			 * held, and go back to full speed on the next edge.
+			 */
+			if (held && scan_steady && !force_poll)
+				scan_period = MIN(scan_period * 2,
+					MAX(keyscan_config.held_scan_period_us,
+					    keyscan_config.scan_period_us));
+			else
+				scan_period = keyscan_config.scan_period_us;
+			force_poll = 0;
+
 			/* Delay between scans */
-			wait_time = keyscan_config.scan_period_us -
-				(get_time().val - start.val);
+			wait_time = scan_period - scan_us;
 
 			if (wait_time < keyscan_config.min_post_scan_delay_us)
 				wait_time =
@@ -858,6 +979,11 @@ void keyboard_scan_task(void *u)
 				wait_time = post_scan_clock_us;
 
 			usleep(wait_time);
+
+			if (held) {
+				scan_stats.held_us += get_time().val - start.val;
+				scan_stats.held_busy_us += busy_us;
+			}
 		}
 	}
 }
@@ -1031,6 +1157,8 @@ static int command_ksstate(int argc, char **argv)
 		if (!strcasecmp(argv[1], "force")) {
 			print_state_changes = 1;
 			keyboard_scan_enable(1, -1);
+		} else if (!strcasecmp(argv[1], "reset")) {
+			memset(&scan_stats, 0, sizeof(scan_stats));
 		} else if (!parse_bool(argv[1], &print_state_changes)) {
 			return EC_ERROR_PARAM1;
 		}
@@ -1043,10 +1171,18 @@ static int command_ksstate(int argc, char **argv)
 		 disable_scanning_mask);
 	ccprintf("Keyboard scan state printing %s\n",
 		 print_state_changes ? "on" : "off");
+	ccprintf("Scans: %u, %u us busy\n",
+		 scan_stats.scans, scan_stats.busy_us);
+	ccprintf("Keys held: %u ms, %u us busy per second\n",
+		 scan_stats.held_us / MSEC,
+		 scan_stats.held_us ? (uint32_t)((uint64_t)
+			scan_stats.held_busy_us * SECOND / scan_stats.held_us) : 0);
+	ccprintf("Key latency: %u us, max %u us\n",
+		 scan_stats.latency_us, scan_stats.latency_max_us);
 	return EC_SUCCESS;
 }
 DECLARE_CONSOLE_COMMAND(ksstate, command_ksstate,
-			"ksstate [on | off | force]",
+			"ksstate [on | off | force | reset]",
 			"Show or toggle printing keyboard scan state");
 
 static int command_keyboard_press(int argc, char **argv)
@@ -1086,6 +1222,7 @@ static int command_keyboard_press(int argc, char **argv)
 
 			simulate_key(r, c, p);
 		}
+		ccprintf("Latency: %u us\n", scan_stats.latency_us);
 	}
 
 	return EC_SUCCESS;
@@ -326,16 +326,26 @@ int tcpci_i2c_xfer(int port, uint16_t slave_addr_flags,
 		memcpy(in, rx_buffer, in_size);
 		rx_pos += in_size;
 	} else if (out_size == 1) {
-		if (in_size != reg->size) {
-			ccprints("ERROR: %s in_size %d != %d", reg->name,
-				 in_size, reg->size);
-			return EC_ERROR_UNKNOWN;
-		}
-		if (reg->size == 1)
-			in[0] = reg->value;
-		else if (reg->size == 2) {
-			in[0] = reg->value;
-			in[1] = reg->value >> 8;
+		const struct tcpci_reg *end = tcpci_regs +
+					      ARRAY_SIZE(tcpci_regs);
+		int i = 0;
+
+		/* Block reads carry on into the following registers */
+		while (i < in_size) {
+			if (reg >= end || reg->size == 0 ||
+			    i + reg->size > in_size) {
+				ccprints("ERROR: %s in_size %d",
+					 tcpci_regs[*out].name, in_size);
+				return EC_ERROR_UNKNOWN;
+			}
+			if (reg->size == 1)
+				in[i] = reg->value;
+			else if (reg->size == 2) {
+				in[i] = reg->value;
+				in[i + 1] = reg->value >> 8;
+			}
+			i += reg->size;
+			reg += reg->size;
 		}
 	} else {
 		uint16_t value = 0;
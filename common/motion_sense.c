@@ -75,6 +75,17 @@ STATIC_IF(CONFIG_MOTION_FILL_LPC_SENSE_DATA) void update_sense_data(
 /* Flags to control whether to send an ODR change event for a sensor */
 static uint32_t odr_event_required;
 
+/*
+ * How late each sensor was served by motion_sense_task, compared to when its
+ * work became due: its next collection time for forced mode reads, the task
+ * wake up for interrupts, ODR changes and flushes.
+ */
+static struct {
+	uint32_t count;
+	uint32_t total_us;
+	uint32_t max_us;
+} sensor_jitter[MAX_MOTION_SENSORS];
+
 /* Whether or not the FIFO interrupt should be enabled (set from the AP). */
 __maybe_unused static int fifo_int_enabled;
 
@@ -752,6 +763,68 @@ static int motion_sense_process(struct motion_sensor_t *sensor,
 	return ret;
 }
 
+/**
+ * Check whether a sensor has pending work besides its forced mode reads.
+ *
+ * @param sensor Pointer to the sensor.
+ * @param event Events the motion sense task was woken up with.
+ * @return Non zero if the interrupt, ODR change or flush requires the sensor
+ *	   to be processed.
+ */
+static int motion_sense_has_event(const struct motion_sensor_t *sensor,
+				  uint32_t event)
+{
+	if ((event & TASK_EVENT_MOTION_ODR_CHANGE) &&
+	    (odr_event_required & BIT(sensor - motion_sensors)))
+		return 1;
+	if (IS_ENABLED(CONFIG_ACCEL_INTERRUPTS) &&
+	    (event & TASK_EVENT_MOTION_INTERRUPT_MASK) &&
+	    sensor->drv->irq_handler != NULL)
+		return 1;
+	if (IS_ENABLED(CONFIG_ACCEL_FIFO) &&
+	    (event & TASK_EVENT_MOTION_FLUSH_PENDING) &&
+	    sensor->flush_pending)
+		return 1;
+	return 0;
+}
+
+/**
+ * Find the forced mode sensor with the earliest collection time.
+ *
+ * @param due Mask of sensors to choose from, must not be 0.
+ * @return Index of the sensor.
+ */
+static int motion_sense_next_due(uint32_t due)
+{
+	int i, next = __fls(due);
+
+	for (i = next - 1; i >= 0; i--) {
+		if ((due & BIT(i)) &&
+		    !time_after(motion_sensors[i].next_collection,
+				motion_sensors[next].next_collection))
+			next = i;
+	}
+	return next;
+}
+
+/**
+ * Account for the time a sensor waited before being processed.
+ *
+ * @param sensor_num Index of the sensor.
+ * @param due Time the work became due.
+ */
+static void motion_sense_record_jitter(int sensor_num, uint32_t due)
+{
+	int32_t late = time_until(due, __hw_clock_source_read());
+
+	/* Forced mode reads may be served up to motion_min_interval early. */
+	if (late < 0)
+		late = 0;
+	sensor_jitter[sensor_num].count++;
+	sensor_jitter[sensor_num].total_us += late;
+	sensor_jitter[sensor_num].max_us =
+		MAX(sensor_jitter[sensor_num].max_us, late);
+}
 
 #ifdef CONFIG_GESTURE_DETECTION
 static void check_and_queue_gestures(uint32_t *event)
@@ -851,11 +924,12 @@ static void check_and_queue_gestures(uint32_t *event)
  */
 void motion_sense_task(void *u)
 {
-	int i, ret, sample_id = 0;
+	int i, sample_id = 0;
 	timestamp_t ts_begin_task, ts_end_task;
 	int32_t time_diff;
 	uint32_t event = 0;
 	uint16_t ready_status = 0;
+	uint32_t due;
 	struct motion_sensor_t *sensor;
 	uint8_t *lpc_status;
 
@@ -873,23 +947,46 @@ void motion_sense_task(void *u)
 
 	while (1) {
 		ts_begin_task = get_time();
+		due = 0;
+		/*
+		 * Serve interrupts, ODR changes and flushes first, so they do
+		 * not wait behind forced mode reads on a slow bus. Sensors
+		 * with nothing to do are not processed.
+		 */
 		for (i = 0; i < motion_sensor_count; ++i) {
-
 			sensor = &motion_sensors[i];
 
 			/* if the sensor is active in the current power state */
-			if (SENSOR_ACTIVE(sensor)) {
-				if (sensor->state != SENSOR_INITIALIZED) {
-					continue;
-				}
+			if (!SENSOR_ACTIVE(sensor) ||
+			    sensor->state != SENSOR_INITIALIZED)
+				continue;
 
-				ret = motion_sense_process(sensor, &event,
-						&ts_begin_task);
-				if (ret != EC_SUCCESS)
-					continue;
+			if (motion_sense_has_event(sensor, event)) {
+				motion_sense_record_jitter(
+					i, ts_begin_task.le.lo);
+				if (motion_sense_process(sensor, &event,
+							 &ts_begin_task) ==
+				    EC_SUCCESS)
+					ready_status |= BIT(i);
+			} else if (!motion_sensor_in_forced_mode(sensor)) {
+				/* Nothing new, its last data is still valid */
 				ready_status |= BIT(i);
+			} else if (motion_sensor_time_to_read(&ts_begin_task,
+							      sensor)) {
+				due |= BIT(i);
 			}
 		}
+		/* Then read the forced mode sensors, earliest deadline first. */
+		while (due) {
+			i = motion_sense_next_due(due);
+			due &= ~BIT(i);
+			sensor = &motion_sensors[i];
+
+			motion_sense_record_jitter(i, sensor->next_collection);
+			if (motion_sense_process(sensor, &event,
+						 &ts_begin_task) == EC_SUCCESS)
+				ready_status |= BIT(i);
+		}
 		if (IS_ENABLED(CONFIG_GESTURE_DETECTION))
 			check_and_queue_gestures(&event);
 		if (IS_ENABLED(CONFIG_LID_ANGLE)) {
@@ -1775,6 +1872,22 @@ static int command_display_accel_info(int argc, char **argv)
 				~ROUND_UP_FLAG,
 				motion_sensors[i].config[j].ec_rate);
 		}
+		if (IS_ENABLED(CONFIG_ACCEL_FIFO)) {
+			const struct motion_sense_fifo_read_stats *st =
+				motion_sense_fifo_get_read_stats(i);
+
+			if (st->reads)
+				ccprintf("fifo reads: %u, %u bytes in %u xfers, "
+					 "avg %uus, max %uus\n",
+					 st->reads, st->bytes, st->xfers,
+					 st->total_us / st->reads, st->max_us);
+		}
+		if (sensor_jitter[i].count)
+			ccprintf("scheduled: %u, late avg %uus, max %uus\n",
+				 sensor_jitter[i].count,
+				 sensor_jitter[i].total_us /
+				 sensor_jitter[i].count,
+				 sensor_jitter[i].max_us);
 	}
 
 	/* First argument is on/off whether to display accel data. */
@@ -25,8 +25,9 @@
  *	staged.
  * @sample_count: The total number of sensor readings per sensor that are
  *	currently staged.
- * @requires_spreading: Flag used to shortcut the commit process. This should be
- *	true iff at least one of sample_count[] > 1
+ * @requires_spreading: Number of sensors with more than one staged sample.
+ *	Used to shortcut the commit process: spreading is only needed when
+ *	this is non zero.
  */
 struct fifo_staged {
 	uint32_t read_ts;
@@ -67,6 +68,20 @@ static uint32_t next_timestamp_initialized;
 /** Need to wake up the AP. */
 static int wake_up_needed;
 
+/**
+ * Decimation applied to new samples while the AP is not keeping up, as a
+ * power of 2: only 1 sample in (1 << decimation) of each sensor is staged.
+ */
+static uint8_t decimation;
+/** Set once decimation has been raised in the current staging cycle. */
+static uint8_t decimation_raised;
+/** Per-sensor sample counter used to pick the samples kept by decimation. */
+static uint8_t decimation_count[MAX_MOTION_SENSORS];
+#define FIFO_MAX_DECIMATION 3
+
+/** Hardware FIFO read statistics, reported by accelinfo. */
+static struct motion_sense_fifo_read_stats read_stats[MAX_MOTION_SENSORS];
+
 /**
  * Check whether or not a give sensor data entry is a timestamp or not.
  *
@@ -162,20 +177,13 @@ static void fifo_pop(void)
 		return;
 
 	/*
-	 * Decrement sample count, if the count was 2 before, we might not need
-	 * to spread anymore. Loop through and check.
+	 * Decrement sample count, if the count was 2 before, this sensor does
+	 * not need spreading anymore.
 	 */
-	if (--fifo_staged.sample_count[head->sensor_num] < 2) {
-		int i;
-
-		fifo_staged.requires_spreading = 0;
-		for (i = 0; i < MAX_MOTION_SENSORS; i++) {
-			if (fifo_staged.sample_count[i] > 1) {
-				fifo_staged.requires_spreading = 1;
-				break;
-			}
-		}
-	}
+	if (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS) &&
+	    fifo_staged.sample_count[head->sensor_num] &&
+	    --fifo_staged.sample_count[head->sensor_num] == 1)
+		fifo_staged.requires_spreading--;
 }
 
 /**
@@ -187,6 +195,19 @@ static void fifo_ensure_space(void)
 	if (queue_space(&fifo) > fifo_staged.count)
 		return;
 
+	/*
+	 * The AP is not reading fast enough: with decimation enabled, slow
+	 * down the incoming samples instead of only dropping the oldest ones.
+	 * Only raise the decimation once per staging cycle, one hardware FIFO
+	 * read can overflow many times.
+	 */
+	if (IS_ENABLED(CONFIG_ACCEL_FIFO_DECIMATE) && !decimation_raised &&
+	    decimation < FIFO_MAX_DECIMATION) {
+		decimation++;
+		decimation_raised = 1;
+		CPRINTS("FIFO overflow, decimation 1/%d", 1 << decimation);
+	}
+
 	/*
 	 * Pop at least 1 spot, but if all the following conditions are met we
 	 * will continue to pop:
@@ -218,15 +239,43 @@ static inline bool is_new_timestamp(uint8_t sensor_num)
 	       !(next_timestamp_initialized & BIT(sensor_num));
 }
 
+/**
+ * Check whether a new sample must be dropped because of decimation.
+ *
+ * WARNING: This function MUST be called from within a locked context of
+ * g_sensor_mutex.
+ *
+ * @param sensor_num The sensor index of the sample.
+ * @return True if the sample must be dropped.
+ */
+static inline bool fifo_decimate(uint8_t sensor_num)
+{
+	if (!IS_ENABLED(CONFIG_ACCEL_FIFO_DECIMATE) || !decimation ||
+	    sensor_num >= MAX_MOTION_SENSORS)
+		return false;
+
+	if (decimation_count[sensor_num]++ & (BIT(decimation) - 1)) {
+		fifo_lost++;
+		motion_sensors[sensor_num].lost++;
+		return true;
+	}
+	return false;
+}
+
 /**
  * Stage a single data unit to the motion sense fifo. Note that for the AP to
  * see this data, it must be committed.
  *
+ * WARNING: This function MUST be called from within a locked context of
+ * g_sensor_mutex.
+ *
  * @param data The data to stage.
  * @param sensor The sensor that generated the data
  * @param valid_data The number of readable data entries in the data.
+ * @return True if the data was not staged because the AP does not need it:
+ *	   the caller should still pass it to online calibration.
  */
-static void fifo_stage_unit(
+static bool fifo_stage_unit_locked(
 	struct ec_response_motion_sensor_data *data,
 	struct motion_sensor_t *sensor,
 	int valid_data)
@@ -234,8 +283,6 @@ static void fifo_stage_unit(
 	struct queue_chunk chunk;
 	int i;
 
-	mutex_lock(&g_sensor_mutex);
-
 	for (i = 0; i < valid_data; i++)
 		sensor->xyz[i] = data->data[i];
 
@@ -260,15 +307,8 @@ static void fifo_stage_unit(
 			removed = sensor->oversampling++;
 			sensor->oversampling %= sensor->oversampling_ratio;
 		}
-		if (removed) {
-			mutex_unlock(&g_sensor_mutex);
-			if (IS_ENABLED(CONFIG_ONLINE_CALIB) &&
-			    next_timestamp_initialized & BIT(data->sensor_num))
-				online_calibration_process_data(
-					data, sensor,
-					next_timestamp[data->sensor_num].next);
-			return;
-		}
+		if (removed)
+			return true;
 	}
 
 	/* Make sure we have room for the data */
@@ -292,8 +332,7 @@ static void fifo_stage_unit(
 		 * address 0. Just don't add any data to the queue instead.
 		 */
 		CPRINTS("Failed to get write chunk for new fifo data!");
-		mutex_unlock(&g_sensor_mutex);
-		return;
+		return false;
 	}
 
 	/*
@@ -315,27 +354,96 @@ static void fifo_stage_unit(
 	 */
 	if (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS) &&
 	    !is_timestamp(data) &&
-	    ++fifo_staged.sample_count[data->sensor_num] > 1)
-		fifo_staged.requires_spreading = 1;
+	    ++fifo_staged.sample_count[data->sensor_num] == 2)
+		fifo_staged.requires_spreading++;
+
+	return false;
+}
+
+/**
+ * Pass data the AP does not need to online calibration.
+ *
+ * @param data The data that was not staged.
+ * @param sensor The sensor that generated the data
+ */
+static void fifo_calibrate_removed(
+	struct ec_response_motion_sensor_data *data,
+	struct motion_sensor_t *sensor)
+{
+	if (IS_ENABLED(CONFIG_ONLINE_CALIB) &&
+	    next_timestamp_initialized & BIT(data->sensor_num))
+		online_calibration_process_data(
+			data, sensor, next_timestamp[data->sensor_num].next);
+}
+
+/**
+ * Stage a single data unit to the motion sense fifo. Note that for the AP to
+ * see this data, it must be committed.
+ *
+ * @param data The data to stage.
+ * @param sensor The sensor that generated the data
+ * @param valid_data The number of readable data entries in the data.
+ */
+static void fifo_stage_unit(
+	struct ec_response_motion_sensor_data *data,
+	struct motion_sensor_t *sensor,
+	int valid_data)
+{
+	bool removed;
 
+	mutex_lock(&g_sensor_mutex);
+	removed = fifo_stage_unit_locked(data, sensor, valid_data);
 	mutex_unlock(&g_sensor_mutex);
+
+	if (removed)
+		fifo_calibrate_removed(data, sensor);
 }
 
 /**
  * Stage an entry representing a single timestamp.
  *
+ * WARNING: This function MUST be called from within a locked context of
+ * g_sensor_mutex.
+ *
  * @param timestamp The timestamp to add to the fifo.
  * @param sensor_num The sensor number that this timestamp came from (use 0xff
  *	  for unknown).
  */
-static void fifo_stage_timestamp(uint32_t timestamp, uint8_t sensor_num)
+static void fifo_stage_timestamp_locked(uint32_t timestamp, uint8_t sensor_num)
 {
 	struct ec_response_motion_sensor_data vector;
 
 	vector.flags = MOTIONSENSE_SENSOR_FLAG_TIMESTAMP;
 	vector.timestamp = timestamp;
 	vector.sensor_num = sensor_num;
-	fifo_stage_unit(&vector, NULL, 0);
+	fifo_stage_unit_locked(&vector, NULL, 0);
+}
+
+/**
+ * Stage a sensor sample, preceded by its timestamp when using tight
+ * timestamps.
+ *
+ * WARNING: This function MUST be called from within a locked context of
+ * g_sensor_mutex.
+ *
+ * @return True if the data was not staged because the AP does not need it.
+ */
+static bool fifo_stage_sample_locked(
+	struct ec_response_motion_sensor_data *data,
+	struct motion_sensor_t *sensor,
+	int valid_data,
+	uint32_t time)
+{
+	if (valid_data && fifo_decimate(data->sensor_num))
+		return false;
+
+	if (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS)) {
+		/* First entry, save the time for spreading later. */
+		if (!fifo_staged.count)
+			fifo_staged.read_ts = __hw_clock_source_read();
+		fifo_stage_timestamp_locked(time, data->sensor_num);
+	}
+	return fifo_stage_unit_locked(data, sensor, valid_data);
 }
 
 /**
@@ -348,8 +456,8 @@ static void fifo_stage_timestamp(uint32_t timestamp, uint8_t sensor_num)
 static inline struct ec_response_motion_sensor_data *
 peek_fifo_staged(size_t offset)
 {
-	return (struct ec_response_motion_sensor_data *)
-		queue_get_write_chunk(&fifo, offset).buffer;
+	return ((struct ec_response_motion_sensor_data *) fifo.buffer) +
+		((fifo.state->tail + offset) & fifo.buffer_units_mask);
 }
 
 void motion_sense_fifo_init(void)
@@ -391,7 +499,9 @@ void motion_sense_fifo_insert_async_event(
 
 inline void motion_sense_fifo_add_timestamp(uint32_t timestamp)
 {
-	fifo_stage_timestamp(timestamp, 0xff);
+	mutex_lock(&g_sensor_mutex);
+	fifo_stage_timestamp_locked(timestamp, 0xff);
+	mutex_unlock(&g_sensor_mutex);
 	motion_sense_fifo_commit_data();
 }
 
@@ -401,33 +511,61 @@ void motion_sense_fifo_stage_data(
 	int valid_data,
 	uint32_t time)
 {
-	if (IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS)) {
-		/* First entry, save the time for spreading later. */
-		if (!fifo_staged.count)
-			fifo_staged.read_ts = __hw_clock_source_read();
-		fifo_stage_timestamp(time, data->sensor_num);
+	bool removed;
+
+	mutex_lock(&g_sensor_mutex);
+	removed = fifo_stage_sample_locked(data, sensor, valid_data, time);
+	mutex_unlock(&g_sensor_mutex);
+
+	if (removed)
+		fifo_calibrate_removed(data, sensor);
+}
+
+void motion_sense_fifo_stage_batch(
+	struct ec_response_motion_sensor_data *data,
+	int count,
+	uint32_t time)
+{
+	int i;
+
+	mutex_lock(&g_sensor_mutex);
+	for (i = 0; i < count; i++) {
+		struct motion_sensor_t *sensor =
+			&motion_sensors[data[i].sensor_num];
+
+		if (!fifo_stage_sample_locked(&data[i], sensor, 3, time))
+			continue;
+
+		/* Rare: the AP does not want this sensor's data at all. */
+		mutex_unlock(&g_sensor_mutex);
+		fifo_calibrate_removed(&data[i], sensor);
+		mutex_lock(&g_sensor_mutex);
 	}
-	fifo_stage_unit(data, sensor, valid_data);
+	mutex_unlock(&g_sensor_mutex);
 }
 
 void motion_sense_fifo_commit_data(void)
 {
 	/* Cached data periods, static to store off stack. */
 	static uint32_t data_periods[MAX_MOTION_SENSORS];
-	struct ec_response_motion_sensor_data *data;
+	struct ec_response_motion_sensor_data *data, *ts;
 	int i, window, sensor_num;
+	bool spread;
 
 	/* Nothing staged, no work to do. */
 	if (!fifo_staged.count)
 		return;
 
 	mutex_lock(&g_sensor_mutex);
+	decimation_raised = 0;
+
 	/*
 	 * If per-sensor event counts are never more than 1, no spreading is
 	 * needed. This will also catch cases where tight timestamps aren't
 	 * used.
 	 */
-	if (!fifo_staged.requires_spreading)
+	spread = fifo_staged.requires_spreading;
+	if (!spread)
 		goto commit_data_end;
 
 	data = peek_fifo_staged(0);
@@ -440,7 +578,7 @@ void motion_sense_fifo_commit_data(void)
 	 */
 	if (!is_timestamp(data)) {
 		CPRINTS("Spreading skipped, first entry is not a timestamp");
-		fifo_staged.requires_spreading = 0;
+		spread = false;
 		goto commit_data_end;
 	}
 
@@ -475,9 +613,19 @@ commit_data_end:
 	 * or more timestamps followed by exactly 1 data entry. We'll loop
 	 * through the timestamps until we get to data. We only need to update
 	 * the timestamp right before it to keep things correct.
+	 *
+	 * Entries are walked with a running pointer into the queue buffer,
+	 * only wrapping around at its end, instead of recomputing each
+	 * entry's position.
 	 */
-	for (i = 0; i < fifo_staged.count; i++) {
-		data = peek_fifo_staged(i);
+	data = peek_fifo_staged(0);
+	ts = NULL;
+	for (i = 0; i < fifo_staged.count; i++, ts = data++) {
+		if (data == (struct ec_response_motion_sensor_data *)
+				fifo.buffer + fifo.buffer_units)
+			data = (struct ec_response_motion_sensor_data *)
+				fifo.buffer;
+
 		if (data->flags & MOTIONSENSE_SENSOR_FLAG_WAKEUP)
 			wake_up_needed = 1;
 
@@ -487,12 +635,11 @@ commit_data_end:
 		if (!is_data(data))
 			continue;
 
-		/* Get the sensor number and point to the timestamp entry. */
+		/* Get the sensor number, ts points to the timestamp entry. */
 		sensor_num = data->sensor_num;
-		data = peek_fifo_staged(i - 1);
 
 		/* Verify we're pointing at a timestamp. */
-		if (!is_timestamp(data)) {
+		if (!ts || !is_timestamp(ts)) {
 			CPRINTS("FIFO entries out of order,"
 				" expected timestamp");
 			continue;
@@ -504,23 +651,21 @@ commit_data_end:
 		 * ahead.
 		 */
 		if (!(next_timestamp_initialized & BIT(sensor_num)) ||
-		    time_after(data->timestamp,
+		    time_after(ts->timestamp,
 			       next_timestamp[sensor_num].prev)) {
-			next_timestamp[sensor_num].next = data->timestamp;
+			next_timestamp[sensor_num].next = ts->timestamp;
 			next_timestamp_initialized |= BIT(sensor_num);
 		}
 
 		/* Spread the timestamp and compute the expected next. */
-		data->timestamp = next_timestamp[sensor_num].next;
+		ts->timestamp = next_timestamp[sensor_num].next;
 		next_timestamp[sensor_num].prev =
 			next_timestamp[sensor_num].next;
 		next_timestamp[sensor_num].next +=
-			fifo_staged.requires_spreading
-			? data_periods[sensor_num]
-			: motion_sensors[sensor_num].collection_rate;
+			spread ? data_periods[sensor_num]
+			       : motion_sensors[sensor_num].collection_rate;
 
 		/* Update online calibration if enabled. */
-		data = peek_fifo_staged(i);
 		if (IS_ENABLED(CONFIG_ONLINE_CALIB))
 			online_calibration_process_data(
 				data, &motion_sensors[sensor_num],
@@ -553,6 +698,25 @@ void motion_sense_fifo_get_info(
 		fifo_lost = 0;
 }
 
+void motion_sense_fifo_record_read(struct motion_sensor_t *sensor,
+				   int xfers, int bytes, uint32_t us)
+{
+	struct motion_sense_fifo_read_stats *stats =
+		&read_stats[sensor - motion_sensors];
+
+	stats->reads++;
+	stats->xfers += xfers;
+	stats->bytes += bytes;
+	stats->total_us += us;
+	stats->max_us = MAX(stats->max_us, us);
+}
+
+const struct motion_sense_fifo_read_stats *
+motion_sense_fifo_get_read_stats(int sensor_num)
+{
+	return &read_stats[sensor_num];
+}
+
 static int motion_sense_get_next_event(uint8_t *out)
 {
 	union ec_response_get_next_data *data =
@@ -584,6 +748,10 @@ int motion_sense_fifo_read(int capacity_bytes, int max_count, void *out,
 	count = MIN(capacity_bytes / fifo.unit_bytes,
 		    MIN(queue_count(&fifo), max_count));
 	count = queue_remove_units(&fifo, out, count);
+	/* Once the AP has caught up, step the decimation back down. */
+	if (IS_ENABLED(CONFIG_ACCEL_FIFO_DECIMATE) && decimation &&
+	    queue_count(&fifo) < fifo.buffer_units / 2)
+		decimation--;
 	mutex_unlock(&g_sensor_mutex);
 	*out_size = count * fifo.unit_bytes;
 
@@ -594,6 +762,10 @@ void motion_sense_fifo_reset(void)
 {
 	next_timestamp_initialized = 0;
 	memset(&fifo_staged, 0, sizeof(fifo_staged));
+	memset(read_stats, 0, sizeof(read_stats));
+	decimation = 0;
+	decimation_raised = 0;
+	memset(decimation_count, 0, sizeof(decimation_count));
 	motion_sense_fifo_init();
 	queue_init(&fifo);
 }
@@ -19,6 +19,28 @@ struct queue_policy const queue_policy_null = {
 	.remove = queue_action_null,
 };
 
+/*
+ * Single-producer/single-consumer ordering.  The producer only ever writes
+ * the tail and the consumer only ever writes the head, so each side can read
+ * its own index directly.  The other side's index is read with acquire
+ * semantics, and an index is only published (with release semantics) after
+ * the units it covers have been copied.  This makes the units visible to the
+ * other side no later than the index that covers them.
+ *
+ * On a single core this just keeps the compiler from moving buffer accesses
+ * across the index update; on the host, where producer and consumer can be
+ * real threads, it also emits the needed fences.
+ */
+static inline size_t queue_load_acquire(size_t volatile *index)
+{
+	return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static inline void queue_store_release(size_t volatile *index, size_t value)
+{
+	__atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
 void queue_init(struct queue const *q)
 {
 	ASSERT(q->policy);
@@ -31,12 +53,14 @@ void queue_init(struct queue const *q)
 
 int queue_is_empty(struct queue const *q)
 {
-	return q->state->head == q->state->tail;
+	return queue_count(q) == 0;
 }
 
 size_t queue_count(struct queue const *q)
 {
-	return q->state->tail - q->state->head;
+	size_t head = queue_load_acquire(&q->state->head);
+
+	return queue_load_acquire(&q->state->tail) - head;
 }
 
 size_t queue_space(struct queue const *q)
@@ -72,18 +96,23 @@ int queue_is_full(struct queue const *q)
 
 struct queue_chunk queue_get_write_chunk(struct queue const *q, size_t offset)
 {
-	size_t head = q->state->head & q->buffer_units_mask;
-	size_t tail = (q->state->tail + offset) & q->buffer_units_mask;
-	size_t last = (tail < head) ? head :   /* Wrapped        */
-			q->buffer_units;       /* Normal | Empty */
+	size_t head  = queue_load_acquire(&q->state->head);
+	size_t tail  = q->state->tail + offset;
+	size_t space = q->buffer_units - (q->state->tail - head);
+	size_t last;
 
 	/* Make sure that the offset doesn't exceed free space. */
-	if (queue_space(q) <= offset)
+	if (space <= offset)
 		return ((struct queue_chunk) {
 			.count = 0,
 			.buffer = NULL,
 		});
 
+	head &= q->buffer_units_mask;
+	tail &= q->buffer_units_mask;
+	last  = (tail < head) ? head :   /* Wrapped        */
+		q->buffer_units;         /* Normal | Empty */
+
 	return ((struct queue_chunk) {
 		.count = last - tail,
 		.buffer = q->buffer + (tail * q->unit_bytes),
@@ -92,23 +121,64 @@ struct queue_chunk queue_get_write_chunk(struct queue const *q, size_t offset)
 
 struct queue_chunk queue_get_read_chunk(struct queue const *q)
 {
-	size_t head = q->state->head & q->buffer_units_mask;
-	size_t tail = q->state->tail & q->buffer_units_mask;
-	size_t last = (queue_is_empty(q) ? head : /* Empty          */
-		       ((head < tail) ? tail :    /* Normal         */
-			q->buffer_units));        /* Wrapped | Full */
+	struct queue_chunk chunks[2];
 
-	return ((struct queue_chunk) {
-		.count = (last - head),
+	queue_get_read_chunks(q, chunks);
+
+	return chunks[0];
+}
+
+/*
+ * Both multi-chunk getters read the other side's index exactly once, so that
+ * the two chunks describe the same set of units even if the other side moves
+ * its index concurrently.  Anything past the first chunk has wrapped to the
+ * buffer start.
+ */
+size_t queue_get_write_chunks(struct queue const *q,
+			      struct queue_chunk chunks[2])
+{
+	size_t head  = queue_load_acquire(&q->state->head);
+	size_t space = q->buffer_units - (q->state->tail - head);
+	size_t tail  = q->state->tail & q->buffer_units_mask;
+	size_t first = MIN(space, q->buffer_units - tail);
+
+	chunks[0] = ((struct queue_chunk) {
+		.count = first,
+		.buffer = q->buffer + (tail * q->unit_bytes),
+	});
+	chunks[1] = ((struct queue_chunk) {
+		.count = space - first,
+		.buffer = q->buffer,
+	});
+
+	return space;
+}
+
+size_t queue_get_read_chunks(struct queue const *q,
+			     struct queue_chunk chunks[2])
+{
+	size_t tail  = queue_load_acquire(&q->state->tail);
+	size_t count = tail - q->state->head;
+	size_t head  = q->state->head & q->buffer_units_mask;
+	size_t first = MIN(count, q->buffer_units - head);
+
+	chunks[0] = ((struct queue_chunk) {
+		.count = first,
 		.buffer = q->buffer + (head * q->unit_bytes),
 	});
+	chunks[1] = ((struct queue_chunk) {
+		.count = count - first,
+		.buffer = q->buffer,
+	});
+
+	return count;
 }
 
 size_t queue_advance_head(struct queue const *q, size_t count)
 {
 	size_t transfer = MIN(count, queue_count(q));
 
-	q->state->head += transfer;
+	queue_store_release(&q->state->head, q->state->head + transfer);
 
 	q->policy->remove(q->policy, transfer);
 
@@ -119,7 +189,7 @@ size_t queue_advance_tail(struct queue const *q, size_t count)
 {
 	size_t transfer = MIN(count, queue_space(q));
 
-	q->state->tail += transfer;
+	queue_store_release(&q->state->tail, q->state->tail + transfer);
 
 	q->policy->add(q->policy, transfer);
 
@@ -146,16 +216,15 @@ size_t queue_add_units(struct queue const *q, const void *src, size_t count)
 	return queue_add_memcpy(q, src, count, memcpy);
 }
 
-size_t queue_add_memcpy(struct queue const *q,
-			const void *src,
-			size_t count,
-			void *(*memcpy)(void *dest,
-					const void *src,
-					size_t n))
+static void queue_write_safe(struct queue const *q,
+			     size_t tail,
+			     const void *src,
+			     size_t transfer,
+			     void *(*memcpy)(void *dest,
+					     const void *src,
+					     size_t n))
 {
-	size_t transfer = MIN(count, queue_space(q));
-	size_t tail     = q->state->tail & q->buffer_units_mask;
-	size_t first    = MIN(transfer, q->buffer_units - tail);
+	size_t first = MIN(transfer, q->buffer_units - tail);
 
 	memcpy(q->buffer + tail * q->unit_bytes,
 	       src,
@@ -165,10 +234,42 @@ size_t queue_add_memcpy(struct queue const *q,
 		memcpy(q->buffer,
 		       ((uint8_t const *) src) + first * q->unit_bytes,
 		       (transfer - first) * q->unit_bytes);
+}
+
+size_t queue_add_memcpy(struct queue const *q,
+			const void *src,
+			size_t count,
+			void *(*memcpy)(void *dest,
+					const void *src,
+					size_t n))
+{
+	size_t transfer = MIN(count, queue_space(q));
+	size_t tail     = q->state->tail & q->buffer_units_mask;
+
+	queue_write_safe(q, tail, src, transfer, memcpy);
 
 	return queue_advance_tail(q, transfer);
 }
 
+size_t queue_add_chunks(struct queue const *q,
+			struct queue_chunk const *src,
+			size_t n)
+{
+	size_t space = queue_space(q);
+	size_t added = 0;
+	size_t i;
+
+	for (i = 0; i < n && added < space; i++) {
+		size_t transfer = MIN(src[i].count, space - added);
+		size_t tail = (q->state->tail + added) & q->buffer_units_mask;
+
+		queue_write_safe(q, tail, src[i].buffer, transfer, memcpy);
+		added += transfer;
+	}
+
+	return queue_advance_tail(q, added);
+}
+
 static void queue_read_safe(struct queue const *q,
 			    void *dest,
 			    size_t head,
@@ -224,6 +325,25 @@ size_t queue_remove_memcpy(struct queue const *q,
 	return queue_advance_head(q, transfer);
 }
 
+size_t queue_remove_chunks(struct queue const *q,
+			   struct queue_chunk const *dest,
+			   size_t n)
+{
+	size_t count = queue_count(q);
+	size_t removed = 0;
+	size_t i;
+
+	for (i = 0; i < n && removed < count; i++) {
+		size_t transfer = MIN(dest[i].count, count - removed);
+		size_t head = (q->state->head + removed) & q->buffer_units_mask;
+
+		queue_read_safe(q, dest[i].buffer, head, transfer, memcpy);
+		removed += transfer;
+	}
+
+	return queue_advance_head(q, removed);
+}
+
 size_t queue_peek_units(struct queue const *q,
 			void *dest,
 			size_t i,
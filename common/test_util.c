@@ -11,6 +11,10 @@
 #include <stdlib.h>
 #endif
 
+#ifdef EMU_BUILD
+#include <time.h>
+#endif
+
 #include "console.h"
 #include "hooks.h"
 #include "host_command.h"
@@ -100,6 +104,16 @@ int test_get_error_count(void)
 	return __test_error_count;
 }
 
+#ifdef EMU_BUILD
+uint64_t test_host_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
 uint32_t test_get_state(void)
 {
 	return system_get_scratchpad();
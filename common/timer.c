@@ -35,6 +35,17 @@ static uint32_t timer_running;
 static timestamp_t timer_deadline[TASK_ID_COUNT];
 static uint32_t next_deadline = 0xffffffff;
 
+/*
+ * Running timers, as a list of task IDs sorted by deadline.  timer_arm() and
+ * timer_cancel() keep it sorted, so process_timers() only has to look at the
+ * timers which have expired and the first one which hasn't.  Tasks only
+ * modify the list with interrupts locked; process_timers() runs in interrupt
+ * context (or with interrupts disabled) and so needs no locking.
+ */
+#define TIMER_LIST_END 0xff
+static uint8_t timer_head = TIMER_LIST_END;
+static uint8_t timer_next[TASK_ID_COUNT];
+
 /* Hardware timer routine IRQ number */
 static int timer_irq;
 
@@ -46,6 +57,33 @@ static void expire_timer(task_id_t tskid)
 	task_set_event(tskid, TASK_EVENT_TIMER, 0);
 }
 
+/* Insert tskid in the running timer list, after any equal deadlines. */
+static void timer_list_insert(task_id_t tskid)
+{
+	uint8_t *p = &timer_head;
+
+	while (*p != TIMER_LIST_END &&
+	       timer_deadline[*p].val <= timer_deadline[tskid].val)
+		p = &timer_next[*p];
+
+	timer_next[tskid] = *p;
+	*p = tskid;
+}
+
+/* Remove tskid from the running timer list, if it is there. */
+static void timer_list_remove(task_id_t tskid)
+{
+	uint8_t *p = &timer_head;
+
+	while (*p != TIMER_LIST_END) {
+		if (*p == tskid) {
+			*p = timer_next[tskid];
+			return;
+		}
+		p = &timer_next[*p];
+	}
+}
+
 int timestamp_expired(timestamp_t deadline, const timestamp_t *now)
 {
 	timestamp_t now_val;
@@ -60,43 +98,37 @@ int timestamp_expired(timestamp_t deadline, const timestamp_t *now)
 
 void process_timers(int overflow)
 {
-	uint32_t check_timer, running_t0;
 	timestamp_t next;
 	timestamp_t now;
+	int tskid;
 
 	if (!IS_ENABLED(CONFIG_HWTIMER_64BIT) && overflow)
 		clksrc_high++;
 
 	do {
-		next.val = -1ull;
 		now = get_time();
-		do {
-			/* read atomically the current state of timer running */
-			check_timer = running_t0 = timer_running;
-			while (check_timer) {
-
-				int tskid = __fls(check_timer);
-				/* timer has expired ? */
-				if (timer_deadline[tskid].val <= now.val)
-					expire_timer(tskid);
-				else if ((timer_deadline[tskid].le.hi ==
-					  now.le.hi) &&
-					 (timer_deadline[tskid].le.lo <
-					  next.le.lo))
-					next.val = timer_deadline[tskid].val;
-
-				check_timer &= ~BIT(tskid);
-			}
-		/* if there is a new timer, let's retry */
-		} while (timer_running & ~running_t0);
-
-		if (next.le.hi == 0xffffffff) {
+
+		/* Expire timers from the head of the list until one is due */
+		while (timer_head != TIMER_LIST_END &&
+		       timer_deadline[timer_head].val <= now.val) {
+			tskid = timer_head;
+			timer_head = timer_next[tskid];
+			expire_timer(tskid);
+		}
+
+		/*
+		 * Only deadlines within the current 32-bit period can be
+		 * programmed; later ones get picked up after an overflow.
+		 */
+		if (timer_head == TIMER_LIST_END ||
+		    timer_deadline[timer_head].le.hi != now.le.hi) {
 			/* no deadline to set */
 			__hw_clock_event_clear();
 			next_deadline = 0xffffffff;
 			return;
 		}
 
+		next = timer_deadline[timer_head];
 		__hw_clock_event_set(next.le.lo);
 		next_deadline = next.le.lo;
 	} while (next.val <= get_time().val);
@@ -125,14 +157,18 @@ void udelay(unsigned us)
 int timer_arm(timestamp_t event, task_id_t tskid)
 {
 	timestamp_t now = get_time();
+	uint32_t key;
 
 	ASSERT(tskid < TASK_ID_COUNT);
 
 	if (timer_running & BIT(tskid))
 		return EC_ERROR_BUSY;
 
+	key = irq_lock();
 	timer_deadline[tskid] = event;
+	timer_list_insert(tskid);
 	atomic_or(&timer_running, BIT(tskid));
+	irq_unlock(key);
 
 	/* Modify the next event if needed */
 	if ((event.le.hi < now.le.hi) ||
@@ -144,9 +180,15 @@ int timer_arm(timestamp_t event, task_id_t tskid)
 
 void timer_cancel(task_id_t tskid)
 {
+	uint32_t key;
+
 	ASSERT(tskid < TASK_ID_COUNT);
 
+	key = irq_lock();
+	if (timer_running & BIT(tskid))
+		timer_list_remove(tskid);
 	atomic_clear_bits(&timer_running, BIT(tskid));
+	irq_unlock(key);
 	/*
 	 * Don't need to cancel the hardware timer interrupt, instead do
 	 * timer-related housekeeping when the next timer interrupt fires.
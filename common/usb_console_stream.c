@@ -137,6 +137,25 @@ uint32_t usb_console_crc(void)
 {
 	return crc32_ctx_result(&usb_tx_crc_ctx);
 }
+
+/*
+ * Hash and queue a run of characters with no newline in it, blocking on
+ * overrun like __tx_char() does.
+ */
+static void __tx_chars(const char *s, int len)
+{
+	size_t added;
+
+	crc32_ctx_hash_buf(&usb_tx_crc_ctx, s, len);
+
+	while (len > 0) {
+		added = queue_add_units(&tx_q, s, len);
+		if (!added)
+			usleep(500);
+		s += added;
+		len -= added;
+	}
+}
 #endif
 
 static int __tx_char(void *context, int c)
@@ -190,6 +209,18 @@ int usb_puts(const char *outstr)
 		return ret;
 
 	while (*outstr) {
+#ifdef CONFIG_USB_CONSOLE_CRC
+		int len = 0;
+
+		/* Hash everything up to the next newline in one go */
+		while (outstr[len] && outstr[len] != '\n')
+			len++;
+		if (len) {
+			__tx_chars(outstr, len);
+			outstr += len;
+			continue;
+		}
+#endif
 		ret = __tx_char(NULL, *outstr++);
 		if (ret)
 			break;
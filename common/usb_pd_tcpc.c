@@ -337,10 +337,9 @@ int prepare_message(int port, uint16_t header, uint8_t cnt,
 	crc32_init();
 	crc32_hash16(header);
 	/* data payload */
-	for (i = 0; i < cnt; i++) {
+	for (i = 0; i < cnt; i++)
 		off = encode_word(port, off, data[i]);
-		crc32_hash32(data[i]);
-	}
+	crc32_hash_buf(data, cnt * sizeof(*data));
 	/* CRC */
 	off = encode_word(port, off, crc32_result());
 
@@ -733,10 +732,9 @@ int pd_analyze_rx(int port, uint32_t *payload)
 #endif
 
 	/* read payload data */
-	for (p = 0; p < cnt && bit > 0; p++) {
+	for (p = 0; p < cnt && bit > 0; p++)
 		bit = decode_word(port, bit, payload+p);
-		crc32_hash32(payload[p]);
-	}
+	crc32_hash_buf(payload, p * sizeof(*payload));
 	ccrc = crc32_result();
 
 #ifdef CONFIG_COMMON_RUNTIME
@@ -13,6 +13,7 @@
 #include "console.h"
 #include "ec_commands.h"
 #include "system.h"
+#include "task.h"
 #include "tcpm.h"
 #include "usb_dp_alt_mode.h"
 #include "usb_mode.h"
@@ -74,6 +75,7 @@ enum ec_status pd_request_enter_mode(int port, enum typec_mode mode)
 
 	DPM_CLR_FLAG(port, DPM_FLAG_MODE_ENTRY_DONE);
 	DPM_CLR_FLAG(port, DPM_FLAG_EXIT_REQUEST);
+	task_wake(PD_PORT_TO_TASK_ID(port));
 
 	return EC_RES_SUCCESS;
 }
@@ -93,6 +95,7 @@ static void dpm_set_mode_entry_done(int port)
 void dpm_set_mode_exit_request(int port)
 {
 	DPM_SET_FLAG(port, DPM_FLAG_EXIT_REQUEST);
+	task_wake(PD_PORT_TO_TASK_ID(port));
 }
 
 static void dpm_clear_mode_exit_request(int port)
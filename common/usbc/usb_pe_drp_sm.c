@@ -879,8 +879,11 @@ void pe_run(int port, int evt, int en)
 {
 	switch (local_state[port]) {
 	case SM_PAUSED:
-		if (!en)
+		if (!en) {
+			usbc_sm_set_deadline(port, USBC_SM_PE,
+					     USBC_NO_DEADLINE);
 			break;
+		}
 		/* fall through */
 	case SM_INIT:
 		pe_init(port);
@@ -1277,6 +1280,7 @@ void pd_resume_check_pr_swap_needed(int port)
 void pd_dpm_request(int port, enum pd_dpm_request req)
 {
 	PE_SET_DPM_REQUEST(port, req);
+	task_wake(PD_PORT_TO_TASK_ID(port));
 }
 
 void pe_vconn_swap_complete(int port)
@@ -1687,6 +1691,39 @@ __maybe_unused static bool pe_attempt_port_discovery(int port)
 	return false;
 }
 
+/*
+ * Called at the end of PE_SNK_Ready and PE_SRC_Ready once they found nothing
+ * to do, to publish when one of their timers is next due. Anything else that
+ * moves a Ready state on is a message, a DPM request or a TC/DPM call, which
+ * all wake the PD task.
+ */
+static void pe_ready_set_deadline(int port)
+{
+	uint64_t deadline = pe[port].wait_and_add_jitter_timer;
+
+	/* Sink requests and discovery wait for the jitter timer */
+	if (deadline == TIMER_DISABLED) {
+		if (pe[port].power_role == PD_ROLE_SINK)
+			deadline = pe[port].sink_request_timer;
+
+		/*
+		 * Once the discovery timer has expired, discovery only moves
+		 * on after a message exchange, so only a future expiry counts.
+		 */
+		if (IS_ENABLED(CONFIG_USB_PD_ALT_MODE_DFP) &&
+		    !PE_CHK_FLAG(port, PE_FLAGS_VDM_SETUP_DONE) &&
+		    pe[port].discover_identity_timer > get_time().val)
+			deadline = MIN(deadline,
+				       pe[port].discover_identity_timer);
+	}
+
+	if (pe[port].power_role == PD_ROLE_SOURCE &&
+	    PE_CHK_FLAG(port, PE_FLAGS_WAITING_PR_SWAP))
+		deadline = MIN(deadline, pe[port].pr_swap_wait_timer);
+
+	usbc_sm_set_deadline(port, USBC_SM_PE, deadline);
+}
+
 bool pd_setup_vdm_request(int port, enum tcpm_transmit_type tx_type,
 		uint32_t *vdm, uint32_t vdo_cnt)
 {
@@ -2531,6 +2568,8 @@ static void pe_src_ready_run(int port)
 		/* No DPM requests; attempt mode entry/exit if needed */
 		dpm_run(port);
 	}
+
+	pe_ready_set_deadline(port);
 }
 
 /**
@@ -2554,6 +2593,12 @@ static void pe_src_disabled_entry(int port)
 	 */
 }
 
+static void pe_src_disabled_run(int port)
+{
+	/* Nothing to do until Hard Reset Signaling wakes us */
+	usbc_sm_set_deadline(port, USBC_SM_PE, USBC_NO_DEADLINE);
+}
+
 /**
  * PE_SRC_Capability_Response
  */
@@ -3331,6 +3376,8 @@ static void pe_snk_ready_run(int port)
 		dpm_run(port);
 
 	}
+
+	pe_ready_set_deadline(port);
 }
 
 /**
@@ -6508,6 +6555,7 @@ static const struct usb_state pe_states[] = {
 	},
 	[PE_SRC_DISABLED] = {
 		.entry = pe_src_disabled_entry,
+		.run   = pe_src_disabled_run,
 	},
 	[PE_SRC_CAPABILITY_RESPONSE] = {
 		.entry = pe_src_capability_response_entry,
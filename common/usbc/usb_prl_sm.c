@@ -628,8 +628,11 @@ void prl_run(int port, int evt, int en)
 {
 	switch (local_state[port]) {
 	case SM_PAUSED:
-		if (!en)
+		if (!en) {
+			usbc_sm_set_deadline(port, USBC_SM_PRL,
+					     USBC_NO_DEADLINE);
 			break;
+		}
 		prl_set_default_pd_revision(port);
 		/* fall through */
 	case SM_INIT:
@@ -681,6 +684,18 @@ void prl_run(int port, int evt, int en)
 
 		/* Run Protocol Layer Hard Reset state machine */
 		run_state(port, &prl_hr[port].ctx);
+
+		/*
+		 * With nothing in flight, only a message from the PE (which
+		 * runs first) or the TCPC (which raises an event) moves us on.
+		 * Messages are dequeued one per pass, so keep going while the
+		 * TCPC still has some.
+		 */
+		if (prl_tx_get_state(port) == PRL_TX_WAIT_FOR_MESSAGE_REQUEST &&
+		    prl_hr_get_state(port) == PRL_HR_WAIT_FOR_REQUEST &&
+		    !prl_is_busy(port) && !tcpm_has_pending_message(port))
+			usbc_sm_set_deadline(port, USBC_SM_PRL,
+					     USBC_NO_DEADLINE);
 		break;
 	}
 }
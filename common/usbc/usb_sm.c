@@ -29,34 +29,40 @@ struct internal_ctx {
 BUILD_ASSERT(sizeof(struct internal_ctx) ==
 	     member_size(struct sm_ctx, internal));
 
+/* Number of parents above a state */
+static int state_depth(usb_state_ptr s)
+{
+	int depth = 0;
+
+	for (s = s->parent; s != NULL; s = s->parent)
+		depth++;
+
+	return depth;
+}
+
 /* Gets the first shared parent state between a and b (inclusive) */
 static usb_state_ptr shared_parent_state(usb_state_ptr a, usb_state_ptr b)
 {
-	const usb_state_ptr orig_b = b;
+	int depth_a, depth_b;
 
 	/* There are no common ancestors */
-	if (b == NULL)
+	if (a == NULL || b == NULL)
 		return NULL;
 
-	/* This assumes that both A and B are NULL terminated without cycles */
-	while (a != NULL) {
-		/* We found a match return */
-		if (a == b)
-			return a;
-
-		/*
-		 * Otherwise, increment b down the list for comparison until we
-		 * run out, then increment a and start over on b for comparison
-		 */
-		if (b->parent == NULL) {
-			a = a->parent;
-			b = orig_b;
-		} else {
-			b = b->parent;
-		}
+	/* Bring both states up to the same depth, then walk up together */
+	depth_a = state_depth(a);
+	depth_b = state_depth(b);
+	for (; depth_a > depth_b; depth_a--)
+		a = a->parent;
+	for (; depth_b > depth_a; depth_b--)
+		b = b->parent;
+
+	while (a != b) {
+		a = a->parent;
+		b = b->parent;
 	}
 
-	return NULL;
+	return a;
 }
 
 /*
@@ -67,24 +73,30 @@ static usb_state_ptr shared_parent_state(usb_state_ptr a, usb_state_ptr b)
 static void call_entry_functions(const int port,
 			       struct internal_ctx *const internal,
 			       const usb_state_ptr stop,
-			       const usb_state_ptr current)
+			       usb_state_ptr current)
 {
-	if (current == stop)
-		return;
+	usb_state_ptr path[USB_SM_MAX_DEPTH + 1];
+	int n = 0;
 
-	call_entry_functions(port, internal, stop, current->parent);
+	for (; current != stop; current = current->parent)
+		path[n++] = current;
 
-	/*
-	 * If the previous entry function called set_state, then don't enter
-	 * remaining states.
-	 */
-	if (!internal->enter)
-		return;
+	while (n-- > 0) {
+		/*
+		 * If the previous entry function called set_state, then don't
+		 * enter remaining states.
+		 */
+		if (!internal->enter)
+			return;
 
-	/* Track the latest state that was entered, so we can exit properly. */
-	internal->last_entered = current;
-	if (current->entry)
-		current->entry(port);
+		/*
+		 * Track the latest state that was entered, so we can exit
+		 * properly.
+		 */
+		internal->last_entered = path[n];
+		if (path[n]->entry)
+			path[n]->entry(port);
+	}
 }
 
 /*
@@ -92,15 +104,11 @@ static void call_entry_functions(const int port,
  * during an exit function.
  */
 static void call_exit_functions(const int port, const usb_state_ptr stop,
-			      const usb_state_ptr current)
+			      usb_state_ptr current)
 {
-	if (current == stop)
-		return;
-
-	if (current->exit)
-		current->exit(port);
-
-	call_exit_functions(port, stop, current->parent);
+	for (; current != stop; current = current->parent)
+		if (current->exit)
+			current->exit(port);
 }
 
 void set_state(const int port, struct sm_ctx *const ctx,
@@ -172,24 +180,17 @@ void set_state(const int port, struct sm_ctx *const ctx,
 
 /*
  * Call all run functions of children before parents. If set_state is called
- * during one of the entry functions, then do not call any remaining entry
+ * during one of the run functions, then do not call any remaining run
  * functions.
  */
 static void call_run_functions(const int port,
 			     const struct internal_ctx *const internal,
-			     const usb_state_ptr current)
+			     usb_state_ptr current)
 {
-	if (!current)
-		return;
-
 	/* If set_state is called during run, don't call remain functions. */
-	if (!internal->running)
-		return;
-
-	if (current->run)
-		current->run(port);
-
-	call_run_functions(port, internal, current->parent);
+	for (; current != NULL && internal->running; current = current->parent)
+		if (current->run)
+			current->run(port);
 }
 
 void run_state(const int port, struct sm_ctx *const ctx)
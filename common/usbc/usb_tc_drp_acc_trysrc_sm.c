@@ -1928,6 +1928,29 @@ static void sink_power_sub_states(int port)
 	}
 }
 
+/*
+ * Publish when Attached.SNK next needs to run: the end of a Vbus or Rp
+ * debounce. Only done when the TCPC detects Vbus, as detach and Rp changes
+ * then raise an alert.
+ */
+static void attached_snk_set_deadline(int port)
+{
+	uint64_t now = get_time().val;
+	uint64_t deadline = USBC_NO_DEADLINE;
+
+	if (!IS_ENABLED(CONFIG_USB_PD_VBUS_DETECT_TCPC) ||
+	    TC_CHK_FLAG(port, TC_FLAGS_POWER_OFF_SNK))
+		return;
+
+	if (TC_CHK_FLAG(port, TC_FLAGS_PR_SWAP_IN_PROGRESS))
+		deadline = tc[port].vbus_debounce_time;
+
+	/* A stale debounce is left behind while there is a contract */
+	if (tc[port].cc_debounce > now)
+		deadline = MIN(deadline, tc[port].cc_debounce);
+
+	usbc_sm_set_deadline(port, USBC_SM_TC, deadline);
+}
 
 /*
  * TYPE-C State Implementations
@@ -2118,6 +2141,12 @@ static void tc_unattached_snk_run(const int port)
 		   (drp_state[port] == PD_DRP_FORCE_SINK ||
 		    drp_state[port] == PD_DRP_TOGGLE_OFF)) {
 		set_state_tc(port, TC_LOW_POWER_MODE);
+	} else {
+		/* Wait for a CC change or the next DRP toggle */
+		usbc_sm_set_deadline(port, USBC_SM_TC,
+				     drp_state[port] == PD_DRP_TOGGLE_ON ?
+				     tc[port].next_role_swap :
+				     USBC_NO_DEADLINE);
 	}
 }
 
@@ -2457,6 +2486,7 @@ static void tc_attached_snk_run(const int port)
 				 */
 				/* CTVPD detected */
 				set_state_tc(port, TC_UNATTACHED_SRC);
+				return;
 			}
 		}
 	}
@@ -2472,6 +2502,8 @@ static void tc_attached_snk_run(const int port)
 	/* Run Sink Power Sub-State */
 	sink_power_sub_states(port);
 #endif /* CONFIG_USB_PE_SM */
+
+	attached_snk_set_deadline(port);
 }
 
 static void tc_attached_snk_exit(const int port)
@@ -2603,6 +2635,13 @@ static void tc_unattached_src_run(const int port)
 		 (drp_state[port] == PD_DRP_FORCE_SOURCE ||
 		  drp_state[port] == PD_DRP_TOGGLE_OFF))
 		set_state_tc(port, TC_LOW_POWER_MODE);
+	/* Wait for a CC change or the next DRP toggle */
+	else if (drp_state[port] != PD_DRP_FORCE_SOURCE &&
+		 drp_state[port] != PD_DRP_FREEZE)
+		usbc_sm_set_deadline(port, USBC_SM_TC,
+				     tc[port].next_role_swap);
+	else
+		usbc_sm_set_deadline(port, USBC_SM_TC, USBC_NO_DEADLINE);
 }
 
 /**
@@ -2969,9 +3008,17 @@ static void tc_attached_src_run(const int port)
 			TC_CLR_FLAG(port, TC_FLAGS_DISC_IDENT_IN_PROGRESS);
 
 			set_state_tc(port, TC_CT_UNATTACHED_SNK);
+			return;
 		}
 	}
 #endif
+
+	/*
+	 * Detach and swap requests all wake us, leaving only the wait for the
+	 * power supply before enabling PD communications.
+	 */
+	usbc_sm_set_deadline(port, USBC_SM_TC, tc[port].timeout > 0 ?
+			     tc[port].timeout : USBC_NO_DEADLINE);
 }
 
 static void tc_attached_src_exit(const int port)
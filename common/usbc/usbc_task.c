@@ -39,6 +39,69 @@
 
 static uint8_t paused[CONFIG_USB_PD_PORT_MAX_COUNT];
 
+#ifdef TEST_BUILD
+/* Number of times the PD task has woken up, for measuring idle behavior */
+uint32_t pd_task_wakeups[CONFIG_USB_PD_PORT_MAX_COUNT];
+#endif
+
+#ifdef CONFIG_USB_PD_TICKLESS
+/* State machines that have to publish a deadline before the task can sleep */
+#define USBC_SM_ALL							\
+	((IS_ENABLED(CONFIG_USB_TYPEC_SM) ? BIT(USBC_SM_TC) : 0) |	\
+	 (IS_ENABLED(CONFIG_USB_PE_SM) ? BIT(USBC_SM_PE) : 0) |		\
+	 (IS_ENABLED(CONFIG_USB_PRL_SM) ? BIT(USBC_SM_PRL) : 0))
+
+/* State machines that published a deadline during the last pass */
+static uint8_t deadline_set[CONFIG_USB_PD_PORT_MAX_COUNT];
+/* Earliest deadline published during the last pass */
+static uint64_t next_deadline[CONFIG_USB_PD_PORT_MAX_COUNT];
+#endif
+
+void usbc_sm_set_deadline(int port, enum usbc_sm sm, uint64_t deadline)
+{
+#ifdef CONFIG_USB_PD_TICKLESS
+	deadline_set[port] |= BIT(sm);
+	if (deadline < next_deadline[port])
+		next_deadline[port] = deadline;
+#endif
+}
+
+/*
+ * Return how long the PD task may sleep before the state machines need to
+ * run again, or -1 to sleep until an event arrives.
+ */
+static int pd_task_timeout(int port)
+{
+#ifdef CONFIG_USB_PD_TICKLESS
+	uint64_t now;
+#endif
+
+	if (paused[port])
+		return -1;
+
+#ifdef CONFIG_USB_PD_TICKLESS
+	/*
+	 * Fall back to polling unless every state machine told us when it
+	 * next needs to run. The embedded TCPC is always polled.
+	 */
+	if (IS_ENABLED(CONFIG_USB_PD_TCPC) ||
+	    deadline_set[port] != USBC_SM_ALL)
+		return USBC_EVENT_TIMEOUT;
+
+	if (next_deadline[port] == USBC_NO_DEADLINE)
+		return -1;
+
+	/* State machine timers expire once get_time() is past them */
+	now = get_time().val;
+	if (next_deadline[port] < now)
+		return 1;
+
+	return MIN(next_deadline[port] - now + 1, INT32_MAX);
+#else
+	return USBC_EVENT_TIMEOUT;
+#endif
+}
+
 void tc_pause_event_loop(int port)
 {
 	paused[port] = 1;
@@ -76,10 +139,18 @@ static void pd_task_init(int port)
 static bool pd_task_loop(int port)
 {
 	/* wait for next event/packet or timeout expiration */
-	const uint32_t evt =
-		task_wait_event(paused[port]
-					? -1
-					: USBC_EVENT_TIMEOUT);
+	const uint32_t evt = task_wait_event(pd_task_timeout(port));
+	int pd_enabled;
+
+#ifdef TEST_BUILD
+	pd_task_wakeups[port]++;
+#endif
+
+#ifdef CONFIG_USB_PD_TICKLESS
+	/* Each state machine publishes a new deadline as it runs */
+	deadline_set[port] = 0;
+	next_deadline[port] = USBC_NO_DEADLINE;
+#endif
 
 	/*
 	 * Re-use TASK_EVENT_RESET_DONE in tests to restart the USB task
@@ -92,6 +163,8 @@ static bool pd_task_loop(int port)
 	if (IS_ENABLED(CONFIG_USB_TYPEC_SM))
 		tc_event_check(port, evt);
 
+	pd_enabled = tc_get_pd_enabled(port);
+
 	/*
 	 * run port controller task to check CC and/or read incoming
 	 * messages
@@ -101,16 +174,25 @@ static bool pd_task_loop(int port)
 
 	/* Run policy engine state machine */
 	if (IS_ENABLED(CONFIG_USB_PE_SM))
-		pe_run(port, evt, tc_get_pd_enabled(port));
+		pe_run(port, evt, pd_enabled);
 
 	/* Run protocol state machine */
 	if (IS_ENABLED(CONFIG_USB_PRL_SM) || IS_ENABLED(CONFIG_TEST_USB_PE_SM))
-		prl_run(port, evt, tc_get_pd_enabled(port));
+		prl_run(port, evt, pd_enabled);
 
 	/* Run TypeC state machine */
 	if (IS_ENABLED(CONFIG_USB_TYPEC_SM))
 		tc_run(port);
 
+#ifdef CONFIG_USB_PD_TICKLESS
+	/*
+	 * The TC runs last, so let the PE and PRL start or stop right away
+	 * when it enabled or disabled PD communications.
+	 */
+	if (tc_get_pd_enabled(port) != pd_enabled)
+		next_deadline[port] = 0;
+#endif
+
 	return true;
 }
 
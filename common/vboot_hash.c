@@ -36,6 +36,14 @@ struct vboot_hash_tag {
 #define CHUNK_SIZE 1024       /* Bytes to hash per deferred call */
 #define WORK_INTERVAL_US 100  /* Delay between deferred calls */
 
+/*
+ * Bytes to read per flash access when hashing in a single blocking call.
+ * Nothing else runs in between, so a bigger buffer can be held for the whole
+ * hash, amortizing the per-read overhead of SPI flash.  Falls back to
+ * CHUNK_SIZE if shared memory is short.
+ */
+#define BLOCKING_CHUNK_SIZE 4096
+
 /* Check that CHUNK_SIZE fits in shared memory. */
 SHARED_MEM_CHECK_SIZE(CHUNK_SIZE);
 
@@ -45,6 +53,8 @@ static uint32_t curr_pos;
 static const uint8_t *hash;   /* Hash, or NULL if not valid */
 static int want_abort;
 static int in_progress;
+static timestamp_t hash_start_time;
+static uint32_t hash_time_us; /* Time to compute hash, or 0 if not valid */
 #define VBOOT_HASH_DEFERRED	true
 #define VBOOT_HASH_BLOCKING	false
 
@@ -67,6 +77,7 @@ void vboot_hash_abort(void)
 		want_abort = 0;
 		data_size = 0;
 		hash = NULL;
+		hash_time_us = 0;
 #ifdef CONFIG_SHA256_HW_ACCELERATE
 		SHA256_abort(&ctx);
 #endif
@@ -128,16 +139,50 @@ static void hash_next_chunk(size_t size)
 #endif
 }
 
+/**
+ * Store the final hash and how long it took to compute.
+ */
+static void vboot_hash_finish(void)
+{
+	hash = SHA256_final(&ctx);
+	hash_time_us = MAX(get_time().val - hash_start_time.val, 1);
+	CPRINTS("hash done %ph in %d us", HEX_BUF(hash, SHA256_PRINT_SIZE),
+		hash_time_us);
+}
+
 static void vboot_hash_all_chunks(void)
 {
-	do {
+#ifndef CONFIG_MAPPED_STORAGE
+	int buf_size = MIN(BLOCKING_CHUNK_SIZE, shared_mem_size());
+	char *buf;
+
+	if (data_size > CHUNK_SIZE &&
+	    shared_mem_acquire(buf_size, &buf) == EC_SUCCESS) {
+		while (curr_pos < data_size) {
+			size_t size = MIN(buf_size, data_size - curr_pos);
+
+			if (flash_read(data_offset + curr_pos, size, buf)) {
+				shared_mem_release(buf);
+				in_progress = 0;
+				clock_enable_module(MODULE_FAST_CPU, 0);
+				vboot_hash_abort();
+				return;
+			}
+			SHA256_update(&ctx, (const uint8_t *)buf, size);
+			curr_pos += size;
+		}
+
+		shared_mem_release(buf);
+	}
+#endif
+
+	while (curr_pos < data_size) {
 		size_t size = MIN(CHUNK_SIZE, data_size - curr_pos);
 		hash_next_chunk(size);
 		curr_pos += size;
-	} while (curr_pos < data_size);
+	}
 
-	hash = SHA256_final(&ctx);
-	CPRINTS("hash done %ph", HEX_BUF(hash, SHA256_PRINT_SIZE));
+	vboot_hash_finish();
 	in_progress = 0;
 	clock_enable_module(MODULE_FAST_CPU, 0);
 
@@ -166,8 +211,7 @@ static void vboot_hash_next_chunk(void)
 	curr_pos += size;
 	if (curr_pos >= data_size) {
 		/* Store the final hash */
-		hash = SHA256_final(&ctx);
-		CPRINTS("hash done %ph", HEX_BUF(hash, SHA256_PRINT_SIZE));
+		vboot_hash_finish();
 
 		in_progress = 0;
 
@@ -222,6 +266,8 @@ static int vboot_hash_start(uint32_t offset, uint32_t size,
 	data_size = size;
 	curr_pos = 0;
 	hash = NULL;
+	hash_time_us = 0;
+	hash_start_time = get_time();
 	want_abort = 0;
 	in_progress = 1;
 
@@ -383,6 +429,10 @@ static int command_hash(int argc, char **argv)
 			ccprintf("%ph\n", HEX_BUF(hash, SHA256_DIGEST_SIZE));
 		else
 			ccprintf("(invalid)\n");
+		if (hash && hash_time_us && data_size)
+			ccprintf("Time:   %d us (%d us/MB)\n", hash_time_us,
+				 (int)((uint64_t)hash_time_us * (1024 * 1024) /
+				       data_size));
 
 		return EC_SUCCESS;
 	}
@@ -436,9 +486,19 @@ DECLARE_CONSOLE_COMMAND(hash, command_hash,
 /* Host commands */
 
 /* Fill in the response with the current hash status */
-static void fill_response(struct ec_response_vboot_hash *r,
+static void fill_response(struct host_cmd_handler_args *args,
 			  int request_offset)
 {
+	struct ec_response_vboot_hash_v1 *r1 = args->response;
+	struct ec_response_vboot_hash *r = &r1->hash;
+
+	if (args->version > 0) {
+		r1->hash_time_us = 0;
+		args->response_size = sizeof(*r1);
+	} else {
+		args->response_size = sizeof(*r);
+	}
+
 	if (in_progress)
 		r->status = EC_VBOOT_HASH_STATUS_BUSY;
 	else if (get_offset(request_offset) == data_offset && hash &&
@@ -451,6 +511,8 @@ static void fill_response(struct ec_response_vboot_hash *r,
 		r->size = data_size;
 		ASSERT(SHA256_DIGEST_SIZE < sizeof(r->hash_digest));
 		memcpy(r->hash_digest, hash, SHA256_DIGEST_SIZE);
+		if (args->version > 0)
+			r1->hash_time_us = hash_time_us;
 	} else
 		r->status = EC_VBOOT_HASH_STATUS_NONE;
 }
@@ -494,17 +556,15 @@ static enum ec_status
 host_command_vboot_hash(struct host_cmd_handler_args *args)
 {
 	const struct ec_params_vboot_hash *p = args->params;
-	struct ec_response_vboot_hash *r = args->response;
 	int rv;
 
 	switch (p->cmd) {
 	case EC_VBOOT_HASH_GET:
 		if (p->offset || p->size)
-			fill_response(r, p->offset);
+			fill_response(args, p->offset);
 		else
-			fill_response(r, data_offset);
+			fill_response(args, data_offset);
 
-		args->response_size = sizeof(*r);
 		return EC_RES_SUCCESS;
 
 	case EC_VBOOT_HASH_ABORT:
@@ -522,8 +582,7 @@ host_command_vboot_hash(struct host_cmd_handler_args *args)
 			while (in_progress)
 				usleep(1000);
 
-		fill_response(r, p->offset);
-		args->response_size = sizeof(*r);
+		fill_response(args, p->offset);
 		return EC_RES_SUCCESS;
 
 	default:
@@ -532,4 +591,4 @@ host_command_vboot_hash(struct host_cmd_handler_args *args)
 }
 DECLARE_HOST_COMMAND(EC_CMD_VBOOT_HASH,
 		     host_command_vboot_hash,
-		     EC_VER_MASK(0));
+		     EC_VER_MASK(0) | EC_VER_MASK(1));
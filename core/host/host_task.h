@@ -23,6 +23,13 @@ pthread_t task_get_thread(task_id_t tskid);
  */
 task_id_t task_get_running(void);
 
+/**
+ * In coroutine mode, if the calling thread is running the scheduler rather
+ * than task tskid, switches to tskid so that it dumps its own stack trace and
+ * exits. Returns in all other cases.
+ */
+void task_resume_for_trace(task_id_t tskid);
+
 /**
  * Initializes the interrupt semaphore and associates a signal handler with
  * SIGNAL_INTERRUPT.
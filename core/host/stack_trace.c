@@ -81,9 +81,16 @@ static void __attribute__((noinline)) _task_dump_trace_dispatch(int sig)
 				running, task_get_name(running));
 	}
 
-	if (need_dispatch) {
+	/*
+	 * Coroutine tasks run on this very thread. If it is in the scheduler,
+	 * have the task dump its own saved stack instead, else dump directly.
+	 */
+	if (need_dispatch &&
+	    !pthread_equal(task_get_thread(running), pthread_self())) {
 		pthread_kill(task_get_thread(running), SIGNAL_TRACE_DUMP);
 	} else {
+		if (need_dispatch && !in_interrupt_context())
+			task_resume_for_trace(running);
 		_task_dump_trace_impl(SIGNAL_TRACE_OFFSET);
 		exit(1);
 	}
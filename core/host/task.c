@@ -13,6 +13,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
 
 #include "atomic.h"
 #include "common.h"
@@ -22,14 +24,26 @@
 #include "task_id.h"
 #include "test_util.h"
 #include "timer.h"
+#include "util.h"
 
 #define SIGNAL_INTERRUPT SIGUSR1
 
+/* Stack of each task in coroutine mode, only touched pages are committed */
+#define COROUTINE_STACK_SIZE (8 * 1024 * 1024)
+
 struct emu_task_t {
+	/* Thread mode */
 	pthread_t thread;
 	pthread_cond_t resume;
+	/* Coroutine mode */
+	ucontext_t context;
+	void *stack;
+	uint8_t created;
+
 	uint32_t event;
 	timestamp_t wake_time;
+	/* Position in wake_heap, or -1 if wake_time is not set */
+	int heap_index;
 	uint8_t started;
 };
 
@@ -44,6 +58,23 @@ static pthread_mutex_t run_lock;
 static task_id_t running_task_id;
 static int task_started;
 
+/*
+ * By default, all tasks run as coroutines on the thread that called
+ * task_start(), and switching task is a user space context swap. Setting
+ * EC_TASK_THREADS=1 in the environment runs each task on its own thread
+ * instead, handing over with condition variables. Fuzzers and sanitizer
+ * builds always use threads: ASan and MSan do not track swapcontext() stack
+ * switches, and report bogus errors on coroutine stacks.
+ */
+static int use_threads;
+static volatile sig_atomic_t trace_on_resume;
+static pthread_t scheduler_thread;
+static ucontext_t scheduler_context;
+
+/* Tasks with a wake time, as a min-heap on (wake_time, task id) */
+static task_id_t wake_heap[TASK_ID_COUNT];
+static int wake_heap_size;
+
 static sem_t interrupt_sem;
 static pthread_mutex_t interrupt_lock;
 static pthread_t interrupt_thread;
@@ -164,7 +195,8 @@ void task_trigger_test_interrupt(void (*isr)(void))
 	/* Suspend current task and excute ISR */
 	pending_isr = isr;
 	if (task_started) {
-		pthread_kill(tasks[running_task_id].thread, SIGNAL_INTERRUPT);
+		pthread_kill(task_get_thread(running_task_id),
+			     SIGNAL_INTERRUPT);
 	} else {
 		main_pid = getpid();
 		kill(main_pid, SIGNAL_INTERRUPT);
@@ -195,6 +227,8 @@ const char *task_get_name(task_id_t tskid)
 
 pthread_t task_get_thread(task_id_t tskid)
 {
+	if (!use_threads)
+		return scheduler_thread;
 	return tasks[tskid].thread;
 }
 
@@ -211,17 +245,140 @@ uint32_t *task_get_event_bitmap(task_id_t tskid)
 	return &tasks[tskid].event;
 }
 
+static int wake_heap_before(task_id_t a, task_id_t b)
+{
+	if (tasks[a].wake_time.val != tasks[b].wake_time.val)
+		return tasks[a].wake_time.val < tasks[b].wake_time.val;
+	/* On a tie, wake the lowest task id first. */
+	return a < b;
+}
+
+static void wake_heap_swap(int i, int j)
+{
+	task_id_t t = wake_heap[i];
+
+	wake_heap[i] = wake_heap[j];
+	wake_heap[j] = t;
+	tasks[wake_heap[i]].heap_index = i;
+	tasks[wake_heap[j]].heap_index = j;
+}
+
+static void wake_heap_fix(int i)
+{
+	int parent, child;
+
+	while (i > 0) {
+		parent = (i - 1) / 2;
+		if (!wake_heap_before(wake_heap[i], wake_heap[parent]))
+			break;
+		wake_heap_swap(i, parent);
+		i = parent;
+	}
+
+	while ((child = 2 * i + 1) < wake_heap_size) {
+		if (child + 1 < wake_heap_size &&
+		    wake_heap_before(wake_heap[child + 1], wake_heap[child]))
+			child++;
+		if (!wake_heap_before(wake_heap[child], wake_heap[i]))
+			break;
+		wake_heap_swap(i, child);
+		i = child;
+	}
+}
+
+/* Set the wake time of a task, ~0 meaning it has none. */
+static void task_set_wake_time(task_id_t tid, uint64_t wake_time)
+{
+	int i = tasks[tid].heap_index;
+
+	tasks[tid].wake_time.val = wake_time;
+
+	if (wake_time == ~0ull) {
+		if (i < 0)
+			return;
+		tasks[tid].heap_index = -1;
+		if (i == --wake_heap_size)
+			return;
+		wake_heap[i] = wake_heap[wake_heap_size];
+		tasks[wake_heap[i]].heap_index = i;
+	} else if (i < 0) {
+		i = wake_heap_size++;
+		wake_heap[i] = tid;
+		tasks[tid].heap_index = i;
+	}
+	wake_heap_fix(i);
+}
+
+/*
+ * Give control back to the scheduler, and return once the scheduler has
+ * picked this task again.
+ */
+static void task_yield_to_scheduler(task_id_t tid)
+{
+	if (use_threads) {
+		pthread_cond_signal(&scheduler_cond);
+		pthread_cond_wait(&tasks[tid].resume, &run_lock);
+	} else {
+		swapcontext(&tasks[tid].context, &scheduler_context);
+		/* Resumed by task_resume_for_trace() rather than the scheduler */
+		if (trace_on_resume) {
+			task_dump_trace();
+			exit(1);
+		}
+	}
+}
+
+/*
+ * Run a task from the scheduler, and return once it has called
+ * task_wait_event().
+ */
+static void task_run(task_id_t tid)
+{
+	if (use_threads) {
+		pthread_cond_signal(&tasks[tid].resume);
+		pthread_cond_wait(&scheduler_cond, &run_lock);
+	} else {
+		my_task_id = tid;
+		swapcontext(&scheduler_context, &tasks[tid].context);
+		my_task_id = TASK_ID_INVALID;
+	}
+}
+
+void task_resume_for_trace(task_id_t tskid)
+{
+	char *stack = tasks[tskid].stack;
+	char *sp = (char *)&stack;
+
+	if (use_threads || !tasks[tskid].started)
+		return;
+
+	/*
+	 * Check the stack rather than my_task_id, which task_run() sets just
+	 * before the swap: the signal is usually delivered in swapcontext().
+	 */
+	if (sp >= stack && sp < stack + COROUTINE_STACK_SIZE)
+		return;
+
+	/*
+	 * This thread is in the scheduler, and tskid is parked in
+	 * task_yield_to_scheduler(). Jump back there, so that the trace is
+	 * taken on the task's own stack. We never come back.
+	 */
+	trace_on_resume = 1;
+	my_task_id = tskid;
+	setcontext(&tasks[tskid].context);
+}
+
 uint32_t task_wait_event(int timeout_us)
 {
 	int tid = task_get_current();
 	int ret;
 	pthread_mutex_lock(&interrupt_lock);
 	if (timeout_us > 0)
-		tasks[tid].wake_time.val = get_time().val + timeout_us;
+		task_set_wake_time(tid, get_time().val + timeout_us);
 
 	/* Transfer control to scheduler */
-	pthread_cond_signal(&scheduler_cond);
-	pthread_cond_wait(&tasks[tid].resume, &run_lock);
+	task_yield_to_scheduler(tid);
 
 	/* Resume */
 	ret = atomic_clear(&tasks[tid].event);
@@ -356,19 +513,10 @@ void wait_for_task_started_nosleep(void)
 
 static task_id_t task_get_next_wake(void)
 {
-	int i;
-	timestamp_t min_time;
-	int which_task = TASK_ID_INVALID;
-
-	min_time.val = ~0ull;
-
-	for (i = TASK_ID_COUNT - 1; i >= 0; --i)
-		if (min_time.val >= tasks[i].wake_time.val) {
-			min_time.val = tasks[i].wake_time.val;
-			which_task = i;
-		}
+	if (!wake_heap_size)
+		return TASK_ID_INVALID;
 
-	return which_task;
+	return wake_heap[0];
 }
 
 static int fast_forward(void)
@@ -398,7 +546,7 @@ static int fast_forward(void)
 		return TASK_ID_IDLE;
 
 	if (task_id != TASK_ID_INVALID &&
-	    tasks[task_id].thread != (pthread_t)NULL &&
+	    tasks[task_id].created &&
 	    tasks[task_id].wake_time.val < generator_sleep_deadline.val) {
 		force_time(tasks[task_id].wake_time);
 		return task_id;
@@ -424,11 +572,8 @@ void task_scheduler(void)
 		now = get_time();
 		i = TASK_ID_COUNT - 1;
 		while (i >= 0) {
-			/*
-			 * Only tasks with spawned threads are valid to be
-			 * resumed.
-			 */
-			if (tasks[i].thread) {
+			/* Only tasks already created can be resumed. */
+			if (tasks[i].created) {
 				if (tasks[i].event ||
 				    now.val >= tasks[i].wake_time.val)
 					break;
@@ -441,20 +586,16 @@ void task_scheduler(void)
 		now = get_time();
 		if (now.val >= tasks[i].wake_time.val)
 			tasks[i].event |= TASK_EVENT_TIMER;
-		tasks[i].wake_time.val = ~0ull;
+		task_set_wake_time(i, ~0ull);
 		running_task_id = i;
 		tasks[i].started = 1;
-		pthread_cond_signal(&tasks[i].resume);
-		pthread_cond_wait(&scheduler_cond, &run_lock);
+		task_run(i);
 	}
 }
 
-void *_task_start_impl(void *a)
+static void _task_run_routine(task_id_t tid)
 {
-	long tid = (long)a;
 	const struct task_args *arg = task_info + tid;
-	my_task_id = tid;
-	pthread_mutex_lock(&run_lock);
 
 	/* Wait for scheduler */
 	task_wait_event(1);
@@ -468,6 +609,56 @@ void *_task_start_impl(void *a)
 		task_wait_event(-1);
 }
 
+void *_task_start_impl(void *a)
+{
+	long tid = (long)a;
+	my_task_id = tid;
+	pthread_mutex_lock(&run_lock);
+
+	_task_run_routine(tid);
+	return NULL;
+}
+
+static void _task_start_coroutine(int tid)
+{
+	_task_run_routine(tid);
+}
+
+/*
+ * Create a task. It does not run until the scheduler hands control to it
+ * with task_run().
+ */
+static void task_create(task_id_t tid)
+{
+	tasks[tid].event = TASK_EVENT_WAKE;
+	tasks[tid].wake_time.val = ~0ull;
+	tasks[tid].heap_index = -1;
+	tasks[tid].started = 0;
+	tasks[tid].created = 1;
+
+	if (use_threads) {
+		pthread_cond_init(&tasks[tid].resume, NULL);
+		pthread_create(&tasks[tid].thread, NULL, _task_start_impl,
+			       (void *)(uintptr_t)tid);
+		return;
+	}
+
+	tasks[tid].stack = mmap(NULL, COROUTINE_STACK_SIZE,
+				PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE |
+				MAP_STACK, -1, 0);
+	ASSERT(tasks[tid].stack != MAP_FAILED);
+	/* Guard page, so that a stack overflow faults instead of corrupting */
+	mprotect(tasks[tid].stack, 1, PROT_NONE);
+
+	getcontext(&tasks[tid].context);
+	tasks[tid].context.uc_stack.ss_sp = tasks[tid].stack;
+	tasks[tid].context.uc_stack.ss_size = COROUTINE_STACK_SIZE;
+	tasks[tid].context.uc_link = NULL;
+	makecontext(&tasks[tid].context, (void (*)(void))_task_start_coroutine,
+		    1, (int)tid);
+}
+
 test_mockable void interrupt_generator(void)
 {
 	has_interrupt_generator = 0;
@@ -484,6 +675,14 @@ int task_start(void)
 {
 	int i = TASK_ID_HOOKS;
 
+#if defined(TEST_FUZZ) || defined(TEST_ASAN) || defined(TEST_MSAN)
+	use_threads = 1;
+#else
+	use_threads = getenv("EC_TASK_THREADS") != NULL &&
+		      strcmp(getenv("EC_TASK_THREADS"), "0") != 0;
+#endif
+	scheduler_thread = pthread_self();
+
 	pthread_mutex_init(&run_lock, NULL);
 	pthread_mutex_init(&interrupt_lock, NULL);
 	pthread_cond_init(&scheduler_cond, NULL);
@@ -494,13 +693,8 @@ int task_start(void)
 	 * Initialize the hooks task first.  After its init, it will callback to
 	 * enable the remaining tasks.
 	 */
-	tasks[i].event = TASK_EVENT_WAKE;
-	tasks[i].wake_time.val = ~0ull;
-	tasks[i].started = 0;
-	pthread_cond_init(&tasks[i].resume, NULL);
-	pthread_create(&tasks[i].thread, NULL, _task_start_impl,
-		       (void *)(uintptr_t)i);
-	pthread_cond_wait(&scheduler_cond, &run_lock);
+	task_create(i);
+	task_run(i);
 	/*
 	 * Interrupt lock is grabbed by the task which just started.
 	 * Let's unlock it so the next task can be started.
@@ -520,8 +714,7 @@ int task_start(void)
 	 * Tell the hooks task to continue so that it can call back to enable
 	 * the other tasks.
 	 */
-	pthread_cond_signal(&tasks[i].resume);
-	pthread_cond_wait(&scheduler_cond, &run_lock);
+	task_run(i);
 	task_enable_all_tasks_callback();
 
 	task_scheduler();
@@ -535,21 +728,16 @@ static void task_enable_all_tasks_callback(void)
 
 	/* Initialize the remaning tasks. */
 	for (i = 0; i < TASK_ID_COUNT; ++i) {
-		if (tasks[i].thread != (pthread_t)NULL)
+		if (tasks[i].created)
 			continue;
 
-		tasks[i].event = TASK_EVENT_WAKE;
-		tasks[i].wake_time.val = ~0ull;
-		tasks[i].started = 0;
-		pthread_cond_init(&tasks[i].resume, NULL);
-		pthread_create(&tasks[i].thread, NULL, _task_start_impl,
-			       (void *)(uintptr_t)i);
+		task_create(i);
 		/*
 		 * Interrupt lock is grabbed by the task which just started.
 		 * Let's unlock it so the next task can be started.
 		 */
 		pthread_mutex_unlock(&interrupt_lock);
-		pthread_cond_wait(&scheduler_cond, &run_lock);
+		task_run(i);
 	}
 
 }
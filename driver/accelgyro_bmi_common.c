@@ -14,6 +14,7 @@
 #include "driver/accelgyro_bmi_common.h"
 #include "driver/mag_bmm150.h"
 #include "driver/mag_lis2mdl.h"
+#include "hwtimer.h"
 #include "i2c.h"
 #include "math_util.h"
 #include "motion_sense_fifo.h"
@@ -381,6 +382,14 @@ void bmi_normalize(const struct motion_sensor_t *s, intv3_t v, uint8_t *input)
 		v[i] = SENSOR_APPLY_SCALE(v[i], data->scale[i]);
 }
 
+/*
+ * Vectors decoded out of one FIFO read, staged all at once when the whole
+ * buffer has been parsed. Every vector uses at least 6 bytes of the buffer.
+ */
+static struct ec_response_motion_sensor_data
+	bmi_batch[CONFIG_ACCEL_FIFO_READ_SIZE / 6];
+static int bmi_batch_count;
+
 int bmi_decode_header(struct motion_sensor_t *accel,
 		enum fifo_header hdr, uint32_t last_ts,
 		uint8_t **bp, uint8_t *ep)
@@ -417,8 +426,7 @@ int bmi_decode_header(struct motion_sensor_t *accel,
 				vector.data[Y] = v[Y];
 				vector.data[Z] = v[Z];
 				vector.sensor_num = s - motion_sensors;
-				motion_sense_fifo_stage_data(&vector, s, 3,
-						last_ts);
+				bmi_batch[bmi_batch_count++] = vector;
 				*bp += (i == MOTIONSENSE_TYPE_MAG ? 8 : 6);
 			}
 		}
@@ -436,8 +444,7 @@ enum fifo_state {
 	FIFO_DATA_CONFIG,
 };
 
-#define BMI_FIFO_BUFFER 64
-static uint8_t bmi_buffer[BMI_FIFO_BUFFER];
+static uint8_t bmi_buffer[CONFIG_ACCEL_FIFO_READ_SIZE];
 
 int bmi_load_fifo(struct motion_sensor_t *s, uint32_t last_ts)
 {
@@ -447,7 +454,8 @@ int bmi_load_fifo(struct motion_sensor_t *s, uint32_t last_ts)
 	uint8_t *bp = bmi_buffer;
 	uint8_t *ep;
 	uint32_t beginning;
-
+	uint32_t start = __hw_clock_source_read();
+	int ret = EC_SUCCESS;
 
 	if (s->type != MOTIONSENSE_TYPE_ACCEL)
 		return EC_SUCCESS;
@@ -494,6 +502,7 @@ int bmi_load_fifo(struct motion_sensor_t *s, uint32_t last_ts)
 
 	bmi_read_n(s->port, s->i2c_spi_addr_flags,
 		   BMI_FIFO_DATA(V(s)), bmi_buffer, length);
+	bmi_batch_count = 0;
 	beginning = *(uint32_t *)bmi_buffer;
 	ep = bmi_buffer + length;
 	/*
@@ -513,7 +522,6 @@ int bmi_load_fifo(struct motion_sensor_t *s, uint32_t last_ts)
 		return EC_SUCCESS;
 	}
 
-
 	while (bp < ep) {
 		switch (state) {
 		case FIFO_HEADER: {
@@ -525,7 +533,7 @@ int bmi_load_fifo(struct motion_sensor_t *s, uint32_t last_ts)
 			hdr &= 0xdc;
 			switch (hdr) {
 			case BMI_FH_EMPTY:
-				return EC_SUCCESS;
+				goto out;
 			case BMI_FH_SKIP:
 				state = FIFO_DATA_SKIP;
 				break;
@@ -541,7 +549,8 @@ int bmi_load_fifo(struct motion_sensor_t *s, uint32_t last_ts)
 				bmi_write8(s->port, s->i2c_spi_addr_flags,
 						BMI_CMD_REG(V(s)),
 						BMI_CMD_FIFO_FLUSH);
-				return EC_ERROR_NOT_HANDLED;
+				ret = EC_ERROR_NOT_HANDLED;
+				goto out;
 			}
 			break;
 		}
@@ -577,7 +586,11 @@ int bmi_load_fifo(struct motion_sensor_t *s, uint32_t last_ts)
 		}
 	}
 
-	return EC_SUCCESS;
+out:
+	motion_sense_fifo_stage_batch(bmi_batch, bmi_batch_count, last_ts);
+	motion_sense_fifo_record_read(s, 2, sizeof(length) + length,
+				      __hw_clock_source_read() - start);
+	return ret;
 }
 
 int bmi_set_range(struct motion_sensor_t *s, int range, int rnd)
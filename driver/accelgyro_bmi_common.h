@@ -239,6 +239,8 @@ void bmi_normalize(const struct motion_sensor_t *s, intv3_t v, uint8_t *input);
 /*
  * Decode the header from the fifo.
  * Return 0 if we need further processing.
+ * Decoded vectors are batched and staged by bmi_load_fifo() once the whole
+ * buffer has been parsed.
  * Sensor mutex must be held during processing, to protect the fifos.
  *
  * @accel: base sensor
@@ -258,8 +260,8 @@ int bmi_decode_header(struct motion_sensor_t *accel,
  * @s: Pointer to sensor data.
  * @last_ts: The last timestamp of fifo interrupt.
  *
- * Read only up to  bmi_buffer. If more reads are needed, we will be called
- * again by the interrupt routine.
+ * Read only up to CONFIG_ACCEL_FIFO_READ_SIZE bytes. If more reads are
+ * needed, we will be called again by the interrupt routine.
  *
  * NOTE: If a new driver supports this function, be sure to add a check
  * for spoof_mode in order to load the sensor stack with the spoofed
@@ -162,32 +162,37 @@ out_unlock:
 	return ret;
 }
 
-static void __maybe_unused icm426xx_push_fifo_data(struct motion_sensor_t *s,
-						const uint8_t *raw, uint32_t ts)
+static int __maybe_unused icm426xx_push_fifo_data(struct motion_sensor_t *s,
+			const uint8_t *raw,
+			struct ec_response_motion_sensor_data *vect)
 {
 	intv3_t v;
-	struct ec_response_motion_sensor_data vect;
 	int ret;
 
 	if (s == NULL)
-		return;
+		return 0;
 
 	ret = icm426xx_normalize(s, v, raw);
-	if (ret == EC_SUCCESS) {
-		vect.data[X] = v[X];
-		vect.data[Y] = v[Y];
-		vect.data[Z] = v[Z];
-		vect.flags = 0;
-		vect.sensor_num = s - motion_sensors;
-		motion_sense_fifo_stage_data(&vect, s, 3, ts);
-	}
+	if (ret != EC_SUCCESS)
+		return 0;
+
+	vect->data[X] = v[X];
+	vect->data[Y] = v[Y];
+	vect->data[Z] = v[Z];
+	vect->flags = 0;
+	vect->sensor_num = s - motion_sensors;
+	return 1;
 }
 
 static int __maybe_unused icm426xx_load_fifo(struct motion_sensor_t *s,
 					     uint32_t ts)
 {
+	/* Every FIFO packet is at least 8 bytes long. */
+	static struct ec_response_motion_sensor_data
+		batch[CONFIG_ACCEL_FIFO_READ_SIZE / 8];
 	struct icm_drv_data_t *st = ICM_GET_DATA(s);
-	int count, i, size;
+	uint32_t start = __hw_clock_source_read();
+	int count, i, size, n = 0;
 	const uint8_t *accel, *gyro;
 	int ret;
 
@@ -216,15 +221,23 @@ static int __maybe_unused icm426xx_load_fifo(struct motion_sensor_t *s,
 		size = icm_fifo_decode_packet(&st->fifo_buffer[i],
 				&accel, &gyro);
 		/* exit if error or FIFO is empty */
-		if (size <= 0)
-			return -size;
+		if (size <= 0) {
+			ret = -size;
+			break;
+		}
 		if (accel != NULL)
-			icm426xx_push_fifo_data(st->accel, accel, ts);
+			n += icm426xx_push_fifo_data(st->accel, accel,
+						     &batch[n]);
 		if (gyro != NULL)
-			icm426xx_push_fifo_data(st->gyro, gyro, ts);
+			n += icm426xx_push_fifo_data(st->gyro, gyro,
+						     &batch[n]);
 	}
 
-	return EC_SUCCESS;
+	motion_sense_fifo_stage_batch(batch, n, ts);
+	motion_sense_fifo_record_read(s, 2, sizeof(uint16_t) + count,
+				      __hw_clock_source_read() - start);
+
+	return ret;
 }
 
 #ifdef CONFIG_ACCEL_INTERRUPTS
@@ -11,8 +11,7 @@
 #include "accelgyro.h"
 
 #ifdef CONFIG_ACCEL_FIFO
-/* reserve maximum 4 samples of 16 bytes */
-#define ICM_FIFO_BUFFER	64
+#define ICM_FIFO_BUFFER	CONFIG_ACCEL_FIFO_READ_SIZE
 #else
 #define ICM_FIFO_BUFFER	0
 #endif
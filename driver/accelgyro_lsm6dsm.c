@@ -318,17 +318,20 @@ static int fifo_next(struct lsm6dsm_data *private)
 }
 
 /**
- * push_fifo_data - Scan data pattern and push upside
+ * decode_fifo_data - Scan data pattern and decode the vectors to push upside
+ *
+ * Returns the number of vectors written in batch.
  */
-static void push_fifo_data(struct motion_sensor_t *accel, uint8_t *fifo,
-			   uint16_t flen,
-			   uint32_t timestamp)
+static int decode_fifo_data(struct motion_sensor_t *accel, uint8_t *fifo,
+			    uint16_t flen,
+			    struct ec_response_motion_sensor_data *batch)
 {
 	struct motion_sensor_t *s;
 	struct lsm6dsm_data *private = LSM6DSM_GET_DATA(accel);
+	int n = 0;
 
 	while (flen > 0) {
-		struct ec_response_motion_sensor_data vect;
+		struct ec_response_motion_sensor_data *vect = &batch[n];
 		int id;
 		int *axis;
 		int next_fifo = fifo_next(private);
@@ -338,7 +341,7 @@ static void push_fifo_data(struct motion_sensor_t *accel, uint8_t *fifo,
 		 * required here.
 		 */
 		if (next_fifo == FIFO_DEV_INVALID) {
-			return;
+			return n;
 		}
 
 		id = get_sensor_type(next_fifo);
@@ -358,25 +361,29 @@ static void push_fifo_data(struct motion_sensor_t *accel, uint8_t *fifo,
 			}
 
 
-			vect.data[X] = axis[X];
-			vect.data[Y] = axis[Y];
-			vect.data[Z] = axis[Z];
+			vect->data[X] = axis[X];
+			vect->data[Y] = axis[Y];
+			vect->data[Z] = axis[Z];
 
-			vect.flags = 0;
-			vect.sensor_num = s - motion_sensors;
-			motion_sense_fifo_stage_data(&vect, s, 3, timestamp);
+			vect->flags = 0;
+			vect->sensor_num = s - motion_sensors;
+			n++;
 		}
 
 		fifo += OUT_XYZ_SIZE;
 		flen -= OUT_XYZ_SIZE;
 	}
+	return n;
 }
 
 static int load_fifo(struct motion_sensor_t *s, const struct fstatus *fsts,
 		     uint32_t *last_fifo_read_ts)
 {
+	static struct ec_response_motion_sensor_data
+		batch[FIFO_READ_LEN / OUT_XYZ_SIZE];
 	uint32_t interrupt_timestamp = last_interrupt_timestamp;
-	int err, left, length;
+	uint32_t start = __hw_clock_source_read();
+	int err, left, length, xfers = 0, bytes;
 	uint8_t fifo[FIFO_READ_LEN];
 
 	/* Reset the load_fifo_sensor_state so we can start a new read. */
@@ -389,6 +396,7 @@ static int load_fifo(struct motion_sensor_t *s, const struct fstatus *fsts,
 	left = fsts->len & LSM6DSM_FIFO_DIFF_MASK;
 	left *= sizeof(uint16_t);
 	left = (left / OUT_XYZ_SIZE) * OUT_XYZ_SIZE;
+	bytes = left;
 
 	/*
 	 * TODO(b/122912601): phaser360: Investigate Standard Deviation error
@@ -411,6 +419,7 @@ static int load_fifo(struct motion_sensor_t *s, const struct fstatus *fsts,
 		*last_fifo_read_ts = __hw_clock_source_read();
 		if (err != EC_SUCCESS)
 			return err;
+		xfers++;
 
 		/*
 		 * Manage patterns and push data. Data is pushed with the
@@ -420,11 +429,15 @@ static int load_fifo(struct motion_sensor_t *s, const struct fstatus *fsts,
 		 * reading the last sample and pushing it into the FIFO.
 		 */
 
-		push_fifo_data(s, fifo, length, interrupt_timestamp);
+		motion_sense_fifo_stage_batch(
+			batch, decode_fifo_data(s, fifo, length, batch),
+			interrupt_timestamp);
 		left -= length;
 	} while (left > 0);
 
 	motion_sense_fifo_commit_data();
+	motion_sense_fifo_record_read(s, xfers, bytes,
+				      __hw_clock_source_read() - start);
 
 	return EC_SUCCESS;
 }
@@ -342,6 +342,144 @@ int battery_get_avg_voltage(void)
 }
 #endif /* CONFIG_CMD_PWR_AVG */
 
+#ifdef CONFIG_BATTERY_SMART_CACHE
+/*
+ * Last value read for each battery_get_params() field.  Values that change
+ * slowly are only read again once older than their refresh period, so the
+ * charger loop doesn't wake the gas gauge for them every time.  A failed read
+ * drops every cached value, so a battery that stops answering isn't kept alive
+ * by stale data.
+ */
+static struct {
+	int value;
+	int valid;
+	timestamp_t read_at;
+	uint32_t period_ms;
+} batt_cache[CS_NUM_BATT_PARAMS] = {
+	[CS_BATT_TEMPERATURE] = { .period_ms = 5000 },
+	[CS_BATT_STATE_OF_CHARGE] = { .period_ms = 10000 },
+	[CS_BATT_REMAINING_CAPACITY] = { .period_ms = 10000 },
+	[CS_BATT_FULL_CAPACITY] = { .period_ms = 60000 },
+};
+
+int battery_cache_set_period(enum charge_state_batt_params field,
+			     uint32_t period_ms)
+{
+	if (field < 0 || field >= CS_NUM_BATT_PARAMS)
+		return EC_ERROR_INVAL;
+
+	batt_cache[field].period_ms = period_ms;
+	return EC_SUCCESS;
+}
+
+void battery_cache_invalidate(void)
+{
+	int i;
+
+	for (i = 0; i < CS_NUM_BATT_PARAMS; i++)
+		batt_cache[i].valid = 0;
+}
+
+enum ec_status battery_cache_get_param(uint32_t param, uint32_t *value)
+{
+	if (param >= CS_PARAM_BATT_AGE_MIN &&
+	    param < CS_PARAM_BATT_AGE_MIN + CS_NUM_BATT_PARAMS) {
+		int field = param - CS_PARAM_BATT_AGE_MIN;
+
+		if (batt_cache[field].valid)
+			*value = (get_time().val -
+				  batt_cache[field].read_at.val) / MSEC;
+		else
+			*value = CS_BATT_AGE_NEVER;
+		return EC_RES_SUCCESS;
+	}
+
+	if (param >= CS_PARAM_BATT_REFRESH_MIN &&
+	    param < CS_PARAM_BATT_REFRESH_MIN + CS_NUM_BATT_PARAMS) {
+		*value = batt_cache[param - CS_PARAM_BATT_REFRESH_MIN].period_ms;
+		return EC_RES_SUCCESS;
+	}
+
+	return EC_RES_INVALID_PARAM;
+}
+
+enum ec_status battery_cache_set_param(uint32_t param, uint32_t value)
+{
+	if (param >= CS_PARAM_BATT_AGE_MIN && param <= CS_PARAM_BATT_AGE_MAX)
+		return EC_RES_ACCESS_DENIED;
+
+	if (param < CS_PARAM_BATT_REFRESH_MIN ||
+	    battery_cache_set_period(param - CS_PARAM_BATT_REFRESH_MIN, value))
+		return EC_RES_INVALID_PARAM;
+
+	return EC_RES_SUCCESS;
+}
+#endif /* CONFIG_BATTERY_SMART_CACHE */
+
+/*
+ * Read one battery_get_params() field, or reuse it if still fresh.  Only reads
+ * that actually reached the battery and worked set *responded.
+ */
+static int battery_read_param(enum charge_state_batt_params field, int *value,
+			      int *responded)
+{
+	int rv;
+
+#ifdef CONFIG_BATTERY_SMART_CACHE
+	if (batt_cache[field].valid &&
+	    get_time().val - batt_cache[field].read_at.val <
+	    (uint64_t)batt_cache[field].period_ms * MSEC) {
+		*value = batt_cache[field].value;
+		return EC_SUCCESS;
+	}
+#endif
+
+	switch (field) {
+	case CS_BATT_TEMPERATURE:
+		rv = sb_read(SB_TEMPERATURE, value);
+		break;
+	case CS_BATT_STATE_OF_CHARGE:
+		rv = sb_read(SB_RELATIVE_STATE_OF_CHARGE, value);
+		break;
+	case CS_BATT_VOLTAGE:
+		rv = sb_read(SB_VOLTAGE, value);
+		break;
+	case CS_BATT_CURRENT:
+		rv = sb_read(SB_CURRENT, value);
+		break;
+	case CS_BATT_DESIRED_VOLTAGE:
+		rv = sb_read(SB_CHARGING_VOLTAGE, value);
+		break;
+	case CS_BATT_DESIRED_CURRENT:
+		rv = sb_read(SB_CHARGING_CURRENT, value);
+		break;
+	case CS_BATT_REMAINING_CAPACITY:
+		rv = battery_remaining_capacity(value);
+		break;
+	case CS_BATT_FULL_CAPACITY:
+		rv = battery_full_charge_capacity(value);
+		break;
+	case CS_BATT_STATUS:
+		rv = battery_status(value);
+		break;
+	default:
+		return EC_ERROR_INVAL;
+	}
+
+	if (rv) {
+		battery_cache_invalidate();
+		return rv;
+	}
+
+	*responded = 1;
+#ifdef CONFIG_BATTERY_SMART_CACHE
+	batt_cache[field].valid = 1;
+	batt_cache[field].value = *value;
+	batt_cache[field].read_at = get_time();
+#endif
+	return EC_SUCCESS;
+}
+
 static void apply_fake_state_of_charge(struct batt_params *batt)
 {
 	int full;
@@ -363,46 +501,55 @@ static void apply_fake_state_of_charge(struct batt_params *batt)
 void battery_get_params(struct batt_params *batt)
 {
 	struct batt_params batt_new = {0};
+	int responded = 0;
 	int v;
 
-	if (sb_read(SB_TEMPERATURE, &batt_new.temperature)
-			&& fake_temperature < 0)
+	if (battery_read_param(CS_BATT_TEMPERATURE, &batt_new.temperature,
+			       &responded) && fake_temperature < 0)
 		batt_new.flags |= BATT_FLAG_BAD_TEMPERATURE;
 
 	/* If temperature is faked, override with faked data */
 	if (fake_temperature >= 0)
 		batt_new.temperature = fake_temperature;
 
-	if (sb_read(SB_RELATIVE_STATE_OF_CHARGE, &batt_new.state_of_charge)
+	if (battery_read_param(CS_BATT_STATE_OF_CHARGE,
+			       &batt_new.state_of_charge, &responded)
 	    && fake_state_of_charge < 0)
 		batt_new.flags |= BATT_FLAG_BAD_STATE_OF_CHARGE;
 
-	if (sb_read(SB_VOLTAGE, &batt_new.voltage))
+	if (battery_read_param(CS_BATT_VOLTAGE, &batt_new.voltage, &responded))
 		batt_new.flags |= BATT_FLAG_BAD_VOLTAGE;
 
 	/* This is a signed 16-bit value. */
-	if (sb_read(SB_CURRENT, &v))
+	if (battery_read_param(CS_BATT_CURRENT, &v, &responded))
 		batt_new.flags |= BATT_FLAG_BAD_CURRENT;
 	else
 		batt_new.current = (int16_t)v;
 
-	if (sb_read(SB_CHARGING_VOLTAGE, &batt_new.desired_voltage))
+	if (battery_read_param(CS_BATT_DESIRED_VOLTAGE,
+			       &batt_new.desired_voltage, &responded))
 		batt_new.flags |= BATT_FLAG_BAD_DESIRED_VOLTAGE;
 
-	if (sb_read(SB_CHARGING_CURRENT, &batt_new.desired_current))
+	if (battery_read_param(CS_BATT_DESIRED_CURRENT,
+			       &batt_new.desired_current, &responded))
 		batt_new.flags |= BATT_FLAG_BAD_DESIRED_CURRENT;
 
-	if (battery_remaining_capacity(&batt_new.remaining_capacity))
+	if (battery_read_param(CS_BATT_REMAINING_CAPACITY,
+			       &batt_new.remaining_capacity, &responded))
 		batt_new.flags |= BATT_FLAG_BAD_REMAINING_CAPACITY;
 
-	if (battery_full_charge_capacity(&batt_new.full_capacity))
+	if (battery_read_param(CS_BATT_FULL_CAPACITY,
+			       &batt_new.full_capacity, &responded))
 		batt_new.flags |= BATT_FLAG_BAD_FULL_CAPACITY;
 
-	if (battery_status(&batt_new.status))
+	if (battery_read_param(CS_BATT_STATUS, &batt_new.status, &responded))
 		batt_new.flags |= BATT_FLAG_BAD_STATUS;
 
-	/* If any of those reads worked, the battery is responsive */
-	if ((batt_new.flags & BATT_FLAG_BAD_ANY) != BATT_FLAG_BAD_ANY)
+	/*
+	 * If any of those reads reached the battery and worked, the battery is
+	 * responsive.  Cached values don't count.
+	 */
+	if (responded)
 		batt_new.flags |= BATT_FLAG_RESPONSIVE;
 
 #ifdef CONFIG_BATTERY_MEASURE_IMBALANCE
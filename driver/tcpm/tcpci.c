@@ -114,6 +114,34 @@ static int tcpc_vbus[CONFIG_USB_PD_PORT_MAX_COUNT];
 /* Cached RP role values */
 static int cached_rp[CONFIG_USB_PD_PORT_MAX_COUNT];
 
+/*
+ * I2C cost of alert handling, reported by the tcpci_alerts console command.
+ * Bytes are the register address and data bytes of each successful transfer.
+ */
+struct tcpci_alert_stats {
+	uint32_t alerts;
+	uint32_t xfers;
+	uint32_t bytes;
+	uint32_t total_us;
+	uint32_t max_us;
+};
+STATIC_IF(CONFIG_CMD_TCPC_ALERT_STATS)
+	struct tcpci_alert_stats alert_stats[CONFIG_USB_PD_PORT_MAX_COUNT];
+
+/*
+ * Account for a transfer of the given size if it succeeded.  Returns rv, so
+ * it can wrap the transfer itself.
+ */
+static inline int alert_stats_xfer(int port, int bytes, int rv)
+{
+	if (IS_ENABLED(CONFIG_CMD_TCPC_ALERT_STATS) && rv == EC_SUCCESS) {
+		alert_stats[port].xfers++;
+		alert_stats[port].bytes += bytes;
+	}
+
+	return rv;
+}
+
 #ifdef CONFIG_USB_PD_TCPC_LOW_POWER
 int tcpc_addr_write(int port, int i2c_addr, int reg, int val)
 {
@@ -413,26 +441,12 @@ int tcpci_tcpc_debug_accessory(int port, bool enable)
 			    enable ? MASK_CLR : MASK_SET);
 }
 
-int tcpci_tcpm_get_cc(int port, enum tcpc_cc_voltage_status *cc1,
-	enum tcpc_cc_voltage_status *cc2)
+/* Work out the CC voltages from the ROLE CONTROL and CC STATUS values */
+static void tcpci_decode_cc(int port, int role, int status,
+			    enum tcpc_cc_voltage_status *cc1,
+			    enum tcpc_cc_voltage_status *cc2)
 {
-	int role;
-	int status;
 	int cc1_present_rd, cc2_present_rd;
-	int rv;
-
-	/* errors will return CC as open */
-	*cc1 = TYPEC_CC_VOLT_OPEN;
-	*cc2 = TYPEC_CC_VOLT_OPEN;
-
-	/* Get the ROLE CONTROL and CC STATUS values */
-	rv = tcpc_read(port, TCPC_REG_ROLE_CTRL, &role);
-	if (rv)
-		return rv;
-
-	rv = tcpc_read(port, TCPC_REG_CC_STATUS, &status);
-	if (rv)
-		return rv;
 
 	/* Get the current CC values from the CC STATUS */
 	*cc1 = TCPC_REG_CC_STATUS_CC1(status);
@@ -487,6 +501,29 @@ int tcpci_tcpm_get_cc(int port, enum tcpc_cc_voltage_status *cc1,
 		last_get_cc[port].cc_sts = status;
 		last_get_cc[port].role = role;
 	}
+}
+
+int tcpci_tcpm_get_cc(int port, enum tcpc_cc_voltage_status *cc1,
+	enum tcpc_cc_voltage_status *cc2)
+{
+	int role;
+	int status;
+	int rv;
+
+	/* errors will return CC as open */
+	*cc1 = TYPEC_CC_VOLT_OPEN;
+	*cc2 = TYPEC_CC_VOLT_OPEN;
+
+	/* Get the ROLE CONTROL and CC STATUS values */
+	rv = tcpc_read(port, TCPC_REG_ROLE_CTRL, &role);
+	if (rv)
+		return rv;
+
+	rv = tcpc_read(port, TCPC_REG_CC_STATUS, &status);
+	if (rv)
+		return rv;
+
+	tcpci_decode_cc(port, role, status, cc1, cc2);
 	return rv;
 }
 
@@ -666,12 +703,6 @@ static int tcpm_alert_status(int port, int *alert)
 	return tcpc_read16(port, TCPC_REG_ALERT, alert);
 }
 
-static int tcpm_alert_ext_status(int port, int *alert_ext)
-{
-	/* Read TCPC Extended Alert register */
-	return tcpc_read(port, TCPC_REG_ALERT_EXT, alert_ext);
-}
-
 static int tcpm_ext_status(int port, int *ext_status)
 {
 	/* Read TCPC Extended Status register */
@@ -736,7 +767,7 @@ struct cached_tcpm_message {
 static int tcpci_rev2_0_tcpm_get_message_raw(int port, uint32_t *payload,
 					     int *head)
 {
-	int rv = 0, cnt, reg = TCPC_REG_RX_BUFFER;
+	int rv = 0, xfer_rv, cnt, reg = TCPC_REG_RX_BUFFER;
 	int frm;
 	uint8_t tmp[2];
 	/*
@@ -766,8 +797,9 @@ static int tcpci_rev2_0_tcpm_get_message_raw(int port, uint32_t *payload,
 	}
 
 	/* The next two bytes are the header */
-	rv |= tcpc_xfer_unlocked(port, NULL, 0, (uint8_t *)head, 2,
-				cnt ? 0 : I2C_XFER_STOP);
+	xfer_rv = tcpc_xfer_unlocked(port, NULL, 0, (uint8_t *)head, 2,
+				     cnt ? 0 : I2C_XFER_STOP);
+	rv |= xfer_rv;
 
 	/* Encode message address in bits 31 to 28 */
 	*head &= 0x0000ffff;
@@ -775,14 +807,18 @@ static int tcpci_rev2_0_tcpm_get_message_raw(int port, uint32_t *payload,
 
 	/* Execute read and I2C_XFER_STOP, even if header read failed */
 	if (cnt > 0) {
-		tcpc_xfer_unlocked(port, NULL, 0, (uint8_t *)payload, cnt,
-				   I2C_XFER_STOP);
+		xfer_rv |= tcpc_xfer_unlocked(port, NULL, 0,
+					      (uint8_t *)payload, cnt,
+					      I2C_XFER_STOP);
 	}
+	alert_stats_xfer(port, 5 + cnt, xfer_rv);
 
 clear:
 	tcpc_lock(port, 0);
 	/* Read complete, clear RX status alert bit */
-	tcpc_write16(port, TCPC_REG_ALERT, TCPC_REG_ALERT_RX_STATUS);
+	alert_stats_xfer(port, 3,
+			 tcpc_write16(port, TCPC_REG_ALERT,
+				      TCPC_REG_ALERT_RX_STATUS));
 
 	if (rv)
 		return EC_ERROR_UNKNOWN;
@@ -794,9 +830,13 @@ static int tcpci_rev1_0_tcpm_get_message_raw(int port, uint32_t *payload,
 					     int *head)
 {
 	int rv, cnt, reg = TCPC_REG_RX_DATA;
-	int frm;
+	/* RX_BYTE_CNT, RX_BUF_FRAME_TYPE and RX_HDR, read as one block */
+	uint8_t rx[TCPC_REG_RX_DATA - TCPC_REG_RX_BYTE_CNT];
 
-	rv = tcpc_read(port, TCPC_REG_RX_BYTE_CNT, &cnt);
+	rv = alert_stats_xfer(port, 1 + sizeof(rx),
+			      tcpc_read_block(port, TCPC_REG_RX_BYTE_CNT, rx,
+					      sizeof(rx)));
+	cnt = rx[0];
 
 	/* RX_BYTE_CNT includes 3 bytes for frame type and header */
 	if (rv != EC_SUCCESS || cnt < 3) {
@@ -809,29 +849,22 @@ static int tcpci_rev1_0_tcpm_get_message_raw(int port, uint32_t *payload,
 		goto clear;
 	}
 
-	if (IS_ENABLED(CONFIG_USB_PD_DECODE_SOP)) {
-		rv = tcpc_read(port, TCPC_REG_RX_BUF_FRAME_TYPE, &frm);
-		if (rv != EC_SUCCESS) {
-			rv = EC_ERROR_UNKNOWN;
-			goto clear;
-		}
-	}
-
-	rv = tcpc_read16(port, TCPC_REG_RX_HDR, (int *)head);
+	*head = UINT16_FROM_BYTE_ARRAY_LE(rx, 2);
 
-	if (IS_ENABLED(CONFIG_USB_PD_DECODE_SOP)) {
+	if (IS_ENABLED(CONFIG_USB_PD_DECODE_SOP))
 		/* Encode message address in bits 31 to 28 */
-		*head &= 0x0000ffff;
-		*head |= PD_HEADER_SOP(frm);
-	}
+		*head |= PD_HEADER_SOP(rx[1]);
 
-	if (rv == EC_SUCCESS && cnt > 0) {
-		tcpc_read_block(port, reg, (uint8_t *)payload, cnt);
-	}
+	if (cnt > 0)
+		alert_stats_xfer(port, 1 + cnt,
+				 tcpc_read_block(port, reg, (uint8_t *)payload,
+						 cnt));
 
 clear:
 	/* Read complete, clear RX status alert bit */
-	tcpc_write16(port, TCPC_REG_ALERT, TCPC_REG_ALERT_RX_STATUS);
+	alert_stats_xfer(port, 3,
+			 tcpc_write16(port, TCPC_REG_ALERT,
+				      TCPC_REG_ALERT_RX_STATUS));
 
 	return rv;
 }
@@ -1008,30 +1041,54 @@ int tcpci_tcpm_transmit(int port, enum tcpm_transmit_type type,
 }
 
 /*
- * Returns true if TCPC has reset based on reading mask registers.
+ * ALERT through POWER_STATUS_MASK, read in one transfer at the start of each
+ * alert. The mask registers tell us whether the TCPC has reset.
  */
-static int register_mask_reset(int port)
-{
-	int mask;
+struct tcpci_alert_regs {
+	uint8_t alert[2];
+	uint8_t alert_mask[2];
+	uint8_t power_status_mask;
+} __packed;
+BUILD_ASSERT(offsetof(struct tcpci_alert_regs, alert_mask) ==
+	     TCPC_REG_ALERT_MASK - TCPC_REG_ALERT);
+BUILD_ASSERT(offsetof(struct tcpci_alert_regs, power_status_mask) ==
+	     TCPC_REG_POWER_STATUS_MASK - TCPC_REG_ALERT);
 
-	mask = 0;
-	tcpc_read16(port, TCPC_REG_ALERT_MASK, &mask);
-	if (mask == TCPC_REG_ALERT_MASK_ALL)
+/*
+ * CC_STATUS through ALERT_EXT, read in one transfer when any of the alert
+ * bits below says that one of them has news.
+ */
+struct tcpci_status_regs {
+	uint8_t cc_status;
+	uint8_t power_status;
+	uint8_t fault_status;
+	uint8_t ext_status;
+	uint8_t alert_ext;
+} __packed;
+BUILD_ASSERT(offsetof(struct tcpci_status_regs, alert_ext) ==
+	     TCPC_REG_ALERT_EXT - TCPC_REG_CC_STATUS);
+
+#define TCPC_REG_ALERT_STATUS_REGS (TCPC_REG_ALERT_CC_STATUS | \
+				    TCPC_REG_ALERT_POWER_STATUS | \
+				    TCPC_REG_ALERT_FAULT | \
+				    TCPC_REG_ALERT_EXT_STATUS | \
+				    TCPC_REG_ALERT_ALERT_EXT)
+
+/*
+ * Returns true if TCPC has reset based on the mask registers.
+ */
+static int register_mask_reset(const struct tcpci_alert_regs *regs)
+{
+	if (UINT16_FROM_BYTE_ARRAY_LE(regs->alert_mask, 0) ==
+	    TCPC_REG_ALERT_MASK_ALL)
 		return 1;
 
-	mask = 0;
-	tcpc_read(port, TCPC_REG_POWER_STATUS_MASK, &mask);
-	if (mask == TCPC_REG_POWER_STATUS_MASK_ALL)
+	if (regs->power_status_mask == TCPC_REG_POWER_STATUS_MASK_ALL)
 		return 1;
 
 	return 0;
 }
 
-static int tcpci_get_fault(int port, int *fault)
-{
-	return tcpc_read(port, TCPC_REG_FAULT_STATUS, fault);
-}
-
 static int tcpci_handle_fault(int port, int fault)
 {
 	int rv = EC_SUCCESS;
@@ -1065,14 +1122,23 @@ static int tcpci_clear_fault(int port, int fault)
 {
 	int rv;
 
-	rv = tcpc_write(port, TCPC_REG_FAULT_STATUS, fault);
+	rv = alert_stats_xfer(port, 2,
+			      tcpc_write(port, TCPC_REG_FAULT_STATUS, fault));
 	if (rv)
 		return rv;
 
-	return tcpc_write16(port, TCPC_REG_ALERT, TCPC_REG_ALERT_FAULT);
+	return alert_stats_xfer(port, 3,
+				tcpc_write16(port, TCPC_REG_ALERT,
+					     TCPC_REG_ALERT_FAULT));
 }
 
-static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
+/*
+ * status holds the registers already read for this alert, or is NULL to read
+ * them here.
+ */
+static void tcpci_check_vbus_changed(int port, int alert,
+				     const struct tcpci_status_regs *status,
+				     uint32_t *pd_event)
 {
 	/*
 	 * Check for VBus change
@@ -1083,7 +1149,10 @@ static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
 		int ext_status = 0;
 
 		/* Determine if Safe0V was detected */
-		tcpm_ext_status(port, &ext_status);
+		if (status)
+			ext_status = status->ext_status;
+		else
+			tcpm_ext_status(port, &ext_status);
 		if (ext_status & TCPC_REG_EXT_STATUS_SAFE0V)
 			/* Safe0V=1 and Present=0 */
 			tcpc_vbus[port] = BIT(VBUS_SAFE0V);
@@ -1093,7 +1162,10 @@ static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
 		int pwr_status = 0;
 
 		/* Determine reason for power status change */
-		tcpci_tcpm_get_power_status(port, &pwr_status);
+		if (status)
+			pwr_status = status->power_status;
+		else
+			tcpci_tcpm_get_power_status(port, &pwr_status);
 		if (pwr_status & TCPC_REG_POWER_STATUS_VBUS_PRES)
 			/* Safe0V=0 and Present=1 */
 			tcpc_vbus[port] = BIT(VBUS_PRESENT);
@@ -1111,18 +1183,23 @@ static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
 		}
 
 		if (IS_ENABLED(CONFIG_USB_PD_VBUS_DETECT_TCPC) &&
-		    IS_ENABLED(CONFIG_USB_CHARGER)) {
+		    IS_ENABLED(CONFIG_USB_CHARGER))
 			/* Update charge manager with new VBUS state */
 			usb_charger_vbus_change(port,
 				!!(tcpc_vbus[port] & BIT(VBUS_PRESENT)));
 
-			if (pd_event)
-				*pd_event |= TASK_EVENT_WAKE;
-		}
-
 		if (pwr_status & TCPC_REG_POWER_STATUS_VBUS_DET)
 			board_vbus_present_change();
 	}
+
+	/*
+	 * A tickless PD task would otherwise sleep through the new VBUS
+	 * state; the periodic one sees it on its next tick.
+	 */
+	if (IS_ENABLED(CONFIG_USB_PD_TICKLESS) &&
+	    IS_ENABLED(CONFIG_USB_PD_VBUS_DETECT_TCPC) && pd_event &&
+	    (alert & (TCPC_REG_ALERT_POWER_STATUS | TCPC_REG_ALERT_EXT_STATUS)))
+		*pd_event |= TASK_EVENT_WAKE;
 }
 
 /*
@@ -1131,29 +1208,62 @@ static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
  */
 #define MAX_ALLOW_FAILED_RX_READS 10
 
+static void alert_stats_done(int port, timestamp_t start)
+{
+	struct tcpci_alert_stats *stats = &alert_stats[port];
+	uint32_t us = get_time().val - start.val;
+
+	stats->alerts++;
+	stats->total_us += us;
+	stats->max_us = MAX(stats->max_us, us);
+}
+
 void tcpci_tcpc_alert(int port)
 {
-	int alert = 0;
+	struct tcpci_alert_regs regs;
+	struct tcpci_status_regs status = { 0 };
+	int alert;
 	int alert_ext = 0;
 	int failed_attempts;
 	uint32_t pd_event = 0;
+	timestamp_t start = { 0 };
 
-	/* Read the Alert register from the TCPC */
-	if (tcpm_alert_status(port, &alert)) {
+	if (IS_ENABLED(CONFIG_CMD_TCPC_ALERT_STATS))
+		start = get_time();
+
+	/* Read the Alert and mask registers from the TCPC */
+	if (alert_stats_xfer(port, 1 + sizeof(regs),
+			     tcpc_read_block(port, TCPC_REG_ALERT,
+					     (uint8_t *)&regs, sizeof(regs)))) {
 		CPRINTS("C%d: Failed to read alert register", port);
 		return;
 	}
+	alert = UINT16_FROM_BYTE_ARRAY_LE(regs.alert, 0);
+
+	/*
+	 * Get the status registers if needed. They sit next to each other, so
+	 * fetch them all at once rather than one transfer per alert bit.
+	 * Without them the alert can't be handled, so leave it asserted and
+	 * try again on the next interrupt rather than act on zeros.
+	 */
+	if ((alert & TCPC_REG_ALERT_STATUS_REGS) &&
+	    alert_stats_xfer(port, 1 + sizeof(status),
+			     tcpc_read_block(port, TCPC_REG_CC_STATUS,
+					     (uint8_t *)&status,
+					     sizeof(status)))) {
+		CPRINTS("C%d: Failed to read status registers", port);
+		return;
+	}
 
 	/* Get Extended Alert register if needed */
 	if (alert & TCPC_REG_ALERT_ALERT_EXT)
-		tcpm_alert_ext_status(port, &alert_ext);
+		alert_ext = status.alert_ext;
 
 	/* Clear any pending faults */
 	if (alert & TCPC_REG_ALERT_FAULT) {
-		int fault;
+		int fault = status.fault_status;
 
-		if (tcpci_get_fault(port, &fault) == EC_SUCCESS &&
-		    fault != 0 &&
+		if (fault != 0 &&
 		    tcpci_handle_fault(port, fault) == EC_SUCCESS &&
 		    tcpci_clear_fault(port, fault) == EC_SUCCESS)
 			CPRINTS("C%d FAULT 0x%02X handled", port, fault);
@@ -1174,7 +1284,7 @@ void tcpci_tcpc_alert(int port)
 	while (alert & TCPC_REG_ALERT_RX_STATUS) {
 		if (tcpm_enqueue_message(port))
 			++failed_attempts;
-		if (tcpm_alert_status(port, &alert))
+		if (alert_stats_xfer(port, 3, tcpm_alert_status(port, &alert)))
 			++failed_attempts;
 
 		/* Ensure we don't loop endlessly */
@@ -1188,6 +1298,8 @@ void tcpci_tcpc_alert(int port)
 			 */
 			pd_set_suspend(port, 1);
 			pd_deferred_resume(port);
+			if (IS_ENABLED(CONFIG_CMD_TCPC_ALERT_STATS))
+				alert_stats_done(port, start);
 			return;
 		}
 	}
@@ -1197,14 +1309,18 @@ void tcpci_tcpc_alert(int port)
 	 * is set if any bit of ALERT_EXTENDED is set.
 	 */
 	if (alert_ext)
-		tcpc_write(port, TCPC_REG_ALERT_EXT, alert_ext);
+		alert_stats_xfer(port, 2,
+				 tcpc_write(port, TCPC_REG_ALERT_EXT,
+					    alert_ext));
 	if (alert)
-		tcpc_write16(port, TCPC_REG_ALERT, alert);
+		alert_stats_xfer(port, 3,
+				 tcpc_write16(port, TCPC_REG_ALERT, alert));
 
 	if (alert & TCPC_REG_ALERT_CC_STATUS) {
 		if (IS_ENABLED(CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE)) {
-			enum tcpc_cc_voltage_status cc1;
-			enum tcpc_cc_voltage_status cc2;
+			enum tcpc_cc_voltage_status cc1 = TYPEC_CC_VOLT_OPEN;
+			enum tcpc_cc_voltage_status cc2 = TYPEC_CC_VOLT_OPEN;
+			int role;
 
 			/*
 			 * Some TCPCs generate CC Alerts when
@@ -1212,8 +1328,15 @@ void tcpci_tcpc_alert(int port)
 			 * is connected to the port. So, get the
 			 * CC line status and only generate a
 			 * PD_EVENT_CC if something is connected.
+			 * CC_STATUS was read with the other status
+			 * registers above.
 			 */
-			tcpci_tcpm_get_cc(port, &cc1, &cc2);
+			if (alert_stats_xfer(port, 2,
+					     tcpc_read(port,
+						       TCPC_REG_ROLE_CTRL,
+						       &role)) == EC_SUCCESS)
+				tcpci_decode_cc(port, role, status.cc_status,
+						&cc1, &cc2);
 			if (cc1 != TYPEC_CC_VOLT_OPEN ||
 			    cc2 != TYPEC_CC_VOLT_OPEN)
 				/* CC status cchanged, wake task */
@@ -1224,7 +1347,7 @@ void tcpci_tcpc_alert(int port)
 		}
 	}
 
-	tcpci_check_vbus_changed(port, alert, &pd_event);
+	tcpci_check_vbus_changed(port, alert, &status, &pd_event);
 
 	/* Check for Hard Reset received */
 	if (alert & TCPC_REG_ALERT_RX_HARD_RST) {
@@ -1248,12 +1371,15 @@ void tcpci_tcpc_alert(int port)
 		pd_got_frs_signal(port);
 
 	/*
-	 * Check registers to see if we can tell that the TCPC has reset. If
-	 * so, perform a tcpc_init.
+	 * Check the mask registers read above to see if we can tell that the
+	 * TCPC has reset. If so, perform a tcpc_init.
 	 */
-	if (register_mask_reset(port))
+	if (register_mask_reset(&regs))
 		pd_event |= PD_EVENT_TCPC_RESET;
 
+	if (IS_ENABLED(CONFIG_CMD_TCPC_ALERT_STATS))
+		alert_stats_done(port, start);
+
 	/*
 	 * Wait until all possible TCPC accesses in this function are complete
 	 * prior to setting events and/or waking the pd task. When the PD
@@ -1265,6 +1391,32 @@ void tcpci_tcpc_alert(int port)
 		task_set_event(PD_PORT_TO_TASK_ID(port), pd_event, 0);
 }
 
+#ifdef CONFIG_CMD_TCPC_ALERT_STATS
+static int command_tcpci_alerts(int argc, char **argv)
+{
+	int port;
+
+	for (port = 0; port < board_get_usb_pd_port_count(); port++) {
+		struct tcpci_alert_stats *stats = &alert_stats[port];
+
+		if (argc > 1 && !strcasecmp(argv[1], "reset")) {
+			memset(stats, 0, sizeof(*stats));
+			continue;
+		}
+
+		ccprintf("C%d: %u alerts, %u xfers, %u bytes, "
+			 "avg %u us, max %u us\n",
+			 port, stats->alerts, stats->xfers, stats->bytes,
+			 stats->alerts ? stats->total_us / stats->alerts : 0,
+			 stats->max_us);
+	}
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(tcpci_alerts, command_tcpci_alerts, "[reset]",
+			"Show the I2C cost of TCPC alert handling");
+#endif
+
 /*
  * This call will wake up the TCPC if it is in low power mode upon accessing the
  * i2c bus (but the pd state machine should put it back into low power mode).
@@ -1432,7 +1584,7 @@ int tcpci_tcpm_init(int port)
 	 */
 	tcpci_check_vbus_changed(port,
 		TCPC_REG_ALERT_POWER_STATUS | TCPC_REG_ALERT_EXT_STATUS,
-		NULL);
+		NULL, NULL);
 
 	error = init_alert_mask(port);
 	if (error)
@@ -96,6 +96,14 @@ class Spower(object):
   CMD_START   = 0x0003
   CMD_NEXT    = 0x0004
   CMD_SETTIME = 0x0005
+  CMD_SETPOLICY = 0x0006
+
+  # What the device does when samples are taken faster than they are read.
+  POLICY_STOP     = 0
+  POLICY_EVICT    = 1
+  POLICY_DECIMATE = 2
+  POLICIES = {'stop': POLICY_STOP, 'evict': POLICY_EVICT,
+              'decimate': POLICY_DECIMATE}
 
   # Map between header channel number (0-47)
   # and INA I2C bus/addr on sweetberry.
@@ -223,6 +231,8 @@ class Spower(object):
     self._write_ep = write_ep
     self._logger.debug("Writer endpoint: 0x%x", write_ep.bEndpointAddress)
 
+    # Records carry decimation and dropped counts once a policy is set.
+    self._batch = False
     self.clear_ina_struct()
 
     self._logger.debug("Found power logging USB endpoint.")
@@ -422,6 +432,26 @@ class Spower(object):
     self._logger.debug("Command SETTIME: %s",
                        "success" if ret == 0 else "failure")
 
+  def set_policy(self, policy):
+    """Set what the device does when the host falls behind.
+
+    Args:
+      policy: one of POLICY_STOP/EVICT/DECIMATE.
+
+    Returns:
+      True if the device accepted the policy. Older firmware does not know
+      this command, and keeps stopping on overflow.
+    """
+    # 0x0006, 1B: policy
+    cmd = struct.pack("<HB", self.CMD_SETPOLICY, policy)
+    ret = self.wr_command(cmd)
+    self._logger.debug("Command SETPOLICY: %s",
+                       "success" if ret == 0 else "failure")
+    if ret == 0:
+      self._batch = policy != self.POLICY_STOP
+      return True
+    return False
+
   def add_ina(self, bus, ina_type, addr, extra, resistance, data=None):
     """Add an INA to the data acquisition list.
 
@@ -450,6 +480,9 @@ class Spower(object):
     """Helper function to calculate power record header size."""
     result = 2
     timestamp = 8
+    if self._batch:
+      # decimation, dropped
+      result += 2
     return result + timestamp
 
   def report_size(self, ina_count):
@@ -517,19 +550,34 @@ class Spower(object):
     else:
       pass
 
-    timestamp = struct.unpack("<Q", data[2:10])[0]
+    decimation = 0
+    dropped = 0
+    if self._batch:
+      decimation, dropped = struct.unpack("<BB", data[2:4])
+
+    header = self.report_header_size()
+    timestamp = struct.unpack("<Q", data[header-8:header])[0]
     self._logger.debug("READ LINE: st:%d size:%d time:%dus", status, size,
                        timestamp)
     ftimestamp = float(timestamp) / 1000000.
+    if dropped:
+      self._logger.info("%s: %d record(s) dropped before %fs", self._board,
+                        dropped, ftimestamp)
 
-    record = {"ts": ftimestamp, "status": status, "berry":self._board}
+    record = {"ts": ftimestamp, "status": status, "berry":self._board,
+              "samples": 1 << decimation, "dropped": dropped}
 
     for i in range(0, size):
       idx = self.report_header_size() + 2*i
       name = self._inas[i]['name']
       name_tuple = (self._inas[i]['name'], self._inas[i]['type'])
 
-      raw_val = struct.unpack("<h", data[idx:idx+2])[0]
+      # Power and bus voltage registers are unsigned, like the firmware
+      # averages them; current and shunt voltage are signed.
+      if self._inas[i]['type'] in (Spower.INA_POWER, Spower.INA_BUSV):
+        raw_val = struct.unpack("<H", data[idx:idx+2])[0]
+      else:
+        raw_val = struct.unpack("<h", data[idx:idx+2])[0]
 
       if self._inas[i]['type'] == Spower.INA_POWER:
         val = raw_val * self._inas[i]['uWscale']
@@ -575,7 +623,7 @@ class powerlog(object):
   def __init__(self, brdfile, cfgfile, serial_a=None, serial_b=None,
                sync_date=False, use_ms=False, use_mW=False, print_stats=False,
                stats_dir=None, stats_json_dir=None, print_raw_data=True,
-               raw_data_dir=None):
+               raw_data_dir=None, overflow_policy=None):
     """Init the powerlog class and set the variables.
 
     Args:
@@ -595,6 +643,9 @@ class powerlog(object):
                       is to print.
       raw_data_dir: directory to save sweetberry readings raw data; if None then
                     do not save the raw data.
+      overflow_policy: 'stop', 'evict' or 'decimate', what sweetberry does
+                       when it samples faster than we read; if None then
+                       leave the device default, which stops.
     """
     self._logger = logging.getLogger(__name__)
     self._data = StatsManager()
@@ -645,6 +696,10 @@ class powerlog(object):
         self._pwr[key].set_time(time.time() * 1000000)
       else:
         self._pwr[key].set_time(0)
+      if overflow_policy:
+        if not self._pwr[key].set_policy(Spower.POLICIES[overflow_policy]):
+          self._logger.warning("Sweetberry %s does not support overflow "
+                               "policy %s", key, overflow_policy)
 
   def process_scenario(self, name_list):
     """Return list of tuples indicating name and type.
@@ -816,6 +871,11 @@ def main(argv=None):
       action="store_true")
   parser.add_argument('--slow', default=False,
       help="Intentionally overflow", action="store_true")
+  parser.add_argument('--overflow', type=str, default=None,
+      choices=sorted(Spower.POLICIES.keys()),
+      help="What sweetberry does when it samples faster than it is read: "
+           "stop sampling, evict the oldest samples, or decimate, averaging "
+           "more samples into each record; default is to stop")
   parser.add_argument('--print_stats', default=False, action="store_true",
       help="Print statistics for sweetberry readings at the end")
   parser.add_argument('--save_stats', type=str, nargs='?',
@@ -882,6 +942,7 @@ def main(argv=None):
   stats_json_dir = args.stats_json_dir
   print_raw_data = args.print_raw_data
   raw_data_dir = args.raw_data_dir
+  overflow_policy = args.overflow
 
   boards = []
 
@@ -894,7 +955,8 @@ def main(argv=None):
       sync_date=sync_date, use_ms=use_ms, use_mW=use_mW,
       print_stats=print_stats, stats_dir=stats_dir,
       stats_json_dir=stats_json_dir,
-      print_raw_data=print_raw_data,raw_data_dir=raw_data_dir)
+      print_raw_data=print_raw_data,raw_data_dir=raw_data_dir,
+      overflow_policy=overflow_policy)
 
   # Start logging.
   powerlogger.start(integration_us_request, seconds, sync_speed=sync_speed)
@@ -3,8 +3,10 @@
 # found in the LICENSE file.
 """Unit tests for powerlog."""
 
+import logging
 import os
 import shutil
+import struct
 import tempfile
 import unittest
 
@@ -45,5 +47,51 @@ class TestPowerlog(unittest.TestCase):
     with self.assertRaises(IOError):
       powerlog.process_filename(self.filename)
 
+  def _spower(self, batch, ina_type=powerlog.Spower.INA_POWER):
+    """Spower with one 10 mOhm INA, without opening a USB device."""
+    spower = powerlog.Spower.__new__(powerlog.Spower)
+    spower._logger = logging.getLogger(__name__)
+    spower._board = 'A'
+    spower._batch = batch
+    spower.clear_ina_struct()
+    spower.append_ina_struct('vbat', 10, 0, 0x40, ina_type=ina_type)
+    return spower
+
+  def test_InterpretLine(self):
+    """Records without an overflow policy have a 10 byte header."""
+    spower = self._spower(batch=False)
+    data = struct.pack('<BBQh', 0, 1, 2000000, 100)
+    data += b'\0' * (spower.report_size(1) - len(data))
+    record = spower.interpret_line(data)
+    self.assertEqual(2.0, record['ts'])
+    self.assertEqual(0, record['dropped'])
+    self.assertAlmostEqual(100 * 25 * 80000000. / (10 * 0x8000),
+                           record[('vbat', powerlog.Spower.INA_POWER)])
+
+  def test_InterpretBatchRecord(self):
+    """Batch records carry the decimation and dropped record counts."""
+    spower = self._spower(batch=True, ina_type=powerlog.Spower.INA_CURRENT)
+    data = struct.pack('<BBBBQh', 0, 1, 3, 5, 2000000, -100)
+    data += b'\0' * (spower.report_size(1) - len(data))
+    self.assertEqual(16, len(data))
+    record = spower.interpret_line(data)
+    self.assertEqual(2.0, record['ts'])
+    self.assertEqual(8, record['samples'])
+    self.assertEqual(5, record['dropped'])
+    self.assertAlmostEqual(-100 * 80000000. / (10 * 0x8000),
+                           record[('vbat', powerlog.Spower.INA_CURRENT)])
+
+  def test_InterpretUnsignedRegisters(self):
+    """Power and bus voltage are unsigned, shunt voltage is signed."""
+    for ina_type, scale, expected in (
+        (powerlog.Spower.INA_POWER, 25 * 80000000. / (10 * 0x8000), 0xff9c),
+        (powerlog.Spower.INA_BUSV, 1.25, 0xff9c),
+        (powerlog.Spower.INA_SHUNTV, 2.5, -100)):
+      spower = self._spower(batch=False, ina_type=ina_type)
+      data = struct.pack('<BBQh', 0, 1, 2000000, -100)
+      data += b'\0' * (spower.report_size(1) - len(data))
+      record = spower.interpret_line(data)
+      self.assertAlmostEqual(expected * scale, record[('vbat', ina_type)])
+
 if __name__ == '__main__':
   unittest.main()
@@ -161,6 +161,33 @@ const struct battery_info *battery_get_info(void);
  */
 void battery_get_params(struct batt_params *batt);
 
+#ifdef CONFIG_BATTERY_SMART_CACHE
+/**
+ * Set how long battery_get_params() reuses a value read from the battery.
+ *
+ * @param field		Value to set the period for
+ * @param period_ms	Refresh period, or 0 to read the value every time
+ * @return EC_SUCCESS, or EC_ERROR_INVAL for an unknown field.
+ */
+int battery_cache_set_period(enum charge_state_batt_params field,
+			     uint32_t period_ms);
+
+/**
+ * Make battery_get_params() read every value from the battery next time,
+ * e.g. because external power has come or gone.
+ */
+void battery_cache_invalidate(void);
+
+/*
+ * Access to the CS_PARAM_BATT_AGE_* and CS_PARAM_BATT_REFRESH_* params
+ * through host commands.
+ */
+enum ec_status battery_cache_get_param(uint32_t param, uint32_t *value);
+enum ec_status battery_cache_set_param(uint32_t param, uint32_t value);
+#else
+static inline void battery_cache_invalidate(void) { }
+#endif
+
 /**
  * Modify battery parameters to match vendor charging profile.
  *
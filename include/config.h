@@ -62,6 +62,19 @@
 /* The amount of free entries that trigger an interrupt to the AP. */
 #undef CONFIG_ACCEL_FIFO_THRES
 
+/*
+ * Size in bytes of the buffer sensor drivers drain their hardware FIFO into.
+ * A bigger buffer reads more samples per bus transaction.  Defaults to 64.
+ */
+#undef CONFIG_ACCEL_FIFO_READ_SIZE
+
+/*
+ * When the AP does not read the FIFO fast enough, decimate the incoming
+ * sensor samples (keep 1 in 2, 4, then 8) on top of dropping the oldest
+ * entries. The decimation is lifted as the AP catches up.
+ */
+#undef CONFIG_ACCEL_FIFO_DECIMATE
+
 /*
  * Sensors in this mask are in forced mode: they needed to be polled
  * at their data rate frequency.
@@ -522,6 +535,14 @@
  */
 #undef CONFIG_BATTERY_SMART
 
+/*
+ * Cache the smart battery values read by battery_get_params(), and only
+ * read each one again once it is older than its refresh period.  Periods
+ * can be changed with battery_cache_set_period() or the EC_CMD_CHARGE_STATE
+ * CS_PARAM_BATT_REFRESH_* params.
+ */
+#undef CONFIG_BATTERY_SMART_CACHE
+
 /* Chemistry of the battery device */
 #undef CONFIG_BATTERY_DEVICE_CHEMISTRY
 
@@ -1390,6 +1411,7 @@
 #define CONFIG_CMD_SYSLOCK
 #undef  CONFIG_CMD_TASK_RESET
 #undef  CONFIG_CMD_TASKREADY
+#undef  CONFIG_CMD_TCPC_ALERT_STATS
 #undef  CONFIG_CMD_TCPC_DUMP
 #define CONFIG_CMD_TEMP_SENSOR
 #define CONFIG_CMD_TIMERINFO
@@ -1508,6 +1530,13 @@
  */
 #define CONFIG_CONSOLE_ENABLE_READ_V1
 
+/*
+ * Run all complete lines received in one console task wakeup before printing
+ * the prompt, so a script of commands (e.g. pasted, or sent by servo test
+ * automation) produces a single prompt instead of one per line.
+ */
+#undef CONFIG_CONSOLE_BATCH
+
 /*
  * Number of entries in console history buffer.
  *
@@ -2108,6 +2137,23 @@
  */
 #undef CONFIG_HOSTCMD_SECTION_SORTED
 
+/*
+ * Look host commands up in a hash table from command number to handler, built
+ * when the host command task starts, instead of searching .rodata.hcmds.  The
+ * value is the number of slots: a power of two, and best kept at least twice
+ * the number of host commands so most lookups take a single probe.  Costs one
+ * pointer of RAM per slot.  Required for host commands on Zephyr, where the
+ * shim registers each command in the table.
+ */
+#undef CONFIG_HOSTCMD_HASH_SLOTS
+
+/*
+ * Keep a histogram of dispatch latency for every host command, reported by
+ * EC_CMD_HOST_COMMAND_STATS.  Requires CONFIG_HOSTCMD_HASH_SLOTS and adds
+ * 2 * EC_HOST_COMMAND_STATS_BUCKETS bytes of RAM per slot.
+ */
+#undef CONFIG_HOSTCMD_STATS
+
 /*
  * Host command parameters and response are 32-bit aligned.  This generates
  * much more efficient code on ARM.
@@ -2232,6 +2278,13 @@
 /* Enable the software routine for CRC computation */
 #undef CONFIG_SW_CRC
 
+/*
+ * Number of lookup tables (4 or 8) the software CRC routine uses to process
+ * that many bytes per step in crc32_hash_buf().  Costs 1 KB of flash per extra
+ * table.  Leave undefined to process one byte at a time with a single table.
+ */
+#undef CONFIG_SW_CRC_SLICES
+
 /*****************************************************************************/
 
 /* Enable system hibernate */
@@ -2332,6 +2385,12 @@
  */
 #undef CONFIG_I2C_XFER_BOARD_CALLBACK
 
+/*
+ * Enable i2c_xfer_submit(), which queues transfers per port and runs them
+ * from the HOOKS task, so the caller does not block on the bus.
+ */
+#undef CONFIG_I2C_XFER_ASYNC
+
 /*
  * EC uses an I2C controller interface.
  * Note: if this is defined, i2c_init() will be called
@@ -2618,6 +2677,13 @@
 /*  Print keyboard scan time intervals. */
 #undef CONFIG_KEYBOARD_PRINT_SCAN_TIMES
 
+/*
+ * Sleep rather than spin while each keyboard column settles during a scan, so
+ * other tasks (or the idle task) get the CPU.  Only worth it when the column
+ * settle time is long compared to the cost of a context switch.
+ */
+#undef CONFIG_KEYBOARD_SCAN_SLEEP_SETTLE
+
 /*
  * Support for extra runtime key combinations (e.g. alt+volup+h/r for hibernate
  * and warm reboot, respectively).
@@ -3401,6 +3467,14 @@
 /* Support SPI interfaces */
 #undef CONFIG_SPI
 
+/*
+ * Size of the request and response packet buffers used for host commands over
+ * SPI. Boards moving large blobs between the AP and the EC, like fingerprint
+ * frames and templates, can raise it so that every host command carries more
+ * data. Defaults to 0x220, enough for 512 bytes of flash data.
+ */
+#undef CONFIG_SPI_HOST_PACKET_SIZE
+
 /* Support deprecated SPI protocol version 2. */
 #undef CONFIG_SPI_PROTOCOL_V2
 
@@ -3933,6 +4007,15 @@
 #define CONFIG_USB_PRL_SM
 #define CONFIG_USB_PE_SM
 
+/*
+ * Let the TCPMv2 PD task sleep until the next state machine deadline instead
+ * of waking every 5 ms. States that don't publish a deadline still poll, so
+ * this is safe to enable one state at a time. Requires a TCPC that raises an
+ * alert on CC and VBUS changes (e.g. CONFIG_USB_PD_VBUS_DETECT_TCPC); with
+ * the embedded CONFIG_USB_PD_TCPC the task keeps polling.
+ */
+#undef CONFIG_USB_PD_TICKLESS
+
 /* Enables PD Console commands */
 #define CONFIG_USB_PD_CONSOLE_CMD
 
@@ -5139,10 +5222,12 @@
  * Disable the built-in console history if using the experimental console.
  *
  * The experimental console keeps its own session-persistent history which
- * survives EC reboot.  It also requires CRC8 for command integrity.
+ * survives EC reboot.  It also requires CRC8 for command integrity.  It never
+ * prints a prompt, so there is nothing for CONFIG_CONSOLE_BATCH to batch.
  */
 #ifdef CONFIG_EXPERIMENTAL_CONSOLE
 #undef CONFIG_CONSOLE_HISTORY
+#undef CONFIG_CONSOLE_BATCH
 #define CONFIG_CRC8
 #endif /* defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
@@ -5771,6 +5856,10 @@
 
 #endif /* CONFIG_ACCEL_FIFO */
 
+#ifndef CONFIG_ACCEL_FIFO_READ_SIZE
+#define CONFIG_ACCEL_FIFO_READ_SIZE 64
+#endif
+
 
 /*
  * If USB PD Discharge is enabled, verify that CONFIG_USB_PD_DISCHARGE_GPIO
@@ -22,6 +22,9 @@ void crc32_hash32(uint32_t val);
 
 void crc32_hash16(uint16_t val);
 
+/* Hash size bytes of buf, in order */
+void crc32_hash_buf(const void *buf, int size);
+
 uint32_t crc32_result(void);
 
 /* Provided context variant */
@@ -34,6 +37,8 @@ void crc32_ctx_hash16(uint32_t *ctx, uint16_t val);
 
 void crc32_ctx_hash8(uint32_t *ctx, uint8_t val);
 
+void crc32_ctx_hash_buf(uint32_t *ctx, const void *buf, int size);
+
 uint32_t crc32_ctx_result(uint32_t *ctx);
 
 #endif /* CONFIG_HW_CRC */
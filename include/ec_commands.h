@@ -2382,6 +2382,17 @@ struct ec_response_vboot_hash {
 	uint8_t hash_digest[64]; /* Hash digest data */
 } __ec_align4;
 
+/*
+ * Version 1 of the response adds the time the EC took to compute the hash,
+ * from start to the final digest, including time spent yielding to other
+ * work between chunks.  It is 0 if the hash is not done, or was computed
+ * before the last sysjump.
+ */
+struct ec_response_vboot_hash_v1 {
+	struct ec_response_vboot_hash hash;
+	uint32_t hash_time_us;   /* Time taken to compute the hash */
+} __ec_align4;
+
 enum ec_vboot_hash_cmd {
 	EC_VBOOT_HASH_GET = 0,       /* Get current hash status */
 	EC_VBOOT_HASH_ABORT = 1,     /* Abort calculating current hash */
@@ -4484,9 +4495,37 @@ enum charge_state_params {
 	CS_PARAM_DEBUG_MANUAL_VOLTAGE,
 	CS_PARAM_DEBUG_MAX = 0x2ffff,
 
+	/*
+	 * Range for CONFIG_BATTERY_SMART_CACHE params, indexed by
+	 * enum charge_state_batt_params.  Ages are in ms since the value was
+	 * last read from the battery, or CS_BATT_AGE_NEVER, and are read only.
+	 * Refresh periods are in ms; 0 reads the value every time.
+	 */
+	CS_PARAM_BATT_AGE_MIN = 0x30000,
+	CS_PARAM_BATT_AGE_MAX = 0x300ff,
+	CS_PARAM_BATT_REFRESH_MIN = 0x30100,
+	CS_PARAM_BATT_REFRESH_MAX = 0x301ff,
+
 	/* Other custom param ranges go here... */
 };
 
+/* Battery values with a cache age and refresh period, see above. */
+enum charge_state_batt_params {
+	CS_BATT_TEMPERATURE,
+	CS_BATT_STATE_OF_CHARGE,
+	CS_BATT_VOLTAGE,
+	CS_BATT_CURRENT,
+	CS_BATT_DESIRED_VOLTAGE,
+	CS_BATT_DESIRED_CURRENT,
+	CS_BATT_REMAINING_CAPACITY,
+	CS_BATT_FULL_CAPACITY,
+	CS_BATT_STATUS,
+	/* How many so far? */
+	CS_NUM_BATT_PARAMS
+};
+
+#define CS_BATT_AGE_NEVER 0xffffffff
+
 struct ec_params_charge_state {
 	uint8_t cmd;				/* enum charge_state_command */
 	union {
@@ -6642,6 +6681,38 @@ struct ec_response_typec_status {
 	uint32_t sink_cap_pdos[7];	/* Max 7 PDOs can be present */
 } __ec_align1;
 
+/*
+ * Get host command dispatch latency histograms.
+ *
+ * Only available when the EC is built with CONFIG_HOSTCMD_STATS.  Commands
+ * are reported only if they have run since the last clear, starting with the
+ * index-th one.  Call again with a larger index until it reaches num_cmds.
+ */
+#define EC_CMD_HOST_COMMAND_STATS 0x0134
+
+/* Number of latency buckets; bucket i counts runs under 4^(i+1) us */
+#define EC_HOST_COMMAND_STATS_BUCKETS 8
+
+/* Reset all counts instead of reporting them */
+#define EC_HOST_COMMAND_STATS_CLEAR BIT(0)
+
+struct ec_params_host_command_stats {
+	uint16_t index;
+	uint16_t flags;			/* EC_HOST_COMMAND_STATS_* */
+} __ec_align2;
+
+struct ec_host_command_stats_entry {
+	uint16_t command;
+	/* Counts saturate at 0xffff */
+	uint16_t latency[EC_HOST_COMMAND_STATS_BUCKETS];
+} __ec_align2;
+
+struct ec_response_host_command_stats {
+	uint16_t num_cmds;		/* Commands that have run */
+	uint16_t num_entries;		/* Entries in this response */
+	struct ec_host_command_stats_entry entries[0];
+} __ec_align2;
+
 /*****************************************************************************/
 /* The command range 0x200-0x2FF is reserved for Rotor. */
 
@@ -6874,7 +6945,7 @@ struct ec_params_fp_context_v1 {
 #define FPSTATS_CAPTURE_INV  BIT(0)
 #define FPSTATS_MATCHING_INV BIT(1)
 
-struct ec_response_fp_stats {
+struct ec_response_fp_stats_v0 {
 	uint32_t capture_time_us;
 	uint32_t matching_time_us;
 	uint32_t overall_time_us;
@@ -6886,6 +6957,22 @@ struct ec_response_fp_stats {
 	int8_t template_matched;
 } __ec_align2;
 
+struct ec_response_fp_stats {
+	uint32_t capture_time_us;
+	uint32_t matching_time_us;
+	uint32_t overall_time_us;
+	struct {
+		uint32_t lo;
+		uint32_t hi;
+	} overall_t0;
+	uint8_t timestamps_invalid;
+	int8_t template_matched;
+	/* Number of EC_CMD_FP_FRAME requests used by the last frame upload */
+	uint16_t frame_upload_chunks;
+	/* Time from the first to the last chunk of the last frame upload */
+	uint32_t frame_upload_time_us;
+} __ec_align4;
+
 #define EC_CMD_FP_SEED 0x0408
 struct ec_params_fp_seed {
 	/*
@@ -92,4 +92,48 @@ int aes_gcm_decrypt(const uint8_t *key, int key_size, uint8_t *plaintext,
 		    const uint8_t *nonce, int nonce_size,
 		    const uint8_t *tag, int tag_size);
 
+/*
+ * Implementation of the primitives used to protect templates. Only the
+ * software backend exists for now; a chip with a crypto engine can add its
+ * own backend and make it the default in fpsensor_crypto.c.
+ *
+ * The AES-GCM hooks take the same arguments as aes_gcm_encrypt() and
+ * aes_gcm_decrypt(), which check the nonce size before calling them. A
+ * hardware backend may return EC_ERROR_UNIMPLEMENTED for parameters it
+ * cannot handle, in which case the software backend is used instead.
+ */
+struct fp_crypto_backend {
+	const char *name;
+	int (*aes_gcm_encrypt)(const uint8_t *key, int key_size,
+			       const uint8_t *plaintext,
+			       uint8_t *ciphertext, int text_size,
+			       const uint8_t *nonce, int nonce_size,
+			       uint8_t *tag, int tag_size);
+	int (*aes_gcm_decrypt)(const uint8_t *key, int key_size,
+			       uint8_t *plaintext,
+			       const uint8_t *ciphertext, int text_size,
+			       const uint8_t *nonce, int nonce_size,
+			       const uint8_t *tag, int tag_size);
+	/* HMAC-SHA256, used by both HKDF steps. */
+	void (*hmac_sha256)(uint8_t *output, const uint8_t *key, int key_len,
+			    const uint8_t *message, int message_len);
+};
+
+extern const struct fp_crypto_backend fp_crypto_sw;
+
+#ifdef TEST_BUILD
+/**
+ * Select the backend used by the functions above. Tests only: production
+ * builds always use the board default.
+ *
+ * @param backend the backend to use, or NULL for the board default.
+ */
+void fp_crypto_set_backend(const struct fp_crypto_backend *backend);
+#endif
+
+/**
+ * @return the backend currently in use.
+ */
+const struct fp_crypto_backend *fp_crypto_get_backend(void);
+
 #endif /* __CROS_EC_FPSENSOR_CRYPTO_H */
@@ -328,12 +328,33 @@ int hook_call_deferred(const struct deferred_data *data, int us);
  *                      and HOOK_PRIO_LAST, and should be HOOK_PRIO_DEFAULT
  *			unless there's a compelling reason to care about the
  *			order in which hooks are called.
+ *
+ * The hook_data entry is emitted into a section named after both the hook type
+ * and the priority (e.g. .rodata.HOOK_INIT.5000), so the linker lays each hook
+ * table out already sorted by priority.  The priority is only known to the
+ * compiler as a constant expression, which is why the entry is emitted from
+ * inline assembly inside an (otherwise empty) function rather than through a
+ * section attribute.  The function itself is discarded by --gc-sections.
  */
 #define DECLARE_HOOK(hooktype, routine, priority)			\
-	const struct hook_data __keep __no_sanitize_address		\
-	CONCAT4(__hook_, hooktype, _, routine)				\
-	__attribute__((section(".rodata." STRINGIFY(hooktype))))	\
-	     = {routine, priority}
+	static void __attribute__((used))				\
+	CONCAT4(__hook_, hooktype, _, routine)(void)			\
+	{								\
+		__asm__(".pushsection .rodata." STRINGIFY(hooktype)	\
+			".%c0, \"a\"\n"					\
+			".balign %c2\n"					\
+			".if %c3 == 8\n"					\
+			".quad %c1\n"					\
+			".else\n"					\
+			".long %c1\n"					\
+			".endif\n"					\
+			".long %c0\n"					\
+			".balign %c2\n"					\
+			".popsection"					\
+			:: "i"(priority), "i"(routine),			\
+			   "i"(__alignof__(struct hook_data)),		\
+			   "i"(sizeof(void (*)(void))));		\
+	}
 
 /**
  * Register a deferred function call.
@@ -244,7 +244,20 @@ int host_request_expected_size(const struct ec_host_request *r);
  */
 void host_packet_receive(struct host_packet *pkt);
 
-#ifdef HAS_TASK_HOSTCMD
+/**
+ * Add a host command to the lookup hash table (CONFIG_HOSTCMD_HASH_SLOTS).
+ *
+ * Commands in .rodata.hcmds are added when the host command task starts; this
+ * is for environments such as the Zephyr shim that register them at runtime.
+ *
+ * @param cmd		Host command, which must stay valid
+ * @return EC_SUCCESS, or EC_ERROR_OVERFLOW if the table is full.
+ */
+int host_command_hash_add(const struct host_command *cmd);
+
+#ifdef CONFIG_PLATFORM_EC_HOSTCMD
+#include "zephyr_host_command_shim.h"
+#elif defined(HAS_TASK_HOSTCMD)
 #define EXPAND(off, cmd) __host_cmd_(off, cmd)
 #define __host_cmd_(off, cmd) __host_cmd_##off##cmd
 #define EXPANDSTR(off, cmd) "__host_cmd_"#off#cmd
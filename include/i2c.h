@@ -12,6 +12,7 @@
 #include "gpio.h"
 #include "host_command.h"
 #include "stddef.h"
+#include "task_id.h"
 
 /*
  * I2C Slave Address encoding
@@ -195,6 +196,61 @@ int i2c_xfer_unlocked(const int port,
 		      const uint8_t *out, int out_size,
 		      uint8_t *in, int in_size, int flags);
 
+/*
+ * Asynchronous transfers (CONFIG_I2C_XFER_ASYNC).
+ *
+ * A request is a list of transfers to one port, each run as an
+ * I2C_XFER_SINGLE transaction.  Requests are queued per port and run
+ * back-to-back, under a single hold of the port lock, from the HOOKS task.
+ * The list stops at the first transfer that fails.
+ *
+ * When a request finishes, its rv is set, then done() (if any) is called from
+ * the HOOKS task, then event (if non-zero) is set on task.  The caller owns the
+ * request and the buffers it points to until then.  done() may submit more
+ * requests, and it may use the blocking API.
+ */
+struct i2c_async_op {
+	uint16_t addr_flags;
+	const uint8_t *out;
+	int out_size;
+	uint8_t *in;
+	int in_size;
+};
+
+struct i2c_async_req {
+	/* Set by the caller */
+	int port;
+	const struct i2c_async_op *ops;
+	int count;
+	void (*done)(struct i2c_async_req *req);
+	task_id_t task;
+	uint32_t event;
+
+	/* Result of the first failing transfer, or EC_SUCCESS */
+	int rv;
+
+	/* Private to the I2C code */
+	struct i2c_async_req *next;
+	uint32_t queued_at;
+	/* Requests already queued on the port, saturating at 255 */
+	uint8_t depth;
+	uint8_t busy;
+};
+
+/**
+ * Queue an asynchronous request.  May be called from interrupt context.
+ *
+ * @param req		Request to queue
+ * @return EC_SUCCESS, EC_ERROR_INVAL for a bad port or empty list, or
+ *	   EC_ERROR_BUSY if req is still queued from an earlier submission.
+ */
+int i2c_xfer_submit(struct i2c_async_req *req);
+
+/**
+ * Return non-zero while req is queued or running.
+ */
+int i2c_xfer_busy(const struct i2c_async_req *req);
+
 #define I2C_LINE_SCL_HIGH BIT(0)
 #define I2C_LINE_SDA_HIGH BIT(1)
 #define I2C_LINE_IDLE (I2C_LINE_SCL_HIGH | I2C_LINE_SDA_HIGH)
@@ -564,6 +620,26 @@ void i2c_trace_notify(int port, uint16_t slave_addr_flags,
 		      const uint8_t *out_data, size_t out_size,
 		      const uint8_t *in_data, size_t in_size);
 
+/**
+ * Defined in common/i2c_trace.c, used by i2c master to account the time a
+ * port spends on transactions, for the "i2ctrace stats" console command.
+ *
+ * @param port: I2C port number
+ * @param bytes: bytes written and read
+ * @param us: time the transaction took
+ */
+void i2c_trace_stats_xfer(int port, size_t bytes, uint32_t us);
+
+/**
+ * Defined in common/i2c_trace.c, used by i2c master to account how long an
+ * asynchronous request waited in its port's queue before it ran.
+ *
+ * @param port: I2C port number
+ * @param wait_us: time from i2c_xfer_submit() to the start of the request
+ * @param depth: requests queued on the port when this one was submitted
+ */
+void i2c_trace_stats_async(int port, uint32_t wait_us, int depth);
+
 /**
  * Set bus speed. Only support for ports with I2C_PORT_FLAG_DYNAMIC_SPEED
  * flag.
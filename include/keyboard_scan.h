@@ -20,6 +20,12 @@ struct keyboard_scan_config {
 	uint16_t debounce_up_us;
 	/* Time between start of scans when in polling mode */
 	uint16_t scan_period_us;
+	/*
+	 * Longest time between start of scans while keys are held and nothing
+	 * is changing or debouncing.  The period backs off towards this from
+	 * scan_period_us, and snaps back on the next edge.  0 to disable.
+	 */
+	uint16_t held_scan_period_us;
 	/*
 	 * Minimum time between end of one scan and start of the next one.
 	 * This ensures keyboard scanning doesn't starve the rest of the system
@@ -82,6 +82,9 @@ extern const struct deferred_data __deferred_funcs[];
 extern const struct deferred_data __deferred_funcs_end[];
 extern uint64_t __deferred_until[];
 extern uint64_t __deferred_until_end[];
+/* Deferred function scheduler state (heap and per-func bookkeeping) */
+extern uint16_t __deferred_heap[];
+extern uint16_t __deferred_heap_end[];
 
 /* I2C fake devices for unit testing */
 extern const struct test_i2c_xfer __test_i2c_xfer[];
@@ -66,12 +66,61 @@ void motion_sense_fifo_stage_data(
 	int valid_data,
 	uint32_t time);
 
+/**
+ * Stage a batch of sensor vectors decoded from a single hardware FIFO read.
+ * Every entry must have its sensor_num set and carry 3 valid axes.  As with
+ * motion_sense_fifo_stage_data(), the data is not available to the AP until
+ * motion_sense_fifo_commit_data is called. The whole batch is staged under a
+ * single hold of the FIFO lock.
+ *
+ * @param data vectors to insert in the FIFO, in the order they were read
+ * @param count number of vectors in data
+ * @param time accurate time (ideally measured in an interrupt) the samples
+ *             were taken at
+ */
+void motion_sense_fifo_stage_batch(
+	struct ec_response_motion_sensor_data *data,
+	int count,
+	uint32_t time);
+
 /**
  * Commit all the currently staged data to the fifo. Doing so makes it readable
  * to the AP.
  */
 void motion_sense_fifo_commit_data(void);
 
+/** Hardware FIFO read statistics, per sensor. */
+struct motion_sense_fifo_read_stats {
+	/* Number of times the hardware FIFO was drained */
+	uint32_t reads;
+	/* Bus transactions and bytes used to read the FIFO data */
+	uint32_t xfers;
+	uint32_t bytes;
+	/* Time spent reading and decoding, total and worst case */
+	uint32_t total_us;
+	uint32_t max_us;
+};
+
+/**
+ * Account for one drain of a sensor's hardware FIFO.
+ *
+ * @param sensor sensor whose FIFO was read
+ * @param xfers number of bus transactions used to read FIFO data
+ * @param bytes number of FIFO bytes read
+ * @param us time taken to read and decode the data
+ */
+void motion_sense_fifo_record_read(struct motion_sensor_t *sensor,
+				   int xfers, int bytes, uint32_t us);
+
+/**
+ * Get the hardware FIFO read statistics of a sensor.
+ *
+ * @param sensor_num index of the sensor in motion_sensors
+ * @return pointer to the statistics
+ */
+const struct motion_sense_fifo_read_stats *
+motion_sense_fifo_get_read_stats(int sensor_num);
+
 /**
  * Get information about the fifo.
  *
@@ -96,6 +96,33 @@ struct queue {
 		.buffer       = (uint8_t *) &((TYPE[SIZE]){}),	\
 	})
 
+/*
+ * Concurrency
+ *
+ * A queue may be shared by one producer and one consumer without any locking,
+ * for example an interrupt handler adding units and a task removing them, or
+ * two threads on the host.  The producer only writes the tail and the consumer
+ * only writes the head; each index is published with release semantics after
+ * the units it covers have been copied, and the other side reads it with
+ * acquire semantics.
+ *
+ * Producer side: queue_add_*, queue_get_write_chunk(s), queue_advance_tail.
+ * Consumer side: queue_remove_*, queue_peek_*, queue_get_read_chunk(s) and
+ *                queue_advance_head.
+ * Either side:   queue_is_empty, queue_count, queue_space, queue_is_full.
+ *                The value returned is a snapshot; it can only become more
+ *                favourable to the caller before it acts on it.
+ *
+ * queue_init must not race with either side, and the queue iterators treat
+ * any concurrent change to the queue as an error.  Anything beyond a single
+ * producer and a single consumer (e.g. two tasks adding to the same queue)
+ * still needs a lock around the calls of the sides that are shared.
+ *
+ * The queue policy add callback runs in the producer's context and the remove
+ * callback in the consumer's, so a policy used from an interrupt handler must
+ * be safe to call there.
+ */
+
 /* Initialize the queue to empty state. */
 void queue_init(struct queue const *q);
 
@@ -184,6 +211,22 @@ struct queue_chunk queue_get_write_chunk(struct queue const *q, size_t offset);
  */
 struct queue_chunk queue_get_read_chunk(struct queue const *q);
 
+/*
+ * Scatter-gather variants of the two functions above.  The free space (or the
+ * stored units) of a queue is at most two contiguous blocks, one at the end of
+ * the buffer and one at its start.  These fill in chunks[0] and chunks[1] to
+ * cover all of it, and return the total number of units.  Unused chunks have
+ * a count of zero.
+ *
+ * This lets a DMA engine (or any other bulk copier) be handed everything at
+ * once.  Advance the tail (or head) once for the whole transfer, so the queue
+ * policy is notified once rather than once per chunk.
+ */
+size_t queue_get_write_chunks(struct queue const *q,
+			      struct queue_chunk chunks[2]);
+size_t queue_get_read_chunks(struct queue const *q,
+			     struct queue_chunk chunks[2]);
+
 /*
  * Move the queue head pointer forward count units.  This discards count
  * elements from the head of the queue.  It will only discard up to the total
@@ -213,6 +256,15 @@ size_t queue_add_memcpy(struct queue const *q,
 					const void *src,
 					size_t n));
 
+/*
+ * Add units gathered from n source chunks, in order, as a single batch.  The
+ * queue policy is notified once for the whole batch.  Returns the number of
+ * units added, which is less than the total if the queue fills up.
+ */
+size_t queue_add_chunks(struct queue const *q,
+			struct queue_chunk const *src,
+			size_t n);
+
 /* Remove one unit from the begin of the queue. */
 size_t queue_remove_unit(struct queue const *q, void *dest);
 
@@ -227,6 +279,15 @@ size_t queue_remove_memcpy(struct queue const *q,
 					   const void *src,
 					   size_t n));
 
+/*
+ * Remove units from the begin of the queue, scattering them over n destination
+ * chunks in order, as a single batch.  The queue policy is notified once for
+ * the whole batch.  Returns the number of units removed.
+ */
+size_t queue_remove_chunks(struct queue const *q,
+			   struct queue_chunk const *dest,
+			   size_t n);
+
 /* Peek (return but don't remove) the count elements starting with the i'th. */
 size_t queue_peek_units(struct queue const *q,
 			void *dest,
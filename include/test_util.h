@@ -205,6 +205,14 @@ static inline void wait_for_task_started(void) { }
 static inline void wait_for_task_started_nosleep(void) { }
 #endif
 
+#ifdef EMU_BUILD
+/*
+ * Host monotonic clock in nanoseconds. get_time() is simulated in the
+ * emulator, so benchmarks time themselves against this instead.
+ */
+uint64_t test_host_time_ns(void);
+#endif
+
 uint32_t prng(uint32_t seed);
 
 uint32_t prng_no_seed(void);
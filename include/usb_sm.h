@@ -25,6 +25,8 @@ typedef void (*state_execution)(const int port);
  *
  *	Note: When transitioning between two child states with a shared parent,
  *	that parent's exit and entry functions do not execute.
+ *	At most USB_SM_MAX_DEPTH parents may be chained above a state; the
+ *	state machine unit tests check this.
  */
 struct usb_state {
 	const state_execution entry;
@@ -33,6 +35,9 @@ struct usb_state {
 	const struct usb_state *parent;
 };
 
+/* Deepest nesting of states supported by set_state */
+#define USB_SM_MAX_DEPTH 3
+
 typedef const struct usb_state *usb_state_ptr;
 
 /* Defines the current context of the usb statemachine. */
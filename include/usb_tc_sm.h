@@ -331,6 +331,36 @@ void tc_start_event_loop(int port);
  */
 void tc_pause_event_loop(int port);
 
+/* State machines run by the USB-C PD task */
+enum usbc_sm {
+	USBC_SM_TC,
+	USBC_SM_PE,
+	USBC_SM_PRL,
+};
+
+/* Deadline published by a state machine that is only waiting for events */
+#define USBC_NO_DEADLINE UINT64_MAX
+
+/**
+ * Publish when a state machine next needs to run, absent any new event.
+ *
+ * Called by a state machine from its run function. With
+ * CONFIG_USB_PD_TICKLESS the PD task sleeps until the earliest deadline
+ * published during a pass, but only if every state machine published one;
+ * otherwise it polls as usual. Anything that changes a state machine's
+ * inputs from outside its run function must wake the PD task.
+ *
+ * @param port USB-C port number
+ * @param sm State machine publishing the deadline
+ * @param deadline Absolute time (us) or USBC_NO_DEADLINE
+ */
+void usbc_sm_set_deadline(int port, enum usbc_sm sm, uint64_t deadline);
+
+#ifdef TEST_BUILD
+/* Number of times the PD task has woken up on each port */
+extern uint32_t pd_task_wakeups[];
+#endif
+
 /**
  * Allow system to override the control of TrySrc
  *
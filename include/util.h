@@ -277,6 +277,24 @@ void hexdump(const uint8_t *data, int len);
  */
 uint64_t mula32(uint32_t a, uint32_t b, uint32_t c);
 uint64_t mulaa32(uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+#elif defined(__ARM_FEATURE_DSP)
+/*
+ * ARMv7E-M (Cortex-M4/M7) UMAAL computes (a*b)+c+d in a single instruction,
+ * which the compiler does not reliably pick by itself.
+ */
+static inline uint64_t mulaa32(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+	__asm__("umaal %0, %1, %2, %3"
+		: "+r"(c), "+r"(d)
+		: "r"(a), "r"(b));
+
+	return ((uint64_t)d << 32) | c;
+}
+
+static inline uint64_t mula32(uint32_t a, uint32_t b, uint32_t c)
+{
+	return mulaa32(a, b, c, 0);
+}
 #else
 static inline uint64_t mula32(uint32_t a, uint32_t b, uint32_t c)
 {
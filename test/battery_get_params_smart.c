@@ -12,6 +12,7 @@
 #include "console.h"
 #include "i2c.h"
 #include "test_util.h"
+#include "timer.h"
 #include "util.h"
 
 /* Test state */
@@ -37,6 +38,15 @@ static void reset_and_fail_on(int first, int last)
 	fail_on_last = last;
 }
 
+/* Read every value from the battery on every call */
+static void disable_cache(void)
+{
+	int i;
+
+	for (i = 0; i < CS_NUM_BATT_PARAMS; i++)
+		battery_cache_set_period(i, 0);
+}
+
 /* Mocked functions */
 int sb_read(int cmd, int *param)
 {
@@ -60,6 +70,8 @@ static int test_param_failures(void)
 {
 	int i, num_reads;
 
+	disable_cache();
+
 	/* No failures */
 	reset_and_fail_on(0, 0);
 	battery_get_params(&batt);
@@ -90,9 +102,118 @@ static int test_param_failures(void)
 	return EC_SUCCESS;
 }
 
+static int test_param_cache(void)
+{
+	uint32_t val;
+	int num_reads;
+
+	disable_cache();
+	reset_and_fail_on(0, 0);
+	battery_get_params(&batt);
+	num_reads = read_count;
+
+	/* Full capacity is read once, then reused: 2 reads with mAh mode */
+	TEST_EQ(battery_cache_set_period(CS_BATT_FULL_CAPACITY, 60000),
+		EC_SUCCESS, "%d");
+	battery_cache_invalidate();
+	reset_and_fail_on(0, 0);
+	battery_get_params(&batt);
+	TEST_EQ(read_count, num_reads, "%d");
+	reset_and_fail_on(0, 0);
+	battery_get_params(&batt);
+	TEST_EQ(read_count, num_reads - 2, "%d");
+	TEST_ASSERT(!(batt.flags & BATT_FLAG_BAD_ANY));
+
+	TEST_EQ(battery_cache_get_param(CS_PARAM_BATT_AGE_MIN +
+					CS_BATT_FULL_CAPACITY, &val),
+		EC_RES_SUCCESS, "%d");
+	TEST_LT(val, 1000, "%d");
+
+	/* Failed reads aren't cached */
+	reset_and_fail_on(1, 1);
+	battery_get_params(&batt);
+	TEST_ASSERT(batt.flags & BATT_FLAG_BAD_TEMPERATURE);
+	TEST_EQ(battery_cache_get_param(CS_PARAM_BATT_AGE_MIN +
+					CS_BATT_TEMPERATURE, &val),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(val, CS_BATT_AGE_NEVER, "0x%x");
+
+	/* Invalidating reads everything again */
+	battery_cache_invalidate();
+	reset_and_fail_on(0, 0);
+	battery_get_params(&batt);
+	TEST_EQ(read_count, num_reads, "%d");
+
+	/* So does a value getting older than its refresh period */
+	TEST_EQ(battery_cache_set_param(CS_PARAM_BATT_REFRESH_MIN +
+					CS_BATT_FULL_CAPACITY, 10),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(battery_cache_get_param(CS_PARAM_BATT_REFRESH_MIN +
+					CS_BATT_FULL_CAPACITY, &val),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(val, 10, "%d");
+	msleep(20);
+	reset_and_fail_on(0, 0);
+	battery_get_params(&batt);
+	TEST_EQ(read_count, num_reads, "%d");
+
+	/* Ages are read only, and unknown values are rejected */
+	TEST_EQ(battery_cache_set_param(CS_PARAM_BATT_AGE_MIN, 0),
+		EC_RES_ACCESS_DENIED, "%d");
+	TEST_EQ(battery_cache_set_param(CS_PARAM_BATT_REFRESH_MIN +
+					CS_NUM_BATT_PARAMS, 0),
+		EC_RES_INVALID_PARAM, "%d");
+	TEST_EQ(battery_cache_get_param(CS_PARAM_BATT_AGE_MIN +
+					CS_NUM_BATT_PARAMS, &val),
+		EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_param_cache_unresponsive(void)
+{
+	uint32_t val;
+	int num_reads;
+
+	disable_cache();
+	reset_and_fail_on(0, 0);
+	battery_get_params(&batt);
+	num_reads = read_count;
+
+	/* Warm the cache for every field that has a refresh period */
+	TEST_EQ(battery_cache_set_period(CS_BATT_TEMPERATURE, 60000),
+		EC_SUCCESS, "%d");
+	TEST_EQ(battery_cache_set_period(CS_BATT_FULL_CAPACITY, 60000),
+		EC_SUCCESS, "%d");
+	battery_cache_invalidate();
+	reset_and_fail_on(0, 0);
+	battery_get_params(&batt);
+	TEST_ASSERT(batt.flags & BATT_FLAG_RESPONSIVE);
+
+	/* Cached values alone don't make a silent battery responsive */
+	reset_and_fail_on(0, 9999);
+	battery_get_params(&batt);
+	TEST_LT(read_count, num_reads, "%d");
+	TEST_ASSERT(!(batt.flags & BATT_FLAG_RESPONSIVE));
+
+	/* And the failure dropped the cache, so nothing stale is reused */
+	TEST_EQ(battery_cache_get_param(CS_PARAM_BATT_AGE_MIN +
+					CS_BATT_FULL_CAPACITY, &val),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(val, CS_BATT_AGE_NEVER, "0x%x");
+	reset_and_fail_on(0, 0);
+	battery_get_params(&batt);
+	TEST_EQ(read_count, num_reads, "%d");
+	TEST_ASSERT(batt.flags & BATT_FLAG_RESPONSIVE);
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	RUN_TEST(test_param_failures);
+	RUN_TEST(test_param_cache);
+	RUN_TEST(test_param_cache_unresponsive);
 
 	test_print_result();
 }
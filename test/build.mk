@@ -39,6 +39,7 @@ test-list-host += fpsensor_state
 test-list-host += gyro_cal
 test-list-host += hooks
 test-list-host += host_command
+test-list-host += i2c_async
 test-list-host += i2c_bitbang
 test-list-host += inductive_charging
 test-list-host += interrupt
@@ -66,6 +67,8 @@ test-list-host += printf
 test-list-host += queue
 test-list-host += rsa
 test-list-host += rsa3
+test-list-host += rsa3072
+test-list-host += rsa3072_3
 test-list-host += rtc
 test-list-host += sbs_charging_v2
 test-list-host += sha256
@@ -148,6 +151,7 @@ fpsensor_state-y=fpsensor_state.o
 gyro_cal-y=gyro_cal.o
 hooks-y=hooks.o
 host_command-y=host_command.o
+i2c_async-y=i2c_async.o
 i2c_bitbang-y=i2c_bitbang.o
 inductive_charging-y=inductive_charging.o
 interrupt-y=interrupt.o
@@ -178,6 +182,8 @@ rollback-y=rollback.o
 rollback_entropy-y=rollback_entropy.o
 rsa-y=rsa.o
 rsa3-y=rsa.o
+rsa3072-y=rsa.o
+rsa3072_3-y=rsa.o
 rtc-y=rtc.o
 scratchpad-y=scratchpad.o
 sbs_charging-y=sbs_charging.o
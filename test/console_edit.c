@@ -7,6 +7,7 @@
 
 #include "common.h"
 #include "console.h"
+#include "link_defs.h"
 #include "test_util.h"
 #include "timer.h"
 #include "util.h"
@@ -247,6 +248,82 @@ static int test_history_list(void)
 	return EC_SUCCESS;
 }
 
+static int test_cmds_sorted(void)
+{
+	const struct console_command *cmd;
+
+	/* find_command() relies on this to binary search the commands */
+	for (cmd = __cmds + 1; cmd < __cmds_end; cmd++)
+		TEST_ASSERT(strcasecmp(cmd[-1].name, cmd->name) < 0);
+
+	return EC_SUCCESS;
+}
+
+static int test_find_command(void)
+{
+	cmd_1_call_cnt = 0;
+	cmd_2_call_cnt = 0;
+
+	/* Ambiguous prefix runs nothing */
+	UART_INJECT("test\n");
+	msleep(30);
+	TEST_ASSERT(cmd_1_call_cnt == 0 && cmd_2_call_cnt == 0);
+
+	/* Full names, in any case */
+	UART_INJECT("test2\n");
+	msleep(30);
+	UART_INJECT("TEST1\n");
+	msleep(30);
+	TEST_ASSERT(cmd_1_call_cnt == 1 && cmd_2_call_cnt == 1);
+
+	/* Unique prefix, and a prefix of nothing */
+	test_capture_console(1);
+	UART_INJECT("histor\n");
+	msleep(30);
+	UART_INJECT("zzz\n");
+	msleep(30);
+	test_capture_console(0);
+	TEST_ASSERT(compare_multiline_string(test_get_captured_console(),
+		"histor\n"
+		"test\ntest2\nTEST1\nhistor\n"
+		"> zzz\n"
+		"Command 'zzz' not found or ambiguous.\n"
+		"> ") == 0);
+
+	return EC_SUCCESS;
+}
+
+static int test_batch(void)
+{
+	const char *exp_output = "test1\n" /* Input echo, no prompts between */
+				 "test2\n"
+				 "test1\n"
+				 "> ";
+
+	cmd_1_call_cnt = 0;
+	cmd_2_call_cnt = 0;
+	test_capture_console(1);
+	UART_INJECT("test1\ntest2\ntest1\n");
+	msleep(30);
+	test_capture_console(0);
+	TEST_ASSERT(cmd_1_call_cnt == 2 && cmd_2_call_cnt == 1);
+	TEST_ASSERT(compare_multiline_string(test_get_captured_console(),
+					     exp_output) == 0);
+
+	/* A partial line after the batch is redrawn behind the prompt */
+	test_capture_console(1);
+	UART_INJECT("test2\ntes");
+	msleep(30);
+	test_capture_console(0);
+	TEST_ASSERT(compare_multiline_string(test_get_captured_console(),
+					     "test2\ntes> tes") == 0);
+	UART_INJECT("t1\n");
+	msleep(30);
+	TEST_ASSERT(cmd_1_call_cnt == 3 && cmd_2_call_cnt == 2);
+
+	return EC_SUCCESS;
+}
+
 static int test_output_channel(void)
 {
 	UART_INJECT("chan save\n");
@@ -289,6 +366,9 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_history_edit);
 	RUN_TEST(test_history_stash);
 	RUN_TEST(test_history_list);
+	RUN_TEST(test_cmds_sorted);
+	RUN_TEST(test_find_command);
+	RUN_TEST(test_batch);
 	RUN_TEST(test_output_channel);
 
 	test_print_result();
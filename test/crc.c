@@ -64,6 +64,70 @@ static int test_kat0(void)
 	return EC_SUCCESS;
 }
 
+// test that the multi-byte path matches byte at a time, for every length and
+// alignment around the slice size
+static int test_buf(void)
+{
+	uint8_t buf[64];
+	uint32_t crc, ref;
+	int offset, len, i;
+
+	for (i = 0; i < sizeof(buf); i++)
+		buf[i] = i * 37 + 11;
+
+	for (offset = 0; offset < 8; offset++) {
+		for (len = 0; len + offset <= sizeof(buf); len++) {
+			crc32_ctx_init(&ref);
+			for (i = 0; i < len; i++)
+				crc32_ctx_hash8(&ref, buf[offset + i]);
+
+			crc32_ctx_init(&crc);
+			crc32_ctx_hash_buf(&crc, buf + offset, len);
+
+			TEST_ASSERT(crc32_ctx_result(&crc) ==
+				    crc32_ctx_result(&ref));
+		}
+	}
+
+	crc32_init();
+	crc32_hash_buf("The quick brown fox jumps over the lazy dog", 43);
+	TEST_ASSERT(crc32_result() == 0x414fa339);
+
+	return EC_SUCCESS;
+}
+
+#ifdef EMU_BUILD
+// compare throughput of byte at a time and the multi-byte path
+static int test_throughput(void)
+{
+	static uint8_t buf[64 * 1024];
+	uint32_t crc_byte, crc_buf;
+	uint64_t t0, t1, t2;
+	int i;
+
+	for (i = 0; i < sizeof(buf); i++)
+		buf[i] = i;
+
+	t0 = test_host_time_ns();
+	crc32_ctx_init(&crc_byte);
+	for (i = 0; i < sizeof(buf); i++)
+		crc32_ctx_hash8(&crc_byte, buf[i]);
+	t1 = test_host_time_ns();
+	crc32_ctx_init(&crc_buf);
+	crc32_ctx_hash_buf(&crc_buf, buf, sizeof(buf));
+	t2 = test_host_time_ns();
+
+	ccprintf("crc32 %d KB: byte %d us, sliced %d us\n",
+		 (int)(sizeof(buf) / 1024), (int)((t1 - t0) / 1000),
+		 (int)((t2 - t1) / 1000));
+
+	TEST_ASSERT(crc32_ctx_result(&crc_byte) ==
+		    crc32_ctx_result(&crc_buf));
+
+	return EC_SUCCESS;
+}
+#endif
+
 static int test_cros_crc8(void)
 {
 	uint8_t buffer[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 8 };
@@ -83,6 +147,10 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_static_version);
 	RUN_TEST(test_8);
 	RUN_TEST(test_kat0);
+	RUN_TEST(test_buf);
+#ifdef EMU_BUILD
+	RUN_TEST(test_throughput);
+#endif
 	RUN_TEST(test_cros_crc8);
 
 	test_print_result();
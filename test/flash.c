@@ -11,6 +11,9 @@
 #include "gpio.h"
 #include "hooks.h"
 #include "host_command.h"
+#ifdef EMU_BUILD
+#include "persistence.h"
+#endif
 #include "system.h"
 #include "task.h"
 #include "test_util.h"
@@ -36,6 +39,9 @@ int system_unsafe_to_overwrite(uint32_t offset, uint32_t size)
 {
 	return mock_is_running_img;
 }
+
+/* Scratch bank for the persistent storage tests, outside of RO */
+#define PERSIST_TEST_OFF (CONFIG_FLASH_SIZE - CONFIG_FLASH_BANK_SIZE)
 #endif
 
 /*****************************************************************************/
@@ -433,6 +439,116 @@ static int test_boot_no_write_protect(void)
 	return EC_SUCCESS;
 }
 
+#ifdef EMU_BUILD
+/* Read back |size| bytes at |offset| of the flash storage file. */
+static int read_flash_storage(int offset, int size, char *out)
+{
+	FILE *f = get_persistent_storage("flash", "rb");
+	int rv;
+
+	if (f == NULL)
+		return EC_ERROR_UNKNOWN;
+	rv = fseek(f, offset, SEEK_SET) || fread(out, size, 1, f) != 1;
+	release_persistent_storage(f);
+	return rv ? EC_ERROR_UNKNOWN : EC_SUCCESS;
+}
+
+static int flash_storage_size(void)
+{
+	FILE *f = get_persistent_storage("flash", "rb");
+	int size;
+
+	if (f == NULL)
+		return -1;
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	release_persistent_storage(f);
+	return size;
+}
+
+/* Whether a plain store to the emulated flash reaches the storage file */
+static int flash_storage_is_mapped(void)
+{
+	char c;
+
+	__host_flash[PERSIST_TEST_OFF] ^= 0xff;
+	if (read_flash_storage(PERSIST_TEST_OFF, 1, &c))
+		return 0;
+	return c == __host_flash[PERSIST_TEST_OFF];
+}
+
+static int test_persist_mapped(void)
+{
+	char buf[16];
+
+	/* The storage written by the previous steps is mapped at boot */
+	TEST_EQ(flash_storage_size(), CONFIG_FLASH_SIZE, "%d");
+	TEST_ASSERT(flash_storage_is_mapped());
+
+	/* A write only touches memory, and is in the storage right away */
+	TEST_ASSERT(flash_physical_write(PERSIST_TEST_OFF, strlen(testdata),
+					 testdata) == EC_SUCCESS);
+	TEST_ASSERT(read_flash_storage(PERSIST_TEST_OFF, sizeof(buf), buf) ==
+		    EC_SUCCESS);
+	TEST_ASSERT_ARRAY_EQ(buf, testdata, sizeof(buf));
+
+	return EC_SUCCESS;
+}
+
+static int test_persist_reboot(void)
+{
+	FILE *f;
+	int sz;
+
+	/* The write from the previous step survived the reboot */
+	TEST_ASSERT_ARRAY_EQ(__host_flash + PERSIST_TEST_OFF, testdata,
+			     strlen(testdata));
+
+	/*
+	 * Replace the storage with one of the wrong size for the next step.
+	 * The old file is unlinked rather than truncated, as it is still
+	 * mapped here.
+	 */
+	remove_persistent_storage("flash");
+	f = get_persistent_storage("flash", "wb");
+	TEST_ASSERT(f != NULL);
+	sz = fwrite(__host_flash, sizeof(__host_flash), 1, f);
+	sz += fwrite(__host_flash, CONFIG_FLASH_BANK_SIZE, 1, f);
+	release_persistent_storage(f);
+	TEST_EQ(sz, 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_persist_size_mismatch(void)
+{
+	/* The image was read with fread() instead of being mapped */
+	TEST_EQ(flash_storage_size(), CONFIG_FLASH_SIZE + CONFIG_FLASH_BANK_SIZE,
+		"%d");
+	TEST_ASSERT_ARRAY_EQ(__host_flash + PERSIST_TEST_OFF, testdata,
+			     strlen(testdata));
+	TEST_ASSERT(!flash_storage_is_mapped());
+
+	return EC_SUCCESS;
+}
+
+static int test_persist_first_write_seeds(void)
+{
+	static char image[CONFIG_FLASH_SIZE];
+
+	/* The first write recreates the storage from memory, and maps it */
+	TEST_ASSERT(flash_physical_erase(PERSIST_TEST_OFF,
+					 CONFIG_FLASH_ERASE_SIZE) ==
+		    EC_SUCCESS);
+	TEST_EQ(flash_storage_size(), CONFIG_FLASH_SIZE, "%d");
+	TEST_ASSERT(read_flash_storage(0, sizeof(image), image) == EC_SUCCESS);
+	TEST_ASSERT_ARRAY_EQ(image, __host_flash, sizeof(image));
+	TEST_ASSERT(flash_storage_is_mapped());
+
+	return EC_SUCCESS;
+}
+#endif
+
 int test_clean_up_(void)
 {
 	SET_WP_FLAGS(EC_FLASH_PROTECT_RO_AT_BOOT, 0);
@@ -477,12 +593,40 @@ static void run_test_step2(void)
 static void run_test_step3(void)
 {
 	RUN_TEST(test_boot_no_write_protect);
+#ifdef EMU_BUILD
+	RUN_TEST(test_persist_mapped);
+#endif
+
+	if (test_get_error_count())
+		test_reboot_to_next_step(TEST_STATE_FAILED);
+	else if (IS_ENABLED(EMU_BUILD))
+		test_reboot_to_next_step(TEST_STATE_STEP_4);
+	else
+		test_reboot_to_next_step(TEST_STATE_PASSED);
+}
+
+#ifdef EMU_BUILD
+static void run_test_step4(void)
+{
+	RUN_TEST(test_persist_reboot);
+
+	if (test_get_error_count())
+		test_reboot_to_next_step(TEST_STATE_FAILED);
+	else
+		test_reboot_to_next_step(TEST_STATE_STEP_5);
+}
+
+static void run_test_step5(void)
+{
+	RUN_TEST(test_persist_size_mismatch);
+	RUN_TEST(test_persist_first_write_seeds);
 
 	if (test_get_error_count())
 		test_reboot_to_next_step(TEST_STATE_FAILED);
 	else
 		test_reboot_to_next_step(TEST_STATE_PASSED);
 }
+#endif
 
 void test_run_step(uint32_t state)
 {
@@ -492,6 +636,12 @@ void test_run_step(uint32_t state)
 		run_test_step2();
 	else if (state & TEST_STATE_MASK(TEST_STATE_STEP_3))
 		run_test_step3();
+#ifdef EMU_BUILD
+	else if (state & TEST_STATE_MASK(TEST_STATE_STEP_4))
+		run_test_step4();
+	else if (state & TEST_STATE_MASK(TEST_STATE_STEP_5))
+		run_test_step5();
+#endif
 }
 
 int task_test(void *data)
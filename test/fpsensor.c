@@ -7,7 +7,11 @@
 #include <stdbool.h>
 
 #include "ec_commands.h"
+#include "fpsensor_state.h"
+#include "host_command.h"
 #include "mock/fpsensor_detect_mock.h"
+#include "mock/fpsensor_state_mock.h"
+#include "mock/timer_mock.h"
 #include "string.h"
 #include "test_util.h"
 #include "common/fpsensor/fpsensor_private.h"
@@ -46,6 +50,81 @@ test_static int test_validate_fp_buffer_offset_failure_overflow(void)
 	return EC_SUCCESS;
 }
 
+/* Send EC_CMD_FP_STATS, and return the size of the response in *size. */
+static int fp_stats_cmd(int version, struct ec_response_fp_stats *r,
+			int *size)
+{
+	struct host_cmd_handler_args args = {
+		.command = EC_CMD_FP_STATS,
+		.version = version,
+		.response = r,
+		.response_max = sizeof(*r),
+	};
+	int rv;
+
+	memset(r, 0, sizeof(*r));
+	rv = host_command_process(&args);
+	*size = args.response_size;
+	return rv;
+}
+
+test_static int test_fp_stats_frame_upload(void)
+{
+	struct ec_params_fp_frame frame = {
+		.offset = FP_FRAME_INDEX_TEMPLATE << FP_FRAME_INDEX_SHIFT,
+		.size = sizeof(fp_enc_buffer) / 2,
+	};
+	struct ec_params_fp_seed seed = {
+		.struct_version = FP_TEMPLATE_FORMAT_VERSION,
+	};
+	static uint8_t chunk[sizeof(fp_enc_buffer)];
+	struct ec_response_fp_stats r;
+	timestamp_t now = { .val = 10 * SECOND };
+	int size;
+
+	/* Version 0 keeps its old size, version 1 appends the upload stats */
+	TEST_EQ(fp_stats_cmd(0, &r, &size), EC_RES_SUCCESS, "%d");
+	TEST_EQ(size, (int)sizeof(struct ec_response_fp_stats_v0), "%d");
+	TEST_EQ(fp_stats_cmd(1, &r, &size), EC_RES_SUCCESS, "%d");
+	TEST_EQ(size, (int)sizeof(struct ec_response_fp_stats), "%d");
+
+	/* Upload an encrypted template in 2 chunks, 250 us apart */
+	memcpy(seed.seed, default_fake_tpm_seed, sizeof(seed.seed));
+	TEST_EQ(test_send_host_command(EC_CMD_FP_SEED, 0, &seed, sizeof(seed),
+				       NULL, 0),
+		EC_RES_SUCCESS, "%d");
+	templ_valid = 1;
+
+	set_time(now);
+	TEST_EQ(test_send_host_command(EC_CMD_FP_FRAME, 0, &frame,
+				       sizeof(frame), chunk, sizeof(chunk)),
+		EC_RES_SUCCESS, "%d");
+	now.val += 250;
+	set_time(now);
+	frame.offset += frame.size;
+	TEST_EQ(test_send_host_command(EC_CMD_FP_FRAME, 0, &frame,
+				       sizeof(frame), chunk, sizeof(chunk)),
+		EC_RES_SUCCESS, "%d");
+
+	TEST_EQ(fp_stats_cmd(1, &r, &size), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r.frame_upload_chunks, 2, "%d");
+	TEST_EQ(r.frame_upload_time_us, 250, "%d");
+
+	/* The next upload starts over at offset 0 */
+	now.val += SECOND;
+	set_time(now);
+	frame.offset = FP_FRAME_INDEX_TEMPLATE << FP_FRAME_INDEX_SHIFT;
+	TEST_EQ(test_send_host_command(EC_CMD_FP_FRAME, 0, &frame,
+				       sizeof(frame), chunk, sizeof(chunk)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(fp_stats_cmd(1, &r, &size), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r.frame_upload_chunks, 1, "%d");
+	TEST_EQ(r.frame_upload_time_us, 0, "%d");
+
+	templ_valid = 0;
+	return EC_SUCCESS;
+}
+
 test_static int test_host_command_protocol_info(
 	enum fp_transport_type transport_type,
 	const struct ec_response_get_protocol_info *expected)
@@ -94,6 +173,7 @@ void run_test(int argc, char **argv)
 		RUN_TEST(test_validate_fp_buffer_offset_success);
 		RUN_TEST(test_validate_fp_buffer_offset_failure_no_overflow);
 		RUN_TEST(test_validate_fp_buffer_offset_failure_overflow);
+		RUN_TEST(test_fp_stats_frame_upload);
 	}
 
 	/* The tests after this only work on device right now. */
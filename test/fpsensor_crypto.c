@@ -614,9 +614,178 @@ test_static int test_command_read_match_secret_unreadable(void)
 	return EC_SUCCESS;
 }
 
+/* Test Case 3 from the GCM specification. */
+static const uint8_t gcm_key[] = {
+	0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c,
+	0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08,
+};
+static const uint8_t gcm_nonce[FP_CONTEXT_NONCE_BYTES] = {
+	0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad,
+	0xde, 0xca, 0xf8, 0x88,
+};
+static const uint8_t gcm_plaintext[] = {
+	0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5,
+	0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+	0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda,
+	0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+	0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+	0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+	0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57,
+	0xba, 0x63, 0x7b, 0x39, 0x1a, 0xaf, 0xd2, 0x55,
+};
+static const uint8_t gcm_ciphertext[] = {
+	0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24,
+	0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+	0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0,
+	0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+	0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c,
+	0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+	0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97,
+	0x3d, 0x58, 0xe0, 0x91, 0x47, 0x3f, 0x59, 0x85,
+};
+static const uint8_t gcm_tag[FP_CONTEXT_TAG_BYTES] = {
+	0x4d, 0x5c, 0x2a, 0xf3, 0x27, 0xcd, 0x64, 0xa6,
+	0x2c, 0xf3, 0x5a, 0xbd, 0x2b, 0xa6, 0xfa, 0xb4,
+};
+
+/* Stands in for a hardware backend that can't handle any AES-GCM request. */
+static int unimplemented_aes_gcm_encrypt(const uint8_t *key, int key_size,
+					 const uint8_t *plaintext,
+					 uint8_t *ciphertext, int text_size,
+					 const uint8_t *nonce, int nonce_size,
+					 uint8_t *tag, int tag_size)
+{
+	return EC_ERROR_UNIMPLEMENTED;
+}
+
+static int unimplemented_aes_gcm_decrypt(const uint8_t *key, int key_size,
+					 uint8_t *plaintext,
+					 const uint8_t *ciphertext,
+					 int text_size, const uint8_t *nonce,
+					 int nonce_size, const uint8_t *tag,
+					 int tag_size)
+{
+	return EC_ERROR_UNIMPLEMENTED;
+}
+
+static const struct fp_crypto_backend unimplemented_backend = {
+	.name = "unimplemented",
+	.aes_gcm_encrypt = unimplemented_aes_gcm_encrypt,
+	.aes_gcm_decrypt = unimplemented_aes_gcm_decrypt,
+	.hmac_sha256 = hmac_SHA256,
+};
+
+/* The second one checks the fallback to software. */
+static const struct fp_crypto_backend *const backends[] = {
+	&fp_crypto_sw,
+	&unimplemented_backend,
+};
+
+test_static int test_aes_gcm(void)
+{
+	uint8_t text[sizeof(gcm_plaintext)];
+	uint8_t tag[FP_CONTEXT_TAG_BYTES];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(backends); i++) {
+		fp_crypto_set_backend(backends[i]);
+
+		TEST_ASSERT(aes_gcm_encrypt(gcm_key, sizeof(gcm_key),
+					    gcm_plaintext, text, sizeof(text),
+					    gcm_nonce, sizeof(gcm_nonce),
+					    tag, sizeof(tag)) == EC_SUCCESS);
+		TEST_ASSERT_ARRAY_EQ(text, gcm_ciphertext, sizeof(text));
+		TEST_ASSERT_ARRAY_EQ(tag, gcm_tag, sizeof(tag));
+
+		/* Decrypt in-place, as the template upload path does. */
+		TEST_ASSERT(aes_gcm_decrypt(gcm_key, sizeof(gcm_key), text,
+					    text, sizeof(text),
+					    gcm_nonce, sizeof(gcm_nonce),
+					    tag, sizeof(tag)) == EC_SUCCESS);
+		TEST_ASSERT_ARRAY_EQ(text, gcm_plaintext, sizeof(text));
+
+		/* A modified tag must be rejected. */
+		tag[0] ^= 1;
+		TEST_ASSERT(aes_gcm_decrypt(gcm_key, sizeof(gcm_key), text,
+					    gcm_ciphertext, sizeof(text),
+					    gcm_nonce, sizeof(gcm_nonce),
+					    tag, sizeof(tag)) != EC_SUCCESS);
+
+		/* The nonce size is checked before reaching the backend. */
+		TEST_ASSERT(aes_gcm_encrypt(gcm_key, sizeof(gcm_key),
+					    gcm_plaintext, text, sizeof(text),
+					    gcm_nonce, sizeof(gcm_nonce) - 1,
+					    tag, sizeof(tag)) ==
+			    EC_ERROR_INVAL);
+	}
+	fp_crypto_set_backend(NULL);
+
+	return EC_SUCCESS;
+}
+
+#ifdef EMU_BUILD
+/*
+ * Time template encryption, decryption and key derivation with the software
+ * backend, as a baseline for any future hardware backend. The sizes are the
+ * encrypted blobs of the FPC1025, FPC1035 and FPC1145 templates.
+ */
+test_static int test_crypto_benchmark(void)
+{
+	static const int sizes[] = {
+		5092 + FP_POSITIVE_MATCH_SALT_BYTES,
+		14380 + FP_POSITIVE_MATCH_SALT_BYTES,
+		47552 + FP_POSITIVE_MATCH_SALT_BYTES,
+	};
+	static uint8_t plaintext[47552 + FP_POSITIVE_MATCH_SALT_BYTES];
+	static uint8_t text[sizeof(plaintext)];
+	static uint8_t ciphertext[sizeof(plaintext)];
+	uint8_t tag[FP_CONTEXT_TAG_BYTES];
+	uint8_t key[SBP_ENC_KEY_LEN];
+	const int rounds = 10;
+	uint64_t t0, t1, t2;
+	int i, k;
+
+	for (i = 0; i < sizeof(plaintext); i++)
+		plaintext[i] = i * 7;
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		t0 = test_host_time_ns();
+		for (k = 0; k < rounds; k++)
+			TEST_ASSERT(aes_gcm_encrypt(gcm_key, sizeof(gcm_key),
+						    plaintext, ciphertext,
+						    sizes[i], gcm_nonce,
+						    sizeof(gcm_nonce), tag,
+						    sizeof(tag)) == EC_SUCCESS);
+		t1 = test_host_time_ns();
+		for (k = 0; k < rounds; k++)
+			TEST_ASSERT(aes_gcm_decrypt(gcm_key, sizeof(gcm_key),
+						    text, ciphertext, sizes[i],
+						    gcm_nonce, sizeof(gcm_nonce),
+						    tag, sizeof(tag)) ==
+				    EC_SUCCESS);
+		t2 = test_host_time_ns();
+		TEST_ASSERT_ARRAY_EQ(text, plaintext, sizes[i]);
+
+		ccprintf("aes-gcm %d bytes: encrypt %d us, decrypt %d us\n",
+			 sizes[i], (int)((t1 - t0) / 1000 / rounds),
+			 (int)((t2 - t1) / 1000 / rounds));
+	}
+
+	t0 = test_host_time_ns();
+	for (k = 0; k < rounds; k++)
+		TEST_ASSERT(derive_encryption_key(key, fake_positive_match_salt)
+			    == EC_SUCCESS);
+	t1 = test_host_time_ns();
+	ccprintf("hkdf: %d us\n", (int)((t1 - t0) / 1000 / rounds));
+
+	return EC_SUCCESS;
+}
+#endif
+
 void run_test(int argc, char **argv)
 {
 	RUN_TEST(test_hkdf_expand);
+	RUN_TEST(test_aes_gcm);
 	RUN_TEST(test_derive_encryption_key_failure_seed_not_set);
 	RUN_TEST(test_derive_positive_match_secret_fail_seed_not_set);
 
@@ -639,5 +808,8 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_command_read_match_secret_wrong_finger);
 	RUN_TEST(test_command_read_match_secret_timeout);
 	RUN_TEST(test_command_read_match_secret_unreadable);
+#ifdef EMU_BUILD
+	RUN_TEST(test_crypto_benchmark);
+#endif
 	test_print_result();
 }
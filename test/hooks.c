@@ -21,12 +21,32 @@ static int second_hook_count;
 static timestamp_t second_time[2];
 static int deferred_call_count;
 
+static int init_hook_order[3];
+static int init_hook_calls;
+
 static void init_hook(void)
 {
 	init_hook_count++;
+	if (init_hook_calls < ARRAY_SIZE(init_hook_order))
+		init_hook_order[init_hook_calls++] = HOOK_PRIO_DEFAULT;
 }
 DECLARE_HOOK(HOOK_INIT, init_hook, HOOK_PRIO_DEFAULT);
 
+/* Declared after init_hook(), but must be called before it */
+static void init_hook_first(void)
+{
+	if (init_hook_calls < ARRAY_SIZE(init_hook_order))
+		init_hook_order[init_hook_calls++] = HOOK_PRIO_FIRST;
+}
+DECLARE_HOOK(HOOK_INIT, init_hook_first, HOOK_PRIO_FIRST);
+
+static void init_hook_last(void)
+{
+	if (init_hook_calls < ARRAY_SIZE(init_hook_order))
+		init_hook_order[init_hook_calls++] = HOOK_PRIO_LAST;
+}
+DECLARE_HOOK(HOOK_INIT, init_hook_last, HOOK_PRIO_LAST);
+
 static void tick_hook(void)
 {
 	tick_hook_count++;
@@ -69,6 +89,10 @@ static const struct deferred_data non_deferred_func_data = {
 static int test_init_hook(void)
 {
 	TEST_ASSERT(init_hook_count == 1);
+	TEST_EQ(init_hook_calls, 3, "%d");
+	TEST_EQ(init_hook_order[0], HOOK_PRIO_FIRST, "%d");
+	TEST_EQ(init_hook_order[1], HOOK_PRIO_DEFAULT, "%d");
+	TEST_EQ(init_hook_order[2], HOOK_PRIO_LAST, "%d");
 	return EC_SUCCESS;
 }
 
@@ -134,6 +158,49 @@ static int test_deferred(void)
 	return EC_SUCCESS;
 }
 
+static int deferred_order[4];
+static int deferred_order_count;
+
+#define DECLARE_ORDERED_DEFERRED(n)					\
+	static void deferred_order_##n(void)				\
+	{								\
+		if (deferred_order_count < ARRAY_SIZE(deferred_order))	\
+			deferred_order[deferred_order_count++] = n;	\
+	}								\
+	DECLARE_DEFERRED(deferred_order_##n)
+
+DECLARE_ORDERED_DEFERRED(1);
+DECLARE_ORDERED_DEFERRED(2);
+DECLARE_ORDERED_DEFERRED(3);
+DECLARE_ORDERED_DEFERRED(4);
+
+static int test_deferred_order(void)
+{
+	deferred_order_count = 0;
+
+	/* Arm out of order, then move deadlines both earlier and later */
+	hook_call_deferred(&deferred_order_3_data, 30 * MSEC);
+	hook_call_deferred(&deferred_order_1_data, 60 * MSEC);
+	hook_call_deferred(&deferred_order_4_data, 20 * MSEC);
+	hook_call_deferred(&deferred_order_2_data, 20 * MSEC);
+	hook_call_deferred(&deferred_order_1_data, 10 * MSEC);
+	hook_call_deferred(&deferred_order_4_data, 40 * MSEC);
+	hook_call_deferred(&deferred_order_2_data, -1);
+	hook_call_deferred(&deferred_order_2_data, 25 * MSEC);
+
+	usleep(15 * MSEC);
+	TEST_EQ(deferred_order_count, 1, "%d");
+
+	usleep(50 * MSEC);
+	TEST_EQ(deferred_order_count, 4, "%d");
+	TEST_EQ(deferred_order[0], 1, "%d");
+	TEST_EQ(deferred_order[1], 2, "%d");
+	TEST_EQ(deferred_order[2], 3, "%d");
+	TEST_EQ(deferred_order[3], 4, "%d");
+
+	return EC_SUCCESS;
+}
+
 static int repeating_deferred_count;
 static void deferred_repeating_func(void);
 DECLARE_DEFERRED(deferred_repeating_func);
@@ -167,6 +234,7 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_ticks);
 	RUN_TEST(test_priority);
 	RUN_TEST(test_deferred);
+	RUN_TEST(test_deferred_order);
 	RUN_TEST(test_repeating_deferred);
 
 	test_print_result();
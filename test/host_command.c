@@ -8,6 +8,7 @@
 #include "common.h"
 #include "console.h"
 #include "host_command.h"
+#include "link_defs.h"
 #include "task.h"
 #include "test_util.h"
 #include "timer.h"
@@ -300,6 +301,83 @@ static int test_hostcmd_clears_unused_data(void)
 	return EC_SUCCESS;
 }
 
+static int test_hostcmd_find_all(void)
+{
+	const struct host_command *cmd;
+	struct ec_params_get_cmd_versions_v1 p;
+	struct ec_response_get_cmd_versions r;
+
+	/* Every registered command must be found through the hash table */
+	for (cmd = __hcmds; cmd < __hcmds_end; cmd++) {
+		p.cmd = cmd->command;
+		TEST_EQ(test_send_host_command(EC_CMD_GET_CMD_VERSIONS, 1,
+					       &p, sizeof(p), &r, sizeof(r)),
+			EC_RES_SUCCESS, "%d");
+		TEST_EQ(r.version_mask, cmd->version_mask, "0x%x");
+	}
+
+	/* And unregistered ones not found */
+	p.cmd = 0xff;
+	TEST_EQ(test_send_host_command(EC_CMD_GET_CMD_VERSIONS, 1,
+				       &p, sizeof(p), &r, sizeof(r)),
+		EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_hostcmd_stats(void)
+{
+	struct ec_params_host_command_stats p = {
+		.flags = EC_HOST_COMMAND_STATS_CLEAR,
+	};
+	struct {
+		struct ec_response_host_command_stats r;
+		struct ec_host_command_stats_entry e[4];
+	} s;
+	struct ec_params_hello hello_p = { .in_data = 0 };
+	struct ec_response_hello hello_r;
+	int i, j, hello = 0, stats = 0;
+
+	TEST_EQ(test_send_host_command(EC_CMD_HOST_COMMAND_STATS, 0, &p,
+				       sizeof(p), &s, sizeof(s)),
+		EC_RES_SUCCESS, "%d");
+
+	for (i = 0; i < 3; i++)
+		TEST_EQ(test_send_host_command(EC_CMD_HELLO, 0, &hello_p,
+					       sizeof(hello_p), &hello_r,
+					       sizeof(hello_r)),
+			EC_RES_SUCCESS, "%d");
+
+	/* The clear itself is counted once it has run */
+	p.flags = 0;
+	TEST_EQ(test_send_host_command(EC_CMD_HOST_COMMAND_STATS, 0, &p,
+				       sizeof(p), &s, sizeof(s)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(s.r.num_cmds, 2, "%d");
+	TEST_EQ(s.r.num_entries, 2, "%d");
+	for (i = 0; i < s.r.num_entries; i++) {
+		for (j = 0; j < EC_HOST_COMMAND_STATS_BUCKETS; j++) {
+			if (s.r.entries[i].command == EC_CMD_HELLO)
+				hello += s.r.entries[i].latency[j];
+			else if (s.r.entries[i].command ==
+				 EC_CMD_HOST_COMMAND_STATS)
+				stats += s.r.entries[i].latency[j];
+		}
+	}
+	TEST_EQ(hello, 3, "%d");
+	TEST_EQ(stats, 1, "%d");
+
+	/* Paging past the first command */
+	p.index = 1;
+	TEST_EQ(test_send_host_command(EC_CMD_HOST_COMMAND_STATS, 0, &p,
+				       sizeof(p), &s, sizeof(s)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(s.r.num_cmds, 2, "%d");
+	TEST_EQ(s.r.num_entries, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	wait_for_task_started();
@@ -315,6 +393,8 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_hostcmd_invalid_checksum);
 	RUN_TEST(test_hostcmd_reuse_response_buffer);
 	RUN_TEST(test_hostcmd_clears_unused_data);
+	RUN_TEST(test_hostcmd_find_all);
+	RUN_TEST(test_hostcmd_stats);
 
 	test_print_result();
 }
@@ -0,0 +1,254 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for queued asynchronous I2C transfers.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "i2c.h"
+#include "task.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define TEST_PORT I2C_PORT_EEPROM
+#define TEST_ADDR_FLAGS 0x33
+#define NACK_ADDR_FLAGS 0x34
+
+#define TEST_EVENT TASK_EVENT_CUSTOM_BIT(0)
+
+/* Log of the first byte written by every transfer the device sees */
+static uint8_t xfer_log[16];
+static int xfer_count;
+
+/* Task that ran the last transfer */
+static task_id_t xfer_task;
+
+static int test_i2c_xfer(int port, uint16_t addr_flags,
+			 const uint8_t *out, int out_size,
+			 uint8_t *in, int in_size, int flags)
+{
+	int i;
+
+	if (port != TEST_PORT)
+		return EC_ERROR_INVAL;
+
+	if (addr_flags == NACK_ADDR_FLAGS)
+		return EC_ERROR_BUSY;
+
+	if (addr_flags != TEST_ADDR_FLAGS)
+		return EC_ERROR_INVAL;
+
+	if (out_size && xfer_count < ARRAY_SIZE(xfer_log))
+		xfer_log[xfer_count] = out[0];
+	xfer_count++;
+	xfer_task = task_get_current();
+
+	/* Reads return the written byte plus the offset into the read */
+	for (i = 0; i < in_size; i++)
+		in[i] = (out_size ? out[0] : 0) + i;
+
+	return EC_SUCCESS;
+}
+DECLARE_TEST_I2C_XFER(test_i2c_xfer);
+
+static const uint8_t cmd[] = { 0x10, 0x20, 0x30, 0x40 };
+
+static int wait_done(void)
+{
+	uint32_t evt = task_wait_event_mask(TEST_EVENT, SECOND);
+
+	return (evt & TEST_EVENT) ? EC_SUCCESS : EC_ERROR_TIMEOUT;
+}
+
+static void init_req(struct i2c_async_req *req,
+		     const struct i2c_async_op *ops, int count)
+{
+	memset(req, 0, sizeof(*req));
+	req->port = TEST_PORT;
+	req->ops = ops;
+	req->count = count;
+	req->task = task_get_current();
+	req->event = TEST_EVENT;
+}
+
+static int test_list_runs_in_order(void)
+{
+	uint8_t in[2];
+	const struct i2c_async_op ops[] = {
+		{ TEST_ADDR_FLAGS, &cmd[0], 1, NULL, 0 },
+		{ TEST_ADDR_FLAGS, &cmd[1], 1, NULL, 0 },
+		{ TEST_ADDR_FLAGS, &cmd[2], 1, in, sizeof(in) },
+	};
+	struct i2c_async_req req;
+
+	init_req(&req, ops, ARRAY_SIZE(ops));
+	TEST_EQ(i2c_xfer_submit(&req), EC_SUCCESS, "%d");
+	TEST_EQ(wait_done(), EC_SUCCESS, "%d");
+
+	TEST_ASSERT(!i2c_xfer_busy(&req));
+	TEST_EQ(req.rv, EC_SUCCESS, "%d");
+	TEST_EQ(xfer_count, 3, "%d");
+	TEST_EQ(xfer_log[0], cmd[0], "%d");
+	TEST_EQ(xfer_log[1], cmd[1], "%d");
+	TEST_EQ(xfer_log[2], cmd[2], "%d");
+	TEST_EQ(in[0], cmd[2], "%d");
+	TEST_EQ(in[1], cmd[2] + 1, "%d");
+
+	/* The transfers did not run in the submitting task */
+	TEST_EQ(xfer_task, TASK_ID_HOOKS, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_list_stops_on_error(void)
+{
+	const struct i2c_async_op ops[] = {
+		{ TEST_ADDR_FLAGS, &cmd[0], 1, NULL, 0 },
+		{ NACK_ADDR_FLAGS, &cmd[1], 1, NULL, 0 },
+		{ TEST_ADDR_FLAGS, &cmd[2], 1, NULL, 0 },
+	};
+	struct i2c_async_req req;
+
+	init_req(&req, ops, ARRAY_SIZE(ops));
+	TEST_EQ(i2c_xfer_submit(&req), EC_SUCCESS, "%d");
+	TEST_EQ(wait_done(), EC_SUCCESS, "%d");
+
+	TEST_EQ(req.rv, EC_ERROR_BUSY, "%d");
+	TEST_EQ(xfer_count, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_bad_requests(void)
+{
+	const struct i2c_async_op op = { TEST_ADDR_FLAGS, &cmd[0], 1, NULL, 0 };
+	struct i2c_async_req req;
+
+	init_req(&req, &op, 0);
+	TEST_EQ(i2c_xfer_submit(&req), EC_ERROR_INVAL, "%d");
+
+	init_req(&req, &op, 1);
+	req.port = -1;
+	TEST_EQ(i2c_xfer_submit(&req), EC_ERROR_INVAL, "%d");
+
+	/* A queued request can't be submitted again until it completes */
+	init_req(&req, &op, 1);
+	TEST_EQ(i2c_xfer_submit(&req), EC_SUCCESS, "%d");
+	TEST_EQ(i2c_xfer_submit(&req), EC_ERROR_BUSY, "%d");
+	TEST_EQ(wait_done(), EC_SUCCESS, "%d");
+	TEST_EQ(xfer_count, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static struct i2c_async_req chained;
+static int done_count;
+static int done_blocking_rv;
+
+static void chain_done(struct i2c_async_req *req)
+{
+	done_count++;
+
+	/* The port lock is not held here, so the blocking API works */
+	done_blocking_rv = i2c_xfer(TEST_PORT, TEST_ADDR_FLAGS,
+				    &cmd[3], 1, NULL, 0);
+
+	/* ... and so does queueing more work */
+	if (req != &chained)
+		i2c_xfer_submit(&chained);
+}
+
+static int test_queued_requests(void)
+{
+	const struct i2c_async_op op[] = {
+		{ TEST_ADDR_FLAGS, &cmd[0], 1, NULL, 0 },
+		{ TEST_ADDR_FLAGS, &cmd[1], 1, NULL, 0 },
+		{ TEST_ADDR_FLAGS, &cmd[2], 1, NULL, 0 },
+	};
+	struct i2c_async_req req[2];
+
+	init_req(&req[0], &op[0], 1);
+	init_req(&req[1], &op[1], 1);
+	init_req(&chained, &op[2], 1);
+	req[0].event = 0;
+	req[1].done = chain_done;
+	req[1].event = 0;
+	chained.done = chain_done;
+
+	TEST_EQ(i2c_xfer_submit(&req[0]), EC_SUCCESS, "%d");
+	TEST_EQ(i2c_xfer_submit(&req[1]), EC_SUCCESS, "%d");
+	TEST_EQ(wait_done(), EC_SUCCESS, "%d");
+
+	TEST_EQ(done_count, 2, "%d");
+	TEST_EQ(done_blocking_rv, EC_SUCCESS, "%d");
+	TEST_EQ(xfer_count, 5, "%d");
+	TEST_EQ(xfer_log[0], cmd[0], "%d");
+	TEST_EQ(xfer_log[1], cmd[1], "%d");
+	TEST_EQ(xfer_log[2], cmd[3], "%d");
+	TEST_EQ(xfer_log[3], cmd[2], "%d");
+	TEST_EQ(xfer_log[4], cmd[3], "%d");
+
+	return EC_SUCCESS;
+}
+
+/* Requests in the order their completions ran */
+static struct i2c_async_req *done_order[3];
+
+static void order_done(struct i2c_async_req *req)
+{
+	if (done_count < ARRAY_SIZE(done_order))
+		done_order[done_count] = req;
+	done_count++;
+}
+
+static int test_completion_order(void)
+{
+	const struct i2c_async_op op = { TEST_ADDR_FLAGS, &cmd[0], 1, NULL, 0 };
+	struct i2c_async_req req[3];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(req); i++) {
+		init_req(&req[i], &op, 1);
+		req[i].done = order_done;
+		req[i].event = 0;
+	}
+	req[ARRAY_SIZE(req) - 1].event = TEST_EVENT;
+
+	for (i = 0; i < ARRAY_SIZE(req); i++)
+		TEST_EQ(i2c_xfer_submit(&req[i]), EC_SUCCESS, "%d");
+	TEST_EQ(wait_done(), EC_SUCCESS, "%d");
+
+	/* All ran in one pass of the worker, and completed first in first */
+	TEST_EQ(xfer_count, 3, "%d");
+	TEST_EQ(done_count, 3, "%d");
+	for (i = 0; i < ARRAY_SIZE(req); i++)
+		TEST_ASSERT(done_order[i] == &req[i]);
+
+	return EC_SUCCESS;
+}
+
+void before_test(void)
+{
+	memset(xfer_log, 0, sizeof(xfer_log));
+	xfer_count = 0;
+	xfer_task = TASK_ID_INVALID;
+	done_count = 0;
+	done_blocking_rv = EC_ERROR_UNKNOWN;
+	memset(done_order, 0, sizeof(done_order));
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_list_runs_in_order);
+	RUN_TEST(test_list_stops_on_error);
+	RUN_TEST(test_bad_requests);
+	RUN_TEST(test_queued_requests);
+	RUN_TEST(test_completion_order);
+
+	test_print_result();
+}
@@ -33,6 +33,7 @@
 
 static uint8_t mock_state[KEYBOARD_COLS_MAX];
 static int column_driven;
+static int scan_count;
 static int fifo_add_count;
 static int lid_open;
 #ifdef EMU_BUILD
@@ -58,6 +59,9 @@ int lid_is_open(void)
 
 void keyboard_raw_drive_column(int out)
 {
+	/* Every scan of the matrix starts by driving column 0 */
+	if (out == 0)
+		scan_count++;
 	column_driven = out;
 }
 
@@ -95,6 +99,10 @@ void chipset_reset(void)
 }
 #endif
 
+/* Volume up can be moved at runtime; the test uses its default position. */
+#define KEYBOARD_ROW_VOL_UP KEYBOARD_DEFAULT_ROW_VOL_UP
+#define KEYBOARD_COL_VOL_UP KEYBOARD_DEFAULT_COL_VOL_UP
+
 #define mock_defined_key(k, p) mock_key(KEYBOARD_ROW_ ## k, \
 					KEYBOARD_COL_ ## k, \
 					p)
@@ -201,6 +209,143 @@ static int deghost_test(void)
 	return EC_SUCCESS;
 }
 
+static int ghost_mask_test(void)
+{
+	/* (0, 2) (0, 8) (6, 2) (6, 8) ghost even though they are far apart */
+	mock_key(0, 2, 1);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(6, 8, 1);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(0, 8, 1);
+	mock_key(6, 2, 1);
+	TEST_ASSERT(expect_no_keychange() == EC_SUCCESS);
+	mock_key(0, 8, 0);
+	mock_key(6, 2, 0);
+	TEST_ASSERT(expect_no_keychange() == EC_SUCCESS);
+	mock_key(6, 8, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(0, 2, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+
+	/*
+	 * (0, 0) is not a key on this keyboard, so the rectangle it completes
+	 * with (0, 1) (3, 0) (3, 1) is not ambiguous.
+	 */
+	mock_key(0, 1, 1);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(3, 1, 1);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(0, 0, 1);
+	mock_key(3, 0, 1);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(0, 0, 0);
+	mock_key(3, 0, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(3, 1, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(0, 1, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+
+	return EC_SUCCESS;
+}
+
+static int transitional_ghost_test(void)
+{
+	/* (1, 1) (2, 1) share a column, which is not ghosting */
+	mock_key(1, 1, 1);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(2, 1, 1);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+
+	/*
+	 * Column 3 reads only (1, 3), as if it were sampled before the ghost
+	 * at (2, 3) showed up.  It shares row 1 with column 1, so it is merged
+	 * into (1, 3) (2, 3), and the four keys are then rejected as ghosts.
+	 */
+	mock_key(1, 3, 1);
+	TEST_ASSERT(expect_no_keychange() == EC_SUCCESS);
+	mock_key(1, 3, 0);
+	TEST_ASSERT(expect_no_keychange() == EC_SUCCESS);
+
+	/*
+	 * Merging repeats until stable: (2, 4) pulls column 4 into column 1's
+	 * rows, and (3, 4) then pulls row 3 back into column 1.
+	 */
+	mock_key(2, 4, 1);
+	mock_key(3, 4, 1);
+	TEST_ASSERT(expect_no_keychange() == EC_SUCCESS);
+	mock_key(2, 4, 0);
+	mock_key(3, 4, 0);
+	TEST_ASSERT(expect_no_keychange() == EC_SUCCESS);
+
+	mock_key(2, 1, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(1, 1, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+
+	return EC_SUCCESS;
+}
+
+static int held_backoff_test(void)
+{
+	struct keyboard_scan_config *config = keyboard_scan_get_config();
+	uint16_t held_scan_period_us = config->held_scan_period_us;
+	int steady_scans, held_scans;
+	int old_count;
+	timestamp_t start;
+
+	/* Hold a key at the full scan rate */
+	config->held_scan_period_us = 0;
+	mock_key(1, 1, 1);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	msleep(40); /* Allow debounce to settle */
+	scan_count = 0;
+	msleep(300);
+	steady_scans = scan_count;
+
+	/* Let the scan period back off to 30 ms, then count again */
+	config->held_scan_period_us = 30 * MSEC;
+	msleep(150);
+	scan_count = 0;
+	msleep(300);
+	held_scans = scan_count;
+
+	ccprintf("Scans in 300 ms held: %d, backed off: %d\n",
+		 steady_scans, held_scans);
+	TEST_ASSERT(held_scans * 4 < steady_scans);
+	TEST_ASSERT(held_scans >= 300 / 30 - 1);
+
+	/*
+	 * A new key is still reported within one backed off period plus
+	 * debouncing.
+	 */
+	old_count = fifo_add_count;
+	start = get_time();
+	mock_key(2, 2, 1);
+	while (fifo_add_count == old_count &&
+	       get_time().val - start.val < 100 * MSEC)
+		msleep(1);
+	ccprintf("Key latency while backed off: %d us\n",
+		 (int)(get_time().val - start.val));
+	TEST_ASSERT(get_time().val - start.val <
+		    config->held_scan_period_us +
+		    config->debounce_down_us + 10 * MSEC);
+
+	/* The edge puts the scan rate back to full speed */
+	scan_count = 0;
+	msleep(12);
+	TEST_ASSERT(scan_count >= 3);
+
+	mock_key(2, 2, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+	mock_key(1, 1, 0);
+	TEST_ASSERT(expect_keychange() == EC_SUCCESS);
+
+	config->held_scan_period_us = held_scan_period_us;
+
+	return EC_SUCCESS;
+}
+
 static int debounce_test(void)
 {
 	int old_count = fifo_add_count;
@@ -424,6 +569,9 @@ static void run_test_step1(void)
 	test_reset();
 
 	RUN_TEST(deghost_test);
+	RUN_TEST(ghost_mask_test);
+	RUN_TEST(transitional_ghost_test);
+	RUN_TEST(held_backoff_test);
 	RUN_TEST(debounce_test);
 	RUN_TEST(simulate_key_test);
 #ifdef EMU_BUILD
@@ -22,6 +22,7 @@
 
 extern enum chipset_state_mask sensor_active;
 extern int wait_us;
+extern unsigned int motion_min_interval;
 
 /*
  * Period in us for the motion task period.
@@ -42,8 +43,24 @@ static int accel_init(struct motion_sensor_t *s)
 	return EC_SUCCESS;
 }
 
+/* Number of reads of each sensor, and the shortest and longest gap between */
+static int read_count[SENSOR_COUNT];
+static uint32_t last_read[SENSOR_COUNT];
+static uint32_t min_read_gap[SENSOR_COUNT];
+static uint32_t max_read_gap[SENSOR_COUNT];
+
 static int accel_read(const struct motion_sensor_t *s, intv3_t v)
 {
+	int i = s - motion_sensors;
+	uint32_t now = get_time().le.lo;
+
+	if (read_count[i]) {
+		min_read_gap[i] = MIN(min_read_gap[i], now - last_read[i]);
+		max_read_gap[i] = MAX(max_read_gap[i], now - last_read[i]);
+	}
+	last_read[i] = now;
+	read_count[i]++;
+
 	rotate(s->xyz, *s->rot_standard_ref, v);
 	return EC_SUCCESS;
 }
@@ -146,6 +163,17 @@ static void wait_for_valid_sample(void)
 		usleep(TEST_LID_SLEEP_RATE);
 }
 
+static void reset_read_stats(void)
+{
+	int i;
+
+	for (i = 0; i < SENSOR_COUNT; i++) {
+		read_count[i] = 0;
+		min_read_gap[i] = UINT32_MAX;
+		max_read_gap[i] = 0;
+	}
+}
+
 static int test_lid_angle(void)
 {
 
@@ -319,12 +347,59 @@ static int test_lid_angle(void)
 	return EC_SUCCESS;
 }
 
+static int test_odr_deadlines(void)
+{
+	struct motion_sensor_t *lid = &motion_sensors[
+		CONFIG_LID_ANGLE_SENSOR_LID];
+	int lid_odr = lid->config[SENSOR_CONFIG_EC_S0].odr;
+	int i;
+
+	/* Run the lid at 25 Hz, while the base stays at 119 Hz. */
+	hook_notify(HOOK_CHIPSET_SHUTDOWN);
+	msleep(50);
+	lid->config[SENSOR_CONFIG_EC_S0].odr = 25000 | ROUND_UP_FLAG;
+	hook_notify(HOOK_CHIPSET_SUSPEND);
+	hook_notify(HOOK_CHIPSET_RESUME);
+	msleep(50);
+	TEST_ASSERT(sensor_active == SENSOR_ACTIVE_S0);
+	TEST_ASSERT(motion_sensors[BASE].collection_rate == SECOND * 1000 /
+		    119000);
+	TEST_ASSERT(lid->collection_rate == SECOND * 1000 / 25000);
+
+	reset_read_stats();
+	msleep(1000);
+
+	/*
+	 * Each sensor is read at its own rate. The host clock is wall time,
+	 * so only check what load cannot break: no sensor is read more than
+	 * motion_min_interval ahead of its next collection, and the faster
+	 * base is read more often than the lid.
+	 */
+	for (i = 0; i < SENSOR_COUNT; i++) {
+		struct motion_sensor_t *sensor = &motion_sensors[i];
+
+		cprints(CC_ACCEL, "%s: %d reads, gap %d-%d us, period %d us",
+			sensor->name, read_count[i], min_read_gap[i],
+			max_read_gap[i], sensor->collection_rate);
+		TEST_ASSERT(read_count[i] >= 2);
+		TEST_ASSERT(min_read_gap[i] + motion_min_interval >=
+			    sensor->collection_rate);
+	}
+	TEST_ASSERT(read_count[BASE] > read_count[lid - motion_sensors]);
+
+	hook_notify(HOOK_CHIPSET_SHUTDOWN);
+	msleep(50);
+	lid->config[SENSOR_CONFIG_EC_S0].odr = lid_odr;
+
+	return EC_SUCCESS;
+}
 
 void run_test(int argc, char **argv)
 {
 	test_reset();
 
 	RUN_TEST(test_lid_angle);
+	RUN_TEST(test_odr_deadlines);
 
 	test_print_result();
 }
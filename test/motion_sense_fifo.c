@@ -343,6 +343,243 @@ static int test_commit_non_data_or_timestamp_entries(void)
 	return EC_SUCCESS;
 }
 
+static int test_stage_batch(void)
+{
+	struct ec_response_motion_sensor_data batch[3] = {};
+	int read_count;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	motion_sensors[1].oversampling_ratio = 1;
+	batch[0].sensor_num = 0;
+	batch[0].data[0] = 1;
+	batch[1].sensor_num = 1;
+	batch[1].data[0] = 2;
+	batch[2].sensor_num = 0;
+	batch[2].data[0] = 3;
+
+	motion_sense_fifo_stage_batch(batch, ARRAY_SIZE(batch), 100);
+	TEST_EQ(motion_sensors[0].xyz[0], 3, "%d");
+	TEST_EQ(motion_sensors[1].xyz[0], 2, "%d");
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 0, "%d");
+
+	motion_sense_fifo_commit_data();
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 6, "%d");
+	TEST_BITS_SET(data[0].flags, MOTIONSENSE_SENSOR_FLAG_TIMESTAMP);
+	TEST_EQ(data[1].sensor_num, 0, "%d");
+	TEST_EQ(data[1].data[0], 1, "%d");
+	TEST_EQ(data[3].sensor_num, 1, "%d");
+	TEST_EQ(data[3].data[0], 2, "%d");
+	TEST_EQ(data[5].sensor_num, 0, "%d");
+	TEST_EQ(data[5].data[0], 3, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_stage_batch_matches_single(void)
+{
+	static struct ec_response_motion_sensor_data single[8];
+	struct ec_response_motion_sensor_data batch[4] = {};
+	int single_xyz[2], i, read_count;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	motion_sensors[1].oversampling_ratio = 1;
+	for (i = 0; i < ARRAY_SIZE(batch); i++) {
+		batch[i].sensor_num = i & 1;
+		batch[i].data[0] = i + 1;
+		batch[i].data[1] = -i;
+		batch[i].data[2] = 10 * i;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(batch); i++)
+		motion_sense_fifo_stage_data(
+			&batch[i], &motion_sensors[batch[i].sensor_num], 3,
+			100);
+	motion_sense_fifo_commit_data();
+	read_count = motion_sense_fifo_read(
+		sizeof(single), ARRAY_SIZE(single), single, &data_bytes_read);
+	TEST_EQ(read_count, 8, "%d");
+	single_xyz[0] = motion_sensors[0].xyz[0];
+	single_xyz[1] = motion_sensors[1].xyz[0];
+
+	motion_sense_fifo_reset();
+	motion_sense_fifo_stage_batch(batch, ARRAY_SIZE(batch), 100);
+	motion_sense_fifo_commit_data();
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 8, "%d");
+	/*
+	 * Same entries in the same order.  Timestamps are spread over the time
+	 * the read took, which depends on the host clock, so only the data is
+	 * compared.
+	 */
+	for (i = 0; i < read_count; i++) {
+		TEST_EQ(data[i].flags, single[i].flags, "0x%x");
+		TEST_EQ(data[i].sensor_num, single[i].sensor_num, "%d");
+		if (!(data[i].flags & MOTIONSENSE_SENSOR_FLAG_TIMESTAMP))
+			TEST_ASSERT_ARRAY_EQ(data[i].data, single[i].data, 3);
+	}
+	TEST_EQ(motion_sensors[0].xyz[0], single_xyz[0], "%d");
+	TEST_EQ(motion_sensors[1].xyz[0], single_xyz[1], "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_record_read_stats(void)
+{
+	const struct motion_sense_fifo_read_stats *stats =
+		motion_sense_fifo_get_read_stats(0);
+
+	TEST_EQ(stats->reads, 0, "%u");
+
+	motion_sense_fifo_record_read(motion_sensors, 1, 60, 100);
+	motion_sense_fifo_record_read(motion_sensors, 2, 120, 300);
+	motion_sense_fifo_record_read(motion_sensors, 1, 12, 50);
+	TEST_EQ(stats->reads, 3, "%u");
+	TEST_EQ(stats->xfers, 4, "%u");
+	TEST_EQ(stats->bytes, 192, "%u");
+	TEST_EQ(stats->total_us, 450, "%u");
+	TEST_EQ(stats->max_us, 300, "%u");
+
+	/* Other sensors are counted apart */
+	TEST_EQ(motion_sense_fifo_get_read_stats(1)->reads, 0, "%u");
+
+	return EC_SUCCESS;
+}
+
+static int test_spread_after_evicting_staged_data(void)
+{
+	const uint32_t now = __hw_clock_source_read();
+	int i, read_count;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	motion_sensors[0].collection_rate = 20000; /* ns */
+	motion_sensors[1].oversampling_ratio = 1;
+	motion_sensors[1].collection_rate = 20000; /* ns */
+
+	/*
+	 * Fill the fifo with staged data: 2 samples from sensor 0 then
+	 * sensor 1 samples.
+	 */
+	motion_sense_fifo_stage_data(data, motion_sensors, 3, now - 20500);
+	motion_sense_fifo_stage_data(data, motion_sensors, 3, now - 20500);
+	data->sensor_num = 1;
+	for (i = 0; i < CONFIG_ACCEL_FIFO_SIZE / 2 - 2; i++)
+		motion_sense_fifo_stage_data(data, motion_sensors + 1, 3,
+					     now - 20500);
+
+	/*
+	 * Evict the first sensor 0 sample: sensor 1 still needs its
+	 * timestamps spread.
+	 */
+	motion_sense_fifo_stage_data(data, motion_sensors + 1, 3, now - 20500);
+	motion_sense_fifo_commit_data();
+
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, CONFIG_ACCEL_FIFO_SIZE, "%d");
+	TEST_EQ(data[1].sensor_num, 0, "%d");
+	TEST_EQ(data[0].timestamp, now - 20500, "%u");
+	TEST_EQ(data[3].sensor_num, 1, "%d");
+	TEST_EQ(data[2].timestamp, now - 20500, "%u");
+	TEST_NE(data[4].timestamp, now - 20500, "%u");
+
+	return EC_SUCCESS;
+}
+
+static int test_decimate_on_overflow(void)
+{
+	int i, read_count;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	motion_sensors[0].lost = 0;
+
+	/* Overflow the fifo once: the next samples are decimated by 2. */
+	for (i = 0; i < CONFIG_ACCEL_FIFO_SIZE / 2 + 1; i++)
+		motion_sense_fifo_stage_data(data, motion_sensors, 3, i);
+	motion_sense_fifo_commit_data();
+	motion_sensors[0].lost = 0;
+
+	/*
+	 * Still full: the decimation goes up to 1 in 4, only the first sample
+	 * is staged (evicting the oldest one), the 3 others are dropped.
+	 */
+	for (i = 0; i < 4; i++)
+		motion_sense_fifo_stage_data(data, motion_sensors, 3, 1000 + i);
+	motion_sense_fifo_commit_data();
+	TEST_EQ(motion_sensors[0].lost, 4, "%d");
+
+	/*
+	 * Each read leaving the fifo less than half full steps the decimation
+	 * down: after 2 reads, samples are all staged again.
+	 */
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, CONFIG_ACCEL_FIFO_SIZE, "%d");
+	TEST_EQ(data[CONFIG_ACCEL_FIFO_SIZE - 2].timestamp, 1000, "%u");
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 0, "%d");
+
+	motion_sensors[0].lost = 0;
+	motion_sense_fifo_stage_data(data, motion_sensors, 3, 2000);
+	motion_sense_fifo_stage_data(data, motion_sensors, 3, 2001);
+	motion_sense_fifo_commit_data();
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 4, "%d");
+	TEST_EQ(motion_sensors[0].lost, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+#ifdef EMU_BUILD
+/* Compare staging one sample at a time with staging whole batches */
+static int test_stage_throughput(void)
+{
+	static struct ec_response_motion_sensor_data batch[16];
+	const int rounds = 2000;
+	uint64_t t0, t1, t2;
+	int i, j;
+
+	motion_sensors[0].oversampling_ratio = 1;
+	motion_sensors[1].oversampling_ratio = 1;
+	for (j = 0; j < ARRAY_SIZE(batch); j++)
+		batch[j].sensor_num = j & 1;
+
+	t0 = test_host_time_ns();
+	for (i = 0; i < rounds; i++) {
+		for (j = 0; j < ARRAY_SIZE(batch); j++)
+			motion_sense_fifo_stage_data(
+				&batch[j], &motion_sensors[batch[j].sensor_num],
+				3, i);
+		motion_sense_fifo_commit_data();
+		motion_sense_fifo_read(sizeof(data), CONFIG_ACCEL_FIFO_SIZE,
+				       data, &data_bytes_read);
+	}
+	t1 = test_host_time_ns();
+	for (i = 0; i < rounds; i++) {
+		motion_sense_fifo_stage_batch(batch, ARRAY_SIZE(batch), i);
+		motion_sense_fifo_commit_data();
+		motion_sense_fifo_read(sizeof(data), CONFIG_ACCEL_FIFO_SIZE,
+				       data, &data_bytes_read);
+	}
+	t2 = test_host_time_ns();
+
+	ccprintf("fifo %d samples: single %d us, batch %d us\n",
+		 rounds * (int)ARRAY_SIZE(batch), (int)((t1 - t0) / 1000),
+		 (int)((t2 - t1) / 1000));
+	TEST_EQ(data_bytes_read,
+		(int)(2 * ARRAY_SIZE(batch) *
+		      sizeof(struct ec_response_motion_sensor_data)), "%d");
+
+	return EC_SUCCESS;
+}
+#endif
+
 void before_test(void)
 {
 	motion_sense_fifo_commit_data();
@@ -372,6 +609,14 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_spread_data_by_collection_rate);
 	RUN_TEST(test_spread_double_commit_same_timestamp);
 	RUN_TEST(test_commit_non_data_or_timestamp_entries);
+	RUN_TEST(test_stage_batch);
+	RUN_TEST(test_stage_batch_matches_single);
+	RUN_TEST(test_record_read_stats);
+	RUN_TEST(test_spread_after_evicting_staged_data);
+	RUN_TEST(test_decimate_on_overflow);
+#ifdef EMU_BUILD
+	RUN_TEST(test_stage_throughput);
+#endif
 
 	test_print_result();
 }
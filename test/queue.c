@@ -13,9 +13,35 @@
 #include "util.h"
 #include <stdio.h>
 
+#ifdef EMU_BUILD
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
 static struct queue const test_queue8 = QUEUE_NULL(8, char);
 static struct queue const test_queue2 = QUEUE_NULL(2, int16_t);
 
+static int counting_adds;
+static int counting_removes;
+
+static void counting_add(struct queue_policy const *policy, size_t count)
+{
+	counting_adds++;
+}
+
+static void counting_remove(struct queue_policy const *policy, size_t count)
+{
+	counting_removes++;
+}
+
+static struct queue_policy const counting_policy = {
+	.add    = counting_add,
+	.remove = counting_remove,
+};
+
+static struct queue const test_queue64 = QUEUE(64, uint8_t, counting_policy);
+
 static int test_queue8_empty(void)
 {
 	char tmp = 1;
@@ -324,6 +350,315 @@ static int test_queue8_chunks_offset(void)
 	return EC_SUCCESS;
 }
 
+static int test_queue8_chunks_scatter(void)
+{
+	struct queue_chunk chunks[2];
+
+	/* Empty queue: all free space is in one block. */
+	TEST_ASSERT(queue_get_write_chunks(&test_queue8, chunks) == 8);
+	TEST_ASSERT(chunks[0].count == 8);
+	TEST_ASSERT(chunks[1].count == 0);
+	TEST_ASSERT(queue_get_read_chunks(&test_queue8, chunks) == 0);
+	TEST_ASSERT(chunks[0].count == 0);
+	TEST_ASSERT(chunks[1].count == 0);
+
+	/*
+	 * Used memory in the middle, free space on both sides:
+	 *      H  T
+	 * |-----xx-|
+	 */
+	TEST_ASSERT(queue_advance_tail(&test_queue8, 7) == 7);
+	TEST_ASSERT(queue_advance_head(&test_queue8, 5) == 5);
+
+	TEST_ASSERT(queue_get_write_chunks(&test_queue8, chunks) == 6);
+	TEST_ASSERT(chunks[0].count == 1);
+	TEST_ASSERT(chunks[0].buffer == test_queue8.buffer + 7);
+	TEST_ASSERT(chunks[1].count == 5);
+	TEST_ASSERT(chunks[1].buffer == test_queue8.buffer);
+
+	/*
+	 * Wrap the tail, so the stored units are now split:
+	 *    T  H
+	 * |xx---xxx|
+	 */
+	TEST_ASSERT(queue_advance_tail(&test_queue8, 3) == 3);
+
+	TEST_ASSERT(queue_get_read_chunks(&test_queue8, chunks) == 5);
+	TEST_ASSERT(chunks[0].count == 3);
+	TEST_ASSERT(chunks[0].buffer == test_queue8.buffer + 5);
+	TEST_ASSERT(chunks[1].count == 2);
+	TEST_ASSERT(chunks[1].buffer == test_queue8.buffer);
+
+	TEST_ASSERT(queue_get_write_chunks(&test_queue8, chunks) == 3);
+	TEST_ASSERT(chunks[0].count == 3);
+	TEST_ASSERT(chunks[0].buffer == test_queue8.buffer + 2);
+	TEST_ASSERT(chunks[1].count == 0);
+
+	return EC_SUCCESS;
+}
+
+static int test_queue8_add_remove_chunks(void)
+{
+	char a[3] = {1, 2, 3};
+	char b[4] = {4, 5, 6, 7};
+	char c[2] = {8, 9};
+	char out_a[5], out_b[5];
+	char expected[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	struct queue_chunk src[3] = {
+		{ .count = sizeof(a), .buffer = a },
+		{ .count = sizeof(b), .buffer = b },
+		{ .count = sizeof(c), .buffer = c },
+	};
+	struct queue_chunk dest[2] = {
+		{ .count = sizeof(out_a), .buffer = out_a },
+		{ .count = sizeof(out_b), .buffer = out_b },
+	};
+
+	/* Start near the end so the batch wraps. */
+	TEST_ASSERT(queue_advance_tail(&test_queue8, 6) == 6);
+	TEST_ASSERT(queue_advance_head(&test_queue8, 6) == 6);
+
+	/* Nine units offered, only eight fit. */
+	TEST_ASSERT(queue_add_chunks(&test_queue8, src, 3) == 8);
+	TEST_ASSERT(queue_is_full(&test_queue8));
+
+	TEST_ASSERT(queue_remove_chunks(&test_queue8, dest, 2) == 8);
+	TEST_ASSERT(queue_is_empty(&test_queue8));
+	TEST_ASSERT_ARRAY_EQ(out_a, expected, 5);
+	TEST_ASSERT_ARRAY_EQ(out_b, expected + 5, 3);
+
+	return EC_SUCCESS;
+}
+
+static int test_queue64_batch_notify(void)
+{
+	uint8_t data[16];
+	uint8_t out[16];
+	struct queue_chunk src[2] = {
+		{ .count = 8, .buffer = data },
+		{ .count = 8, .buffer = data + 8 },
+	};
+	struct queue_chunk dest[1] = {
+		{ .count = sizeof(out), .buffer = out },
+	};
+	int unit_adds, unit_removes;
+	int i, j;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i;
+
+	/* Move 1 KB through the queue one unit at a time. */
+	counting_adds = counting_removes = 0;
+	for (i = 0; i < 1024 / sizeof(data); i++) {
+		for (j = 0; j < sizeof(data); j++)
+			TEST_ASSERT(queue_add_unit(&test_queue64, data + j));
+		for (j = 0; j < sizeof(data); j++)
+			TEST_ASSERT(queue_remove_unit(&test_queue64, out + j));
+		TEST_ASSERT_ARRAY_EQ(out, data, sizeof(data));
+	}
+	unit_adds = counting_adds;
+	unit_removes = counting_removes;
+
+	/* And the same 1 KB in batches of two chunks. */
+	counting_adds = counting_removes = 0;
+	for (i = 0; i < 1024 / sizeof(data); i++) {
+		TEST_ASSERT(queue_add_chunks(&test_queue64, src, 2) ==
+			    sizeof(data));
+		TEST_ASSERT(queue_remove_chunks(&test_queue64, dest, 1) ==
+			    sizeof(data));
+		TEST_ASSERT_ARRAY_EQ(out, data, sizeof(data));
+	}
+
+	ccprintf("Notifications per KB: unit %d/%d, batched %d/%d\n",
+		 unit_adds, unit_removes, counting_adds, counting_removes);
+
+	TEST_ASSERT(unit_adds == 1024);
+	TEST_ASSERT(unit_removes == 1024);
+	TEST_ASSERT(counting_adds == 1024 / sizeof(data));
+	TEST_ASSERT(counting_removes == 1024 / sizeof(data));
+
+	return EC_SUCCESS;
+}
+
+#ifdef EMU_BUILD
+#define SPSC_UNITS (1 << 20)
+
+static struct queue const spsc_queue = QUEUE_NULL(64, uint32_t);
+
+/*
+ * Producer thread for the SPSC stress test.  This is a raw host thread rather
+ * than an EC task, so it really does run concurrently with the test task.  It
+ * adds a running count in batches of varying size, spinning while the queue
+ * is full.
+ */
+static void *spsc_producer(void *arg)
+{
+	uint32_t batch[7];
+	uint32_t next = 0;
+	size_t size = 1;
+
+	while (next < SPSC_UNITS) {
+		size_t count = MIN(size, SPSC_UNITS - next);
+		size_t added;
+		size_t i;
+
+		for (i = 0; i < count; i++)
+			batch[i] = next + i;
+
+		added = queue_add_units(&spsc_queue, batch, count);
+		if (!added)
+			sched_yield();
+
+		next += added;
+		size = size % ARRAY_SIZE(batch) + 1;
+	}
+
+	return NULL;
+}
+
+static int test_queue_spsc_stress(void)
+{
+	struct timespec start, end;
+	pthread_t producer;
+	uint32_t expected = 0;
+	uint32_t errors = 0;
+	uint64_t elapsed_us;
+
+	queue_init(&spsc_queue);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	TEST_ASSERT(pthread_create(&producer, NULL, spsc_producer, NULL) == 0);
+
+	/*
+	 * Alternate between copying units out and reading them in place, so
+	 * that both consumer paths see the producer moving the tail.
+	 */
+	while (expected < SPSC_UNITS) {
+		struct queue_chunk chunks[2];
+		uint32_t data[5];
+		size_t count;
+		size_t i, j;
+
+		if (expected & 1) {
+			count = queue_remove_units(&spsc_queue, data,
+						   ARRAY_SIZE(data));
+			for (i = 0; i < count; i++)
+				errors += (data[i] != expected++);
+		} else {
+			count = queue_get_read_chunks(&spsc_queue, chunks);
+			for (i = 0; i < ARRAY_SIZE(chunks); i++)
+				for (j = 0; j < chunks[i].count; j++)
+					errors += (((uint32_t *)
+						    chunks[i].buffer)[j] !=
+						   expected++);
+			queue_advance_head(&spsc_queue, count);
+		}
+
+		if (!count)
+			sched_yield();
+	}
+
+	pthread_join(producer, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	elapsed_us = (end.tv_sec - start.tv_sec) * 1000000ULL +
+		     (end.tv_nsec - start.tv_nsec) / 1000;
+	ccprintf("SPSC: %d units in %d us (%d units/ms)\n",
+		 SPSC_UNITS, (int)elapsed_us,
+		 (int)(SPSC_UNITS * 1000ULL / MAX(elapsed_us, 1)));
+
+	TEST_ASSERT(errors == 0);
+	TEST_ASSERT(queue_is_empty(&spsc_queue));
+
+	return EC_SUCCESS;
+}
+
+#define BENCH_RECORDS (1 << 16)
+
+static struct queue const bench_queue = QUEUE(256, uint8_t, counting_policy);
+
+/*
+ * Move BENCH_RECORDS scattered 60 byte records (header, payload, trailer)
+ * through the queue, either with one queue_add_chunks/queue_remove_chunks
+ * batch per record or with one queue_add_units call per piece.  60 does not
+ * divide the queue size, so records regularly straddle the wrap.  Returns
+ * bytes/sec, and the number of policy notifications in *notifies.
+ */
+static uint64_t bench_scatter(int batched, int *notifies, int *errors)
+{
+	uint8_t header[4], payload[48], trailer[8];
+	uint8_t expected[sizeof(header) + sizeof(payload) + sizeof(trailer)];
+	uint8_t out[sizeof(expected)];
+	struct queue_chunk src[3] = {
+		{ .count = sizeof(header), .buffer = header },
+		{ .count = sizeof(payload), .buffer = payload },
+		{ .count = sizeof(trailer), .buffer = trailer },
+	};
+	struct queue_chunk dest[1] = {
+		{ .count = sizeof(out), .buffer = out },
+	};
+	uint64_t start, elapsed_ns;
+	int i, j;
+
+	for (i = 0; i < sizeof(expected); i++)
+		expected[i] = i;
+	memcpy(header, expected, sizeof(header));
+	memcpy(payload, expected + sizeof(header), sizeof(payload));
+	memcpy(trailer, expected + sizeof(header) + sizeof(payload),
+	       sizeof(trailer));
+
+	queue_init(&bench_queue);
+	counting_adds = 0;
+	counting_removes = 0;
+	*errors = 0;
+
+	start = test_host_time_ns();
+	for (i = 0; i < BENCH_RECORDS; i++) {
+		if (batched) {
+			queue_add_chunks(&bench_queue, src, ARRAY_SIZE(src));
+			queue_remove_chunks(&bench_queue, dest,
+					    ARRAY_SIZE(dest));
+		} else {
+			for (j = 0; j < ARRAY_SIZE(src); j++)
+				queue_add_units(&bench_queue, src[j].buffer,
+						src[j].count);
+			queue_remove_units(&bench_queue, out, sizeof(out));
+		}
+		*errors += !!memcmp(out, expected, sizeof(out));
+	}
+	elapsed_ns = test_host_time_ns() - start;
+
+	*notifies = counting_adds + counting_removes;
+
+	return (uint64_t)BENCH_RECORDS * sizeof(out) * 1000000000ULL /
+	       MAX(elapsed_ns, 1);
+}
+
+static int test_queue_scatter_throughput(void)
+{
+	uint64_t per_unit, batched;
+	int per_unit_notifies, batched_notifies;
+	int errors;
+
+	per_unit = bench_scatter(0, &per_unit_notifies, &errors);
+	TEST_ASSERT(errors == 0);
+	batched = bench_scatter(1, &batched_notifies, &errors);
+	TEST_ASSERT(errors == 0);
+
+	ccprintf("scatter: per-piece %d KiB/s, %d notifies\n",
+		 (int)(per_unit >> 10), per_unit_notifies);
+	ccprintf("scatter: batched   %d KiB/s, %d notifies\n",
+		 (int)(batched >> 10), batched_notifies);
+
+	/* One add and one remove notification per record when batched. */
+	TEST_ASSERT(batched_notifies == 2 * BENCH_RECORDS);
+	TEST_ASSERT(per_unit_notifies == 4 * BENCH_RECORDS);
+	TEST_ASSERT(queue_is_empty(&bench_queue));
+
+	return EC_SUCCESS;
+}
+#endif /* EMU_BUILD */
+
 static int test_queue8_iterate_begin(void)
 {
 	struct queue const *q = &test_queue8;
@@ -414,6 +749,7 @@ void before_test(void)
 {
 	queue_init(&test_queue2);
 	queue_init(&test_queue8);
+	queue_init(&test_queue64);
 }
 
 void run_test(int argc, char **argv)
@@ -433,6 +769,13 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_queue8_chunks_empty);
 	RUN_TEST(test_queue8_chunks_advance);
 	RUN_TEST(test_queue8_chunks_offset);
+	RUN_TEST(test_queue8_chunks_scatter);
+	RUN_TEST(test_queue8_add_remove_chunks);
+	RUN_TEST(test_queue64_batch_notify);
+#ifdef EMU_BUILD
+	RUN_TEST(test_queue_spsc_stress);
+	RUN_TEST(test_queue_scatter_throughput);
+#endif
 	RUN_TEST(test_queue8_iterate_begin);
 	RUN_TEST(test_queue8_iterate_next);
 	RUN_TEST(test_queue2_iterate_next_full);
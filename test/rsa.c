@@ -11,18 +11,51 @@
 #include "test_util.h"
 #include "util.h"
 
-#ifdef TEST_RSA3
+#ifdef EMU_BUILD
+#include <time.h>
+#endif
+
+#ifdef CONFIG_RSA_EXPONENT_3
 #if CONFIG_RSA_KEY_SIZE == 3072
 #include "rsa3072-3.h"
 #else
 #include "rsa2048-3.h"
 #endif
 #else
+#if CONFIG_RSA_KEY_SIZE == 3072
+#include "rsa3072-F4.h"
+#else
 #include "rsa2048-F4.h"
 #endif
+#endif
 
 static uint32_t rsa_workbuf[3 * RSANUMBYTES/4];
 
+#ifdef EMU_BUILD
+#define BENCHMARK_ITERATIONS 100
+
+static void benchmark(void)
+{
+	struct timespec start, end;
+	uint64_t elapsed_us;
+	int i;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+	for (i = 0; i < BENCHMARK_ITERATIONS; i++)
+		rsa_verify(rsa_key, sig, hash, rsa_workbuf);
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+
+	elapsed_us = (end.tv_sec - start.tv_sec) * 1000000ULL +
+		     (end.tv_nsec - start.tv_nsec) / 1000;
+#ifdef CONFIG_RSA_EXPONENT_3
+	ccprintf("RSA-%d e=3: %d us per verify\n", CONFIG_RSA_KEY_SIZE,
+#else
+	ccprintf("RSA-%d e=F4: %d us per verify\n", CONFIG_RSA_KEY_SIZE,
+#endif
+		 (int)(elapsed_us / BENCHMARK_ITERATIONS));
+}
+#endif
+
 void run_test(int argc, char **argv)
 {
 	int good;
@@ -53,6 +86,10 @@ void run_test(int argc, char **argv)
 	}
 	ccprintf("RSA verify FAILED (as expected)\n");
 
+#ifdef EMU_BUILD
+	benchmark();
+#endif
+
 	test_pass();
 }
 
@@ -0,0 +1,138 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * RSA 3072 with F4 exponent public key and verification.
+ * Private key in rsa3072-F4.pem.
+ */
+
+/* First generate a key:
+ * # openssl genrsa -out key.pem 3072
+ * # openssl rsa -in key.pem -pubout > key.pub
+ * Then dump the key: sudo emerge vboot_reference
+ * # /usr/bin/dumpRSAPublicKey -pub key.pub | xxd -i
+ */
+const uint8_t rsa_data[] = {
+	0x60, 0x00, 0x00, 0x00, 0xff, 0x04, 0x5d, 0x31, 0x01, 0x05, 0x76, 0x50,
+	0x4e, 0x39, 0xe3, 0xbd, 0xa5, 0x85, 0xc3, 0x1f, 0x5b, 0x0e, 0x73, 0x95,
+	0x24, 0x84, 0x10, 0x29, 0x52, 0xb3, 0xd2, 0x4d, 0x64, 0x61, 0x10, 0x87,
+	0x0a, 0xaf, 0x85, 0x1b, 0x7e, 0xc6, 0x45, 0x09, 0xab, 0x27, 0xbb, 0x38,
+	0x33, 0xe1, 0x16, 0xdc, 0xc5, 0xc3, 0xbb, 0xa7, 0x22, 0x06, 0x12, 0x22,
+	0xa8, 0x2d, 0x16, 0x88, 0xf9, 0xf5, 0x7b, 0x6d, 0x5d, 0x83, 0x0c, 0x7c,
+	0x70, 0x85, 0x0a, 0x53, 0x02, 0xc4, 0x75, 0xd0, 0x42, 0xb3, 0x4d, 0x17,
+	0x8c, 0x61, 0x99, 0x10, 0x0c, 0x16, 0xba, 0x24, 0x5b, 0x4b, 0x25, 0xa4,
+	0x20, 0x78, 0xfc, 0x45, 0x9f, 0x03, 0x51, 0x92, 0xaf, 0x75, 0x5c, 0x20,
+	0xea, 0xc4, 0x31, 0x4c, 0x68, 0xd8, 0x1a, 0x21, 0x4f, 0x0d, 0xc9, 0x8e,
+	0x15, 0x3c, 0xf3, 0xa0, 0x94, 0x31, 0xd2, 0xe9, 0xaf, 0x1f, 0xbd, 0x9d,
+	0x6d, 0x11, 0xfe, 0x2b, 0x36, 0x10, 0x8b, 0xa9, 0x13, 0x91, 0xdc, 0xce,
+	0xbe, 0x2d, 0x6f, 0xb4, 0xcf, 0x27, 0x25, 0xe0, 0x5e, 0xe6, 0x91, 0xe9,
+	0x5e, 0x9f, 0xe3, 0x76, 0x45, 0xc6, 0xab, 0x33, 0x99, 0x64, 0xb9, 0x43,
+	0xf9, 0x35, 0xc5, 0xe3, 0x0f, 0xe3, 0x1d, 0x24, 0xe5, 0xf7, 0x2d, 0xcd,
+	0x1b, 0xc4, 0xbf, 0xce, 0x3c, 0x08, 0xf7, 0xef, 0x2f, 0xd1, 0x91, 0x44,
+	0xbc, 0xc2, 0xfb, 0xfe, 0x21, 0xae, 0x49, 0xd7, 0x7a, 0xd5, 0x45, 0xdc,
+	0x94, 0x46, 0xc2, 0xe0, 0x80, 0xb0, 0x24, 0xd6, 0x0b, 0x22, 0x9b, 0xd6,
+	0x50, 0x84, 0xaf, 0xcb, 0x25, 0xb4, 0x7c, 0xf5, 0xf4, 0x17, 0x9c, 0xca,
+	0x5b, 0xb4, 0xbd, 0x6f, 0x89, 0xab, 0x07, 0xff, 0xd9, 0x3e, 0x15, 0x5f,
+	0x57, 0xe6, 0x9e, 0x4a, 0x28, 0xcf, 0xdc, 0xcb, 0xea, 0xd7, 0x24, 0x4d,
+	0x68, 0xa8, 0x53, 0xda, 0xc8, 0x7b, 0xf7, 0xf7, 0xdb, 0x19, 0x47, 0x31,
+	0xa5, 0xe3, 0x35, 0x5b, 0x0d, 0xea, 0x79, 0xf0, 0x9a, 0x0c, 0xa3, 0xd9,
+	0xc2, 0xb7, 0xdb, 0x18, 0x91, 0x11, 0x09, 0xf0, 0xb6, 0x71, 0x25, 0x31,
+	0x1a, 0x28, 0x3b, 0x24, 0x0b, 0x9a, 0x30, 0x89, 0xa2, 0x94, 0x6e, 0x8b,
+	0x87, 0x6d, 0x2c, 0x33, 0xb1, 0xf3, 0x7c, 0xe5, 0x5c, 0x56, 0x82, 0x37,
+	0xb3, 0x5c, 0x70, 0x42, 0xb8, 0xe0, 0x75, 0xb2, 0xbe, 0xf1, 0x3a, 0x71,
+	0xe4, 0x70, 0x2c, 0x7b, 0x77, 0x44, 0x75, 0x18, 0x54, 0x21, 0xb7, 0xac,
+	0x4e, 0xad, 0x89, 0x52, 0x69, 0xe3, 0x73, 0xfa, 0x77, 0x60, 0x3b, 0x5c,
+	0xb2, 0x7f, 0x3b, 0x61, 0x11, 0x7a, 0x32, 0x56, 0x66, 0x2d, 0xd7, 0x1c,
+	0x31, 0xd8, 0xe9, 0x49, 0x03, 0x25, 0x55, 0x00, 0x91, 0x66, 0x64, 0x94,
+	0xbc, 0x40, 0x16, 0x5e, 0xf4, 0x38, 0x80, 0x3b, 0x0b, 0x4d, 0x3a, 0x5a,
+	0xbb, 0x7b, 0x2b, 0x35, 0x66, 0x50, 0x2d, 0xc1, 0xec, 0xd5, 0xfe, 0x55,
+	0x15, 0x96, 0x61, 0x3e, 0x13, 0x00, 0xbb, 0x3f, 0x73, 0xde, 0x18, 0x22,
+	0xab, 0x24, 0x48, 0xfb, 0x94, 0x86, 0x45, 0xb0, 0xf5, 0x4a, 0x84, 0x21,
+	0x4a, 0x91, 0x01, 0xb7, 0xf5, 0x1e, 0x76, 0x28, 0xe6, 0xf3, 0x2f, 0x25,
+	0xeb, 0xfe, 0xfb, 0xa8, 0xb8, 0xdc, 0xbc, 0x9f, 0x5f, 0x83, 0x67, 0xd8,
+	0x82, 0x49, 0xc9, 0xc2, 0xf3, 0x25, 0xae, 0x8f, 0xa4, 0x9a, 0x1d, 0x48,
+	0x25, 0x91, 0xd4, 0x6f, 0x08, 0xf1, 0x64, 0x53, 0xf5, 0xcb, 0xc0, 0x6b,
+	0xde, 0x06, 0x48, 0x01, 0x30, 0xd6, 0xc6, 0x22, 0x52, 0x0e, 0x07, 0xc1,
+	0x62, 0x83, 0xf7, 0x70, 0x94, 0x24, 0x56, 0x12, 0x1e, 0xa1, 0x8d, 0x77,
+	0xc9, 0x90, 0x17, 0xe2, 0xd6, 0xf8, 0x69, 0x5a, 0xb9, 0x9b, 0xea, 0x5e,
+	0x2d, 0x1f, 0x06, 0x2b, 0x2a, 0x0f, 0x24, 0x43, 0x33, 0x72, 0x7b, 0xbb,
+	0xbd, 0x8c, 0x18, 0xf5, 0x54, 0x35, 0x49, 0xe9, 0xdd, 0x21, 0x0b, 0x72,
+	0x83, 0xcd, 0x5c, 0xd9, 0xf2, 0x8b, 0xb5, 0x4d, 0xdd, 0xd1, 0x50, 0xb7,
+	0x59, 0x38, 0xcd, 0xe9, 0xcb, 0x94, 0x0b, 0x5c, 0x8e, 0x04, 0xee, 0x8a,
+	0xaa, 0x6b, 0x63, 0x41, 0x48, 0xb1, 0x60, 0x85, 0x14, 0xae, 0xe9, 0xe1,
+	0x77, 0x82, 0x08, 0xda, 0xc5, 0xf0, 0x76, 0xfc, 0x5c, 0xf6, 0x4c, 0x6d,
+	0x4a, 0x11, 0xe2, 0x71, 0xe0, 0x23, 0x8e, 0xb1, 0x92, 0x84, 0x48, 0xf7,
+	0xb4, 0xd5, 0xec, 0x5f, 0x27, 0x6d, 0xbb, 0x9c, 0x1d, 0xa2, 0x8e, 0x14,
+	0x61, 0x3b, 0xc0, 0xe8, 0x3a, 0x9d, 0x93, 0xb7, 0xbf, 0x5b, 0x5e, 0x7a,
+	0x94, 0x48, 0x00, 0xac, 0x95, 0xb5, 0x6d, 0xe4, 0x08, 0x89, 0x2d, 0xe5,
+	0x77, 0xcf, 0xd6, 0x24, 0xdc, 0x71, 0x76, 0xdb, 0x18, 0xae, 0x53, 0x36,
+	0xb2, 0x67, 0x39, 0x21, 0x36, 0xdc, 0xaa, 0x95, 0xfc, 0xca, 0xff, 0x53,
+	0xc8, 0x46, 0xbf, 0xa0, 0xb1, 0xc7, 0x85, 0xae, 0xc5, 0x70, 0xfc, 0xd1,
+	0x77, 0x9c, 0x8c, 0xcd, 0xa7, 0x98, 0xe9, 0xb2, 0x4e, 0x3a, 0x24, 0x15,
+	0x63, 0x66, 0x64, 0x68, 0xd7, 0x56, 0x48, 0x12, 0xe6, 0xda, 0x58, 0xc8,
+	0xfc, 0x9b, 0xdc, 0xa6, 0xdb, 0x33, 0x8d, 0xf8, 0x46, 0x12, 0x9f, 0xf6,
+	0x43, 0x71, 0xca, 0xf1, 0x83, 0x2c, 0x5d, 0xc3, 0xa5, 0x01, 0x86, 0x4c,
+	0xd2, 0x77, 0xdb, 0x71, 0x83, 0xbc, 0xdb, 0x35, 0xbb, 0x4d, 0xae, 0xfb,
+	0x32, 0x7c, 0xbc, 0xb9, 0xf8, 0x52, 0xd7, 0x43, 0x87, 0x51, 0xd9, 0xeb,
+	0xd7, 0xb4, 0x72, 0x44, 0xdd, 0x79, 0xf6, 0xa6, 0xba, 0x7f, 0xcf, 0x8c,
+	0xaa, 0xff, 0x92, 0xcd, 0x53, 0xe9, 0xe8, 0x44, 0x56, 0xca, 0xa7, 0xc8,
+	0x11, 0x3c, 0x98, 0x37, 0xa9, 0x34, 0x6a, 0x4b, 0xf3, 0xbb, 0x45, 0x20,
+	0xe2, 0xc8, 0xf2, 0xd7, 0x8c, 0x5d, 0xc6, 0x73,
+};
+
+const struct rsa_public_key *rsa_key = (struct rsa_public_key *)rsa_data;
+BUILD_ASSERT(sizeof(*rsa_key) == sizeof(rsa_data));
+
+/* SHA-256 sum to verify:
+ * # sha256sum README.md | sed -e 's/\(..\)/0x\1, /mg'
+ */
+const uint8_t hash[] = { 0xc7, 0xc3, 0xd0, 0xa3, 0x7e, 0xbd, 0x50, 0xe8,
+			 0x3c, 0xb3, 0x5b, 0xed, 0x02, 0xf9, 0x8f, 0x97,
+			 0xf8, 0xb5, 0x23, 0x43, 0x74, 0xda, 0x0a, 0x24,
+			 0xdb, 0x04, 0xe4, 0x1e, 0xbd, 0x43, 0x02, 0xdc };
+
+/* Incorrect hash to test the negative case */
+const uint8_t hash_wrong[] = { 0x61, 0x1b, 0xd2, 0x44, 0xc7, 0x18, 0xa7, 0x2d,
+			       0x0f, 0x2d, 0x3d, 0x0f, 0xe3, 0xb3, 0xc5, 0xe4,
+			       0x12, 0xc2, 0x7b, 0x1e, 0x05, 0x2c, 0x6f, 0xad,
+			       0xc4, 0xac, 0x71, 0x55, 0xe8, 0x80, 0x5c, 0x38 };
+
+/* Generate signature using openssl:
+ * openssl dgst -sha256 -sign test/rsa3072-F4.pem README.md | xxd -i
+ */
+const uint8_t sig[] = {
+	0x67, 0xcd, 0x82, 0x3d, 0x54, 0x3e, 0xd7, 0x9c, 0xac, 0x34, 0x18, 0x18,
+	0xe4, 0x51, 0xc3, 0x1f, 0xcb, 0xa8, 0xa9, 0x5a, 0xfa, 0x9e, 0xdb, 0x9a,
+	0xbd, 0x8a, 0x91, 0x30, 0xa1, 0x8a, 0xdd, 0x6a, 0x0b, 0xee, 0xb1, 0x4e,
+	0x5e, 0xf5, 0x37, 0x6b, 0x36, 0xd1, 0xd2, 0xb1, 0xc9, 0xd3, 0x38, 0x4a,
+	0x7d, 0xe7, 0xae, 0x21, 0xd2, 0x59, 0xe5, 0x97, 0x36, 0x77, 0x69, 0xa0,
+	0xdc, 0x26, 0x9a, 0xc4, 0x60, 0x39, 0xa3, 0x89, 0x03, 0xf6, 0x8c, 0x4f,
+	0x27, 0x2e, 0xd7, 0x38, 0x89, 0xa6, 0xdd, 0x06, 0x68, 0xad, 0xc8, 0xf5,
+	0x73, 0x80, 0x06, 0x29, 0xe2, 0xfe, 0x6a, 0x32, 0xd0, 0xe0, 0xca, 0x3c,
+	0xa7, 0xe6, 0x49, 0x45, 0x8e, 0xe0, 0x54, 0x5e, 0x56, 0x5b, 0x16, 0xab,
+	0xec, 0x9f, 0x33, 0xe0, 0x07, 0x11, 0xdb, 0xc2, 0xb9, 0x02, 0xe3, 0x31,
+	0x7d, 0xee, 0xc6, 0x9f, 0xef, 0xa3, 0x62, 0x42, 0x3d, 0x43, 0xc6, 0xdc,
+	0x39, 0x60, 0x53, 0xde, 0xd7, 0xd1, 0x91, 0xb0, 0x87, 0x11, 0x75, 0xea,
+	0x3b, 0x2d, 0x59, 0xc9, 0x02, 0x5e, 0xdd, 0x0b, 0xc3, 0xa6, 0x02, 0x9d,
+	0x69, 0x4a, 0x20, 0x4b, 0x4e, 0x87, 0x3e, 0xe6, 0xe7, 0x50, 0xf7, 0xc4,
+	0x18, 0xb4, 0x3b, 0xbc, 0xb4, 0x4c, 0x02, 0xde, 0x22, 0x19, 0x92, 0xc8,
+	0x70, 0x5c, 0x26, 0xb9, 0xf9, 0x75, 0x7a, 0x25, 0x4b, 0x26, 0x50, 0x06,
+	0x6c, 0xa9, 0x8c, 0x9f, 0x94, 0x39, 0x5d, 0x99, 0xb8, 0x9c, 0x34, 0x1a,
+	0xd1, 0x72, 0xe2, 0x79, 0x94, 0xe5, 0x28, 0x8a, 0x78, 0x4c, 0xec, 0xeb,
+	0xab, 0xdb, 0xa0, 0x83, 0xa0, 0xf3, 0xfc, 0x03, 0xad, 0xcc, 0x4d, 0xba,
+	0x97, 0x18, 0x75, 0x01, 0x0a, 0x5c, 0xb9, 0x49, 0x40, 0x11, 0xa4, 0x88,
+	0x48, 0x2d, 0x81, 0xa6, 0x3a, 0x52, 0x6b, 0xd8, 0x80, 0x7d, 0xc9, 0x01,
+	0x79, 0x5f, 0xc2, 0x51, 0x99, 0x83, 0x56, 0xd8, 0xd5, 0xde, 0xb9, 0x37,
+	0x5b, 0x5c, 0x69, 0xd4, 0x90, 0xe2, 0x0c, 0xa7, 0xa6, 0x45, 0x25, 0xab,
+	0x09, 0x6f, 0x46, 0xd2, 0x17, 0x85, 0xb7, 0x8e, 0x4d, 0x73, 0xc7, 0xe1,
+	0xfd, 0xd6, 0x35, 0x52, 0xdc, 0xcc, 0x0f, 0x9a, 0x56, 0xad, 0x7a, 0x72,
+	0x80, 0x57, 0x03, 0x6d, 0xfc, 0x4b, 0xcd, 0xe8, 0x95, 0xc3, 0x63, 0xb4,
+	0x98, 0x60, 0xe6, 0x2f, 0xf3, 0x7d, 0xa6, 0xfa, 0xda, 0xa6, 0xc2, 0x98,
+	0x02, 0xdc, 0x82, 0x8f, 0x93, 0x58, 0xd0, 0x8d, 0x69, 0x66, 0xb2, 0x9e,
+	0xf0, 0xeb, 0x5e, 0xe8, 0xbc, 0x38, 0xce, 0x6e, 0xa6, 0xb7, 0xe8, 0xc4,
+	0xd8, 0xa7, 0x3c, 0x17, 0x75, 0x7f, 0x17, 0x86, 0x50, 0xcb, 0x20, 0x9d,
+	0xef, 0x44, 0xb1, 0x76, 0x53, 0x3b, 0x0a, 0x30, 0x6b, 0x5e, 0x39, 0x01,
+	0xe9, 0xdf, 0x9f, 0x47, 0xd9, 0x13, 0xaa, 0xd0, 0x5d, 0xa9, 0x58, 0x76,
+	/* Padding */
+	0x00
+};
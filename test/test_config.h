@@ -103,6 +103,7 @@
 #define CONFIG_ACCEL_FIFO
 #define CONFIG_ACCEL_FIFO_SIZE 256
 #define CONFIG_ACCEL_FIFO_THRES 10
+#define CONFIG_ACCEL_FIFO_DECIMATE
 #endif
 
 #ifdef TEST_KASA
@@ -220,9 +221,19 @@ enum sensor_id {
 
 #endif
 
+#ifdef TEST_CONSOLE_EDIT
+#define CONFIG_CONSOLE_BATCH
+#endif
+
+#ifdef TEST_HOST_COMMAND
+#define CONFIG_HOSTCMD_HASH_SLOTS 256
+#define CONFIG_HOSTCMD_STATS
+#endif
+
 #ifdef TEST_CRC
 #define CONFIG_CRC8
 #define CONFIG_SW_CRC
+#define CONFIG_SW_CRC_SLICES 8
 #endif
 
 #ifdef TEST_RSA
@@ -239,6 +250,19 @@ enum sensor_id {
 #define CONFIG_RWSIG_TYPE_RWSIG
 #endif
 
+#ifdef TEST_RSA3072
+#define CONFIG_RSA
+#define CONFIG_RSA_KEY_SIZE 3072
+#define CONFIG_RWSIG_TYPE_RWSIG
+#endif
+
+#ifdef TEST_RSA3072_3
+#define CONFIG_RSA
+#define CONFIG_RSA_KEY_SIZE 3072
+#define CONFIG_RSA_EXPONENT_3
+#define CONFIG_RWSIG_TYPE_RWSIG
+#endif
+
 #ifdef TEST_SHA256
 #define CONFIG_SHA256
 #endif
@@ -296,6 +320,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #ifdef TEST_BATTERY_GET_PARAMS_SMART
 #define CONFIG_BATTERY_MOCK
 #define CONFIG_BATTERY_SMART
+#define CONFIG_BATTERY_SMART_CACHE
 #define CONFIG_CHARGER_INPUT_CURRENT 4032
 #define CONFIG_I2C
 #define CONFIG_I2C_CONTROLLER
@@ -483,12 +508,14 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_USB_PID 0x5036
 #define PD_VCONN_SWAP_DELAY 5000 /* us */
 #define CONFIG_USB_PD_TCPM_TCPCI
+#define CONFIG_CMD_TCPC_ALERT_STATS
 #define CONFIG_I2C
 #define CONFIG_I2C_CONTROLLER
 #define I2C_PORT_HOST_TCPC 0
 #define CONFIG_USB_PD_DEBUG_LEVEL 3
 #define CONFIG_USB_PD_EXTENDED_MESSAGES
 #define CONFIG_USB_PD_DECODE_SOP
+#define CONFIG_USB_PD_TICKLESS
 #endif
 
 #ifdef TEST_USB_PD_INT
@@ -558,6 +585,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #endif
 
 #ifdef TEST_VBOOT
+#define CONFIG_VBOOT_HASH
 #define CONFIG_RWSIG
 #define CONFIG_SHA256
 #define CONFIG_RSA
@@ -581,6 +609,13 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_CURVE25519
 #endif /* TEST_X25519 */
 
+#ifdef TEST_I2C_ASYNC
+#define CONFIG_I2C
+#define CONFIG_I2C_CONTROLLER
+#define CONFIG_I2C_DEBUG
+#define CONFIG_I2C_XFER_ASYNC
+#endif
+
 #ifdef TEST_I2C_BITBANG
 #define CONFIG_I2C
 #define CONFIG_I2C_CONTROLLER
@@ -282,6 +282,7 @@ void run_test(int argc, char **argv)
 
 	/* Do basic state machine validity checks last. */
 	RUN_TEST(test_pe_no_parent_cycles);
+	RUN_TEST(test_pe_parent_depths);
 
 	test_print_result();
 }
@@ -108,6 +108,77 @@ int test_pe_no_parent_cycles(void)
 	return EC_SUCCESS;
 }
 
+test_static int test_parent_depths(const struct test_sm_data * const sm_data)
+{
+	int i;
+
+	for (i = 0; i < sm_data->size; ++i) {
+		usb_state_ptr current = sm_data->base[i].parent;
+		int depth = 0;
+
+		/* Stop one past the limit, in case of a cycle */
+		for (; current && depth <= USB_SM_MAX_DEPTH;
+		     current = current->parent)
+			depth++;
+
+		if (depth > USB_SM_MAX_DEPTH) {
+			ccprintf("State %d is nested deeper than %d\n",
+				 i, USB_SM_MAX_DEPTH);
+			TEST_ASSERT(0);
+		}
+	}
+
+	return EC_SUCCESS;
+}
+
+int test_tc_parent_depths(void)
+{
+	int i;
+
+	for (i = 0; i < test_tc_sm_data_size; ++i) {
+		const int rv = test_parent_depths(&test_tc_sm_data[i]);
+
+		if (rv) {
+			ccprintf("TC State machine %d has a bad depth!\n", i);
+			TEST_ASSERT(0);
+		}
+	}
+
+	return EC_SUCCESS;
+}
+
+int test_prl_parent_depths(void)
+{
+	int i;
+
+	for (i = 0; i < test_prl_sm_data_size; ++i) {
+		const int rv = test_parent_depths(&test_prl_sm_data[i]);
+
+		if (rv) {
+			ccprintf("PRL State machine %d has a bad depth!\n", i);
+			TEST_ASSERT(0);
+		}
+	}
+
+	return EC_SUCCESS;
+}
+
+int test_pe_parent_depths(void)
+{
+	int i;
+
+	for (i = 0; i < test_pe_sm_data_size; ++i) {
+		const int rv = test_parent_depths(&test_pe_sm_data[i]);
+
+		if (rv) {
+			ccprintf("PE State machine %d has a bad depth!\n", i);
+			TEST_ASSERT(0);
+		}
+	}
+
+	return EC_SUCCESS;
+}
+
 static volatile int state_printed;
 
 /* Override the implement version of print */
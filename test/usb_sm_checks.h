@@ -9,14 +9,17 @@
 #define __CROS_EC_USB_SM_CHECKS_H
 
 int test_tc_no_parent_cycles(void);
+int test_tc_parent_depths(void);
 int test_tc_all_states_named(void);
 
 
 int test_prl_no_parent_cycles(void);
+int test_prl_parent_depths(void);
 int test_prl_all_states_named(void);
 
 
 int test_pe_no_parent_cycles(void);
+int test_pe_parent_depths(void);
 int test_pe_all_states_named(void);
 
 #endif /* __CROS_EC_USB_SM_CHECKS_H */
\ No newline at end of file
@@ -963,6 +963,74 @@ static const struct usb_state states[] = {
 	},
 };
 
+/*
+ * States without entry, run or exit functions, for timing the framework
+ * itself. BENCH_A3 and BENCH_B3 sit at the bottom of two separate
+ * hierarchies, so a transition between them exits and enters every level.
+ * BENCH_A3 and BENCH_A3_SIBLING only share their parents.
+ */
+enum bench_state {
+	BENCH_A0,
+	BENCH_A1,
+	BENCH_A2,
+	BENCH_A3,
+	BENCH_A3_SIBLING,
+	BENCH_B0,
+	BENCH_B1,
+	BENCH_B2,
+	BENCH_B3,
+};
+
+static const struct usb_state bench_states[] = {
+	[BENCH_A0] = {},
+	[BENCH_A1] = {
+		.parent = &bench_states[BENCH_A0],
+	},
+	[BENCH_A2] = {
+		.parent = &bench_states[BENCH_A1],
+	},
+	[BENCH_A3] = {
+		.parent = &bench_states[BENCH_A2],
+	},
+	[BENCH_A3_SIBLING] = {
+		.parent = &bench_states[BENCH_A2],
+	},
+	[BENCH_B0] = {},
+	[BENCH_B1] = {
+		.parent = &bench_states[BENCH_B0],
+	},
+	[BENCH_B2] = {
+		.parent = &bench_states[BENCH_B1],
+	},
+	[BENCH_B3] = {
+		.parent = &bench_states[BENCH_B2],
+	},
+};
+
+#define BENCH_ROUNDS 30000
+
+test_static int test_transition_speed(void)
+{
+	struct sm_ctx ctx = {};
+	uint64_t t0, t1;
+	int i;
+
+	t0 = test_host_time_ns();
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		set_state(PORT0, &ctx, &bench_states[BENCH_A3]);
+		set_state(PORT0, &ctx, &bench_states[BENCH_A3_SIBLING]);
+		set_state(PORT0, &ctx, &bench_states[BENCH_B3]);
+	}
+	t1 = test_host_time_ns();
+	ccprintf("%d transitions: %lld ns each\n", 3 * BENCH_ROUNDS,
+		 (long long)((t1 - t0) / (3 * BENCH_ROUNDS)));
+
+	TEST_ASSERT(ctx.current == &bench_states[BENCH_B3]);
+	TEST_ASSERT(ctx.previous == &bench_states[BENCH_A3_SIBLING]);
+
+	return EC_SUCCESS;
+}
+
 /* Run before each RUN_TEST line */
 void before_test(void)
 {
@@ -991,6 +1059,7 @@ void run_test(int argc, char **argv)
 #if defined(TEST_USB_SM_FRAMEWORK_H3)
 	RUN_TEST(test_hierarchy_3);
 	RUN_TEST(test_set_state_from_parents);
+	RUN_TEST(test_transition_speed);
 #elif defined(TEST_USB_SM_FRAMEWORK_H2)
 	RUN_TEST(test_hierarchy_2);
 #elif defined(TEST_USB_SM_FRAMEWORK_H1)
@@ -13,6 +13,7 @@
 #include "usb_mux.h"
 #include "usb_tc_sm.h"
 #include "usb_prl_sm.h"
+#include "util.h"
 
 #define PORT0 0
 
@@ -121,6 +122,94 @@ __maybe_unused static int test_connect_as_nonpd_sink(void)
 	return EC_SUCCESS;
 }
 
+/*
+ * An idle port should only wake the PD task for its own timers, not every
+ * 5 ms (200 times a second).
+ */
+#define IDLE_WAKEUPS_PER_SECOND_MAX 10
+
+/* Count how often the PD task wakes up over one second */
+static uint32_t pd_task_wakeups_per_second(void)
+{
+	uint32_t start = pd_task_wakeups[PORT0];
+
+	task_wait_event(SECOND);
+
+	return pd_task_wakeups[PORT0] - start;
+}
+
+__maybe_unused static int test_idle_unattached_wakeups(void)
+{
+	enum pd_dual_role_states drp = pd_get_dual_role(PORT0);
+	uint32_t wakeups;
+
+	/*
+	 * Left alone, the port parks in LowPowerMode. Freeze it in its
+	 * unattached state instead, so the state machines keep running and
+	 * only their deadlines can wake the task.
+	 */
+	pd_set_dual_role(PORT0, PD_DRP_FREEZE);
+	task_wait_event(SECOND);
+	TEST_ASSERT(pd_is_port_enabled(PORT0));
+	TEST_ASSERT(!strncmp(tc_get_current_state(PORT0), "Unattached.", 11));
+
+	wakeups = pd_task_wakeups_per_second();
+	pd_set_dual_role(PORT0, drp);
+
+	TEST_LE(wakeups, IDLE_WAKEUPS_PER_SECOND_MAX, "%d");
+	return EC_SUCCESS;
+}
+
+__maybe_unused static int test_idle_attached_sink_wakeups(void)
+{
+	TEST_EQ(test_connect_as_nonpd_sink(), EC_SUCCESS, "%d");
+
+	TEST_LE(pd_task_wakeups_per_second(), IDLE_WAKEUPS_PER_SECOND_MAX,
+		"%d");
+	return EC_SUCCESS;
+}
+
+__maybe_unused static int test_tcpci_alert_stats(void)
+{
+	/*
+	 * An extended status alert costs three transfers: the alert and mask
+	 * registers (address + 5 bytes), the status registers (address + 5
+	 * bytes) and clearing the alert (address + 2 bytes).
+	 */
+	const char *exp_output = "C0: 1 alerts, 3 xfers, 15 bytes, ";
+
+	/*
+	 * The idle port has put the TCPC in low power mode, and the first
+	 * alert only wakes it up.  Count the next one, before the port goes
+	 * back to low power mode.
+	 */
+	mock_set_alert(TCPC_REG_ALERT_EXT_STATUS);
+	task_wait_event(10 * MSEC);
+	UART_INJECT("tcpci_alerts reset\n");
+	task_wait_event(10 * MSEC);
+
+	mock_set_alert(TCPC_REG_ALERT_EXT_STATUS);
+	task_wait_event(10 * MSEC);
+
+	test_capture_console(1);
+	UART_INJECT("tcpci_alerts\n");
+	task_wait_event(10 * MSEC);
+	test_capture_console(0);
+	TEST_ASSERT(strstr(test_get_captured_console(), exp_output));
+
+	/* "reset" clears the counts */
+	UART_INJECT("tcpci_alerts reset\n");
+	task_wait_event(10 * MSEC);
+	test_capture_console(1);
+	UART_INJECT("tcpci_alerts\n");
+	task_wait_event(10 * MSEC);
+	test_capture_console(0);
+	TEST_ASSERT(strstr(test_get_captured_console(),
+			   "C0: 0 alerts, 0 xfers, 0 bytes, avg 0 us, max 0 us"));
+
+	return EC_SUCCESS;
+}
+
 __maybe_unused static int test_startup_and_resume(void)
 {
 	/* Should be in low power mode before AP boots. */
@@ -265,6 +354,15 @@ __maybe_unused static int test_connect_as_pd3_source(void)
 	return EC_SUCCESS;
 }
 
+__maybe_unused static int test_idle_pd3_source_wakeups(void)
+{
+	TEST_EQ(test_connect_as_pd3_source(), EC_SUCCESS, "%d");
+
+	TEST_LE(pd_task_wakeups_per_second(), IDLE_WAKEUPS_PER_SECOND_MAX,
+		"%d");
+	return EC_SUCCESS;
+}
+
 __maybe_unused static int test_retry_count_sop(void)
 {
 	/* DRP auto-toggling with AP in S0, source enabled. */
@@ -394,8 +492,12 @@ void run_test(int argc, char **argv)
 	test_reset();
 
 	RUN_TEST(test_connect_as_nonpd_sink);
+	RUN_TEST(test_idle_unattached_wakeups);
+	RUN_TEST(test_idle_attached_sink_wakeups);
+	RUN_TEST(test_tcpci_alert_stats);
 	RUN_TEST(test_startup_and_resume);
 	RUN_TEST(test_connect_as_pd3_source);
+	RUN_TEST(test_idle_pd3_source_wakeups);
 	RUN_TEST(test_retry_count_sop);
 	RUN_TEST(test_retry_count_hard_reset);
 	RUN_TEST(test_pd3_source_send_soft_reset);
@@ -1519,6 +1519,7 @@ void run_test(int argc, char **argv)
 
 	/* Do basic state machine validity checks last. */
 	RUN_TEST(test_tc_no_parent_cycles);
+	RUN_TEST(test_tc_parent_depths);
 	RUN_TEST(test_tc_all_states_named);
 
 	/*
@@ -1527,6 +1528,7 @@ void run_test(int argc, char **argv)
 	 * te PE statemachine here so we don't have to create another test exe
 	 */
 	RUN_TEST(test_pe_no_parent_cycles);
+	RUN_TEST(test_pe_parent_depths);
 	RUN_TEST(test_pe_all_states_named);
 
 	test_print_result();
@@ -780,6 +780,7 @@ void run_test(int argc, char **argv)
 
 	/* Do basic state machine validity checks last. */
 	RUN_TEST(test_tc_no_parent_cycles);
+	RUN_TEST(test_tc_parent_depths);
 	RUN_TEST(test_tc_all_states_named);
 
 	test_print_result();
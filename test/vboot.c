@@ -6,8 +6,11 @@
  */
 
 #include "common.h"
+#include "ec_commands.h"
 #include "rsa.h"
+#include "sha256.h"
 #include "test_util.h"
+#include "timer.h"
 #include "vboot.h"
 #include "rsa2048-3.h"
 #include "rwsig.h"
@@ -131,11 +134,70 @@ static int test_vboot(void)
 	return EC_SUCCESS;
 }
 
+static int vboot_hash_cmd(int version, struct ec_params_vboot_hash *p,
+			  void *resp, int resp_size)
+{
+	return test_send_host_command(EC_CMD_VBOOT_HASH, version, p,
+				      sizeof(*p), resp, resp_size);
+}
+
+static int test_vboot_hash_v1(void)
+{
+	struct ec_params_vboot_hash p;
+	struct ec_response_vboot_hash r0;
+	struct ec_response_vboot_hash_v1 r1;
+
+	/* Let the hash started at boot finish */
+	memset(&p, 0, sizeof(p));
+	p.cmd = EC_VBOOT_HASH_GET;
+	do {
+		msleep(1);
+		TEST_ASSERT(vboot_hash_cmd(0, &p, &r0, sizeof(r0)) ==
+			    EC_RES_SUCCESS);
+	} while (r0.status == EC_VBOOT_HASH_STATUS_BUSY);
+
+	/* Version 1 wraps the version 0 response and adds the time */
+	memset(&r1, 0, sizeof(r1));
+	p.cmd = EC_VBOOT_HASH_RECALC;
+	p.hash_type = EC_VBOOT_HASH_TYPE_SHA256;
+	p.offset = 0;
+	p.size = 0x1000;
+	TEST_ASSERT(vboot_hash_cmd(1, &p, &r1, sizeof(r1)) == EC_RES_SUCCESS);
+	TEST_ASSERT(r1.hash.status == EC_VBOOT_HASH_STATUS_DONE);
+	TEST_ASSERT(r1.hash.hash_type == EC_VBOOT_HASH_TYPE_SHA256);
+	TEST_ASSERT(r1.hash.digest_size == SHA256_DIGEST_SIZE);
+	TEST_ASSERT(r1.hash.offset == 0);
+	TEST_ASSERT(r1.hash.size == 0x1000);
+	TEST_ASSERT(r1.hash_time_us > 0);
+
+	/* Version 0 reports the same hash */
+	memset(&r0, 0, sizeof(r0));
+	p.cmd = EC_VBOOT_HASH_GET;
+	TEST_ASSERT(vboot_hash_cmd(0, &p, &r0, sizeof(r0)) == EC_RES_SUCCESS);
+	TEST_ASSERT(r0.status == EC_VBOOT_HASH_STATUS_DONE);
+	TEST_ASSERT(r0.offset == r1.hash.offset);
+	TEST_ASSERT(r0.size == r1.hash.size);
+	TEST_ASSERT_ARRAY_EQ(r0.hash_digest, r1.hash.hash_digest,
+			     SHA256_DIGEST_SIZE);
+
+	/* The time is only valid while the hash is */
+	p.cmd = EC_VBOOT_HASH_ABORT;
+	TEST_ASSERT(vboot_hash_cmd(1, &p, &r1, sizeof(r1)) == EC_RES_SUCCESS);
+	memset(&r1, 0xff, sizeof(r1));
+	p.cmd = EC_VBOOT_HASH_GET;
+	TEST_ASSERT(vboot_hash_cmd(1, &p, &r1, sizeof(r1)) == EC_RES_SUCCESS);
+	TEST_ASSERT(r1.hash.status == EC_VBOOT_HASH_STATUS_NONE);
+	TEST_ASSERT(r1.hash_time_us == 0);
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	test_reset();
 
 	RUN_TEST(test_vboot);
+	RUN_TEST(test_vboot_hash_v1);
 
 	test_print_result();
 }
@@ -124,20 +124,32 @@ static int ec_readmem_dev(int offset, int bytes, void *dest)
 
 /* New ioctl format, used by Chrome OS 4.4 and later as well as upstream 4.0+ */
 
+/*
+ * Command buffer, kept across commands: large transfers like fingerprint
+ * frames are made of many commands of the same size.
+ */
+static struct cros_ec_command_v2 *s_cmd_buf;
+static size_t s_cmd_buf_size;
+
 static int ec_command_dev_v2(int command, int version,
 			     const void *outdata, int outsize,
 			     void *indata, int insize)
 {
 	struct cros_ec_command_v2 *s_cmd;
+	size_t size = sizeof(struct cros_ec_command_v2) + MAX(outsize, insize);
 	int r;
 
 	assert(outsize == 0 || outdata != NULL);
 	assert(insize == 0 || indata != NULL);
 
-	s_cmd = malloc(sizeof(struct cros_ec_command_v2) +
-		       MAX(outsize, insize));
-	if (s_cmd == NULL)
-		return -EC_RES_ERROR;
+	if (size > s_cmd_buf_size) {
+		s_cmd = realloc(s_cmd_buf, size);
+		if (s_cmd == NULL)
+			return -EC_RES_ERROR;
+		s_cmd_buf = s_cmd;
+		s_cmd_buf_size = size;
+	}
+	s_cmd = s_cmd_buf;
 
 	s_cmd->command = command;
 	s_cmd->version = version;
@@ -153,7 +165,7 @@ static int ec_command_dev_v2(int command, int version,
 			strresult(s_cmd->result));
 		if (errno == EAGAIN && s_cmd->result == EC_RES_IN_PROGRESS) {
 			s_cmd->command = EC_CMD_RESEND_RESPONSE;
-			r = ioctl(fd, CROS_EC_DEV_IOCXCMD_V2, &s_cmd);
+			r = ioctl(fd, CROS_EC_DEV_IOCXCMD_V2, s_cmd);
 			fprintf(stderr,
 				"ioctl %d, errno %d (%s), EC result %d (%s)\n",
 				r, errno, strerror(errno), s_cmd->result,
@@ -167,7 +179,6 @@ static int ec_command_dev_v2(int command, int version,
 			r =  -EECRESULT - s_cmd->result;
 		}
 	}
-	free(s_cmd);
 
 	return r;
 }
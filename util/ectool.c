@@ -170,6 +170,8 @@ const char help_str[] =
 	"      Checks for basic communication with EC\n"
 	"  hibdelay [sec]\n"
 	"      Set the delay before going into hibernation\n"
+	"  hostcmdstats [clear]\n"
+	"      Prints or clears host command dispatch latency histograms\n"
 	"  hostsleepstate\n"
 	"      Report host sleep state to the EC\n"
 	"  hostevent\n"
@@ -660,6 +662,48 @@ static int get_latest_cmd_version(uint8_t cmd, int *version)
 	return rv;
 }
 
+int cmd_hostcmdstats(int argc, char *argv[])
+{
+	struct ec_params_host_command_stats p;
+	struct ec_response_host_command_stats *r = ec_inbuf;
+	int rv, i, j;
+
+	p.index = 0;
+	p.flags = 0;
+	if (argc > 1) {
+		if (strcmp(argv[1], "clear")) {
+			fprintf(stderr, "Usage: %s [clear]\n", argv[0]);
+			return -1;
+		}
+		p.flags = EC_HOST_COMMAND_STATS_CLEAR;
+		rv = ec_command(EC_CMD_HOST_COMMAND_STATS, 0, &p, sizeof(p),
+				NULL, 0);
+		return rv < 0 ? rv : 0;
+	}
+
+	printf("cmd   ");
+	for (i = 0; i < EC_HOST_COMMAND_STATS_BUCKETS - 1; i++)
+		printf(" <%-6d", 4 << (2 * i));
+	printf(" >=%d us\n", 4 << (2 * i - 2));
+
+	do {
+		rv = ec_command(EC_CMD_HOST_COMMAND_STATS, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+
+		for (i = 0; i < r->num_entries; i++) {
+			printf("0x%04x", r->entries[i].command);
+			for (j = 0; j < EC_HOST_COMMAND_STATS_BUCKETS; j++)
+				printf(" %7d", r->entries[i].latency[j]);
+			printf("\n");
+		}
+		p.index += r->num_entries;
+	} while (r->num_entries && p.index < r->num_cmds);
+
+	return 0;
+}
+
 int cmd_hostsleepstate(int argc, char *argv[])
 {
 	struct ec_params_host_sleep_event p;
@@ -2079,8 +2123,11 @@ int cmd_fp_stats(int argc, char *argv[])
 	struct ec_response_fp_stats r;
 	int rv;
 	unsigned long long ts;
+	int cmdver = ec_cmd_version_supported(EC_CMD_FP_STATS, 1) ? 1 : 0;
+	int rsize = cmdver == 1 ? sizeof(r)
+				: sizeof(struct ec_response_fp_stats_v0);
 
-	rv = ec_command(EC_CMD_FP_STATS, 0, NULL, 0, &r, sizeof(r));
+	rv = ec_command(EC_CMD_FP_STATS, cmdver, NULL, 0, &r, rsize);
 	if (rv < 0)
 		return rv;
 
@@ -2105,6 +2152,10 @@ int cmd_fp_stats(int argc, char *argv[])
 	else
 		printf("%d us\n", r.overall_time_us);
 
+	if (cmdver == 1)
+		printf("Last frame upload:  %d us (%d chunks)\n",
+		       r.frame_upload_time_us, r.frame_upload_chunks);
+
 	return 0;
 }
 
@@ -7613,6 +7664,15 @@ static int cmd_charge_state(int argc, char **argv)
 		printf("custom profile params:\n");
 		printf("  0x%x - 0x%x\n", CS_PARAM_CUSTOM_PROFILE_MIN,
 		       CS_PARAM_CUSTOM_PROFILE_MAX);
+		printf("battery value age (ms), read only:\n");
+		printf("  0x%x - 0x%x\n", CS_PARAM_BATT_AGE_MIN,
+		       CS_PARAM_BATT_AGE_MIN + CS_NUM_BATT_PARAMS - 1);
+		printf("battery value refresh period (ms):\n");
+		printf("  0x%x - 0x%x\n", CS_PARAM_BATT_REFRESH_MIN,
+		       CS_PARAM_BATT_REFRESH_MIN + CS_NUM_BATT_PARAMS - 1);
+		printf("  in the order: temperature, state of charge, voltage,"
+		       " current,\n  desired voltage, desired current,"
+		       " remaining capacity,\n  full capacity, status\n");
 
 		return 0;
 	}
@@ -8340,8 +8400,9 @@ static int ec_hash_help(const char *cmd)
 }
 
 
-static int ec_hash_print(const struct ec_response_vboot_hash *r)
+static int ec_hash_print(const struct ec_response_vboot_hash_v1 *r1)
 {
+	const struct ec_response_vboot_hash *r = &r1->hash;
 	int i;
 
 	if (r->status == EC_VBOOT_HASH_STATUS_BUSY) {
@@ -8368,6 +8429,11 @@ static int ec_hash_print(const struct ec_response_vboot_hash *r)
 	for (i = 0; i < r->digest_size; i++)
 		printf("%02x", r->hash_digest[i]);
 	printf("\n");
+
+	if (r1->hash_time_us && r->size)
+		printf("time:    %u us (%u us/MB)\n", r1->hash_time_us,
+		       (uint32_t)((uint64_t)r1->hash_time_us * 1024 * 1024 /
+				  r->size));
 	return 0;
 }
 
@@ -8375,16 +8441,19 @@ static int ec_hash_print(const struct ec_response_vboot_hash *r)
 int cmd_ec_hash(int argc, char *argv[])
 {
 	struct ec_params_vboot_hash p;
-	struct ec_response_vboot_hash r;
+	struct ec_response_vboot_hash_v1 r;
+	int version = ec_cmd_version_supported(EC_CMD_VBOOT_HASH, 1) ? 1 : 0;
+	int rsize = version ? sizeof(r) : sizeof(r.hash);
 	char *e;
 	int rv;
 
 	memset(&p, 0, sizeof(p));
+	memset(&r, 0, sizeof(r));
 	if (argc < 2) {
 		/* Get hash status */
 		p.cmd = EC_VBOOT_HASH_GET;
-		rv = ec_command(EC_CMD_VBOOT_HASH, 0,
-				&p, sizeof(p), &r, sizeof(r));
+		rv = ec_command(EC_CMD_VBOOT_HASH, version,
+				&p, sizeof(p), &r, rsize);
 		if (rv < 0)
 			return rv;
 
@@ -8394,8 +8463,8 @@ int cmd_ec_hash(int argc, char *argv[])
 	if (argc == 2 && !strcasecmp(argv[1], "abort")) {
 		/* Abort hash calculation */
 		p.cmd = EC_VBOOT_HASH_ABORT;
-		rv = ec_command(EC_CMD_VBOOT_HASH, 0,
-				&p, sizeof(p), &r, sizeof(r));
+		rv = ec_command(EC_CMD_VBOOT_HASH, version,
+				&p, sizeof(p), &r, rsize);
 		return (rv < 0 ? rv : 0);
 	}
 
@@ -8454,7 +8523,7 @@ int cmd_ec_hash(int argc, char *argv[])
 	} else
 		p.nonce_size = 0;
 
-	rv = ec_command(EC_CMD_VBOOT_HASH, 0, &p, sizeof(p), &r, sizeof(r));
+	rv = ec_command(EC_CMD_VBOOT_HASH, version, &p, sizeof(p), &r, rsize);
 	if (rv < 0)
 		return rv;
 
@@ -10273,6 +10342,7 @@ const struct command commands[] = {
 	{"hangdetect", cmd_hang_detect},
 	{"hello", cmd_hello},
 	{"hibdelay", cmd_hibdelay},
+	{"hostcmdstats", cmd_hostcmdstats},
 	{"hostevent", cmd_hostevent},
 	{"hostsleepstate", cmd_hostsleepstate},
 	{"locatechip", cmd_locate_chip},
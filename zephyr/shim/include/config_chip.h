@@ -91,6 +91,12 @@
 #define CONFIG_HOSTCMD_ESPI_VW_SLP_S4
 #endif
 
+/* Host commands */
+#undef CONFIG_HOSTCMD_HASH_SLOTS
+#ifdef CONFIG_PLATFORM_EC_HOSTCMD
+#define CONFIG_HOSTCMD_HASH_SLOTS CONFIG_PLATFORM_EC_HOSTCMD_HASH_SLOTS
+#endif
+
 #undef CONFIG_KEYBOARD_COL2_INVERTED
 #ifdef CONFIG_PLATFORM_EC_KEYBOARD_COL2_INVERTED
 #define CONFIG_KEYBOARD_COL2_INVERTED
@@ -0,0 +1,43 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#if !defined(__CROS_EC_HOST_COMMAND_H) || \
+	defined(__CROS_EC_ZEPHYR_HOST_COMMAND_SHIM_H)
+#error "This file must only be included from host_command.h. " \
+	"Include host_command.h directly."
+#endif
+#define __CROS_EC_ZEPHYR_HOST_COMMAND_SHIM_H
+
+#include <init.h>
+
+/**
+ * Runtime helper for DECLARE_HOST_COMMAND setup data.
+ *
+ * @param cmd		A statically allocated host command.
+ */
+void zshim_setup_host_command(const struct host_command *cmd);
+
+/**
+ * See include/host_command.h for documentation.
+ */
+#define DECLARE_HOST_COMMAND(command, routine, version_mask)		\
+	_DECLARE_HOST_COMMAND_1(command, routine, version_mask, __LINE__)
+#define _DECLARE_HOST_COMMAND_1(command, routine, version_mask, line)	\
+	_DECLARE_HOST_COMMAND_2(command, routine, version_mask, line)
+#define _DECLARE_HOST_COMMAND_2(command, routine, version_mask, line)	\
+	static int _setup_host_command_##line(const struct device *unused) \
+	{								\
+		ARG_UNUSED(unused);					\
+		static const struct host_command cmd = {		\
+			routine, command, version_mask			\
+		};							\
+		zshim_setup_host_command(&cmd);				\
+		return 0;						\
+	}								\
+	SYS_INIT(_setup_host_command_##line, APPLICATION, 1)
+
+#define DECLARE_PRIVATE_HOST_COMMAND(command, routine, version_mask)	\
+	DECLARE_HOST_COMMAND(EC_PRIVATE_HOST_COMMAND_VALUE(command),	\
+			     routine, version_mask)
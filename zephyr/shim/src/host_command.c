@@ -0,0 +1,16 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "host_command.h"
+
+void zshim_setup_host_command(const struct host_command *cmd)
+{
+	if (host_command_hash_add(cmd) != EC_SUCCESS)
+		cprints(CC_HOSTCMD, "Warning: host command 0x%04x dropped, "
+			"increase CONFIG_PLATFORM_EC_HOSTCMD_HASH_SLOTS",
+			cmd->command);
+}